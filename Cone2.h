@@ -11,9 +11,16 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include "shader.h"
+#include "geometry_arena.h"
+#include "mesh_handle.h"
+#include "lod.h"
+#include "mesh_batch.h"
+#include "texture_residency.h"
 
 # define PI 3.1416
 
+const int CONE_LOD_LEVELS = 3;      // each level halves the sectors
+
 class Cone2 {
 public:
     glm::vec3 ambient;
@@ -24,18 +31,22 @@ public:
     float TYmin = 0.0f;
     float TYmax = 1.0f;
     unsigned int diffuseMap;
-    unsigned int specularMap;
     float shininess;
 
     Cone2(float radius, float height, int sectorCount, glm::vec3 amb, glm::vec3 diff, glm::vec3 spec, float shiny,
-        unsigned int dMap, unsigned int sMap, float textureXmin, float textureYmin, float textureXmax, float textureYmax) {
-        set(radius, height, sectorCount, amb, diff, spec, shiny, dMap, sMap, textureXmin, textureYmin, textureXmax, textureYmax);
+        unsigned int dMap, float textureXmin, float textureYmin, float textureXmax, float textureYmax) {
+        set(radius, height, sectorCount, amb, diff, spec, shiny, dMap, textureXmin, textureYmin, textureXmax, textureYmax);
         setUpConeVertexDataAndConfigureVertexAttribute();
     }
-    ~Cone2() {}
+
+    // the mesh batch delivers the LOD levels to this object, so it cannot move
+    Cone2(const Cone2&) = delete;
+    Cone2& operator=(const Cone2&) = delete;
+    Cone2(Cone2&&) = delete;
+    Cone2& operator=(Cone2&&) = delete;
 
     void set(float radius, float height, int sectorCount, glm::vec3 amb, glm::vec3 diff, glm::vec3 spec, float shiny,
-        unsigned int dMap, unsigned int sMap, float textureXmin, float textureYmin, float textureXmax, float textureYmax) {
+        unsigned int dMap, float textureXmin, float textureYmin, float textureXmax, float textureYmax) {
         this->radius = radius;
         this->height = height;
         this->sectorCount = sectorCount;
@@ -44,115 +55,84 @@ public:
         this->specular = spec;
         this->shininess = shiny;
         this->diffuseMap = dMap;
-        this->specularMap = sMap;
         this->TXmin = textureXmin;
         this->TXmax = textureXmax;
         this->TYmin = textureYmin;
         this->TYmax = textureYmax;
-
-        buildCoordinatesAndIndices();
     }
 
+    // projected radii in pixels below which the next coarser level is drawn
+    void setLODThresholds(const std::vector<float>& pixels, float hysteresis = 0.15f) { lod.setThresholds(pixels, hysteresis); }
+
     void drawConeWithTexture(Shader& shader, glm::mat4 model = glm::mat4(1.0f)) {
+        unsigned int coneMesh = lod.select(model);
+
         shader.use();
-        shader.setVec3("material.ambient", this->ambient);
-        shader.setVec3("material.diffuse", this->diffuse);
-        shader.setVec3("material.specular", this->specular);
+        shader.setInt("material.diffuse", 0);
         shader.setFloat("material.shininess", this->shininess);
 
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, this->diffuseMap);
-
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, this->specularMap);
+        TextureResidency::shared().use(this->diffuseMap, model, GeometryArena::shared().meshBounds(coneMesh),
+            max(TXmax - TXmin, TYmax - TYmin));
 
         shader.setMat4("model", model);
 
-        glBindVertexArray(coneVAO);
-        glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
+        GeometryArena::shared().drawMesh(coneMesh);
     }
 
 private:
-    unsigned int coneVAO, coneVBO, coneEBO;
-    std::vector<float> vertices;
-    std::vector<unsigned int> indices;
+    MeshHandle levelMeshes[CONE_LOD_LEVELS];
+    LODChain lod;
     float radius, height;
     int sectorCount;
 
-    void buildCoordinatesAndIndices() {
-        float sectorStep = 2 * PI / sectorCount;
+    static void buildLevel(MeshBuilder& builder, float radius, float height, int sectors) {
+        builder.reserve(sectors + 3, sectors * 6);
+
+        float sectorStep = 2 * PI / sectors;
         float sectorAngle;
 
         // Bottom center point
-        vertices.push_back(0.0f);
-        vertices.push_back(0.0f);
-        vertices.push_back(0.0f);
-        vertices.push_back(0.0f);
-        vertices.push_back(-1.0f);
-        vertices.push_back(0.5f);
-        vertices.push_back(0.5f);
+        builder.addVertex(glm::vec3(0.0f), glm::vec3(0.0f, -1.0f, 0.0f), glm::vec2(0.5f, 0.5f));
 
         // Bottom circle vertices
-        for (int i = 0; i <= sectorCount; ++i) {
+        for (int i = 0; i <= sectors; ++i) {
             sectorAngle = i * sectorStep;
             float x = radius * cosf(sectorAngle);
             float z = radius * sinf(sectorAngle);
 
-            vertices.push_back(x);
-            vertices.push_back(0.0f);
-            vertices.push_back(z);
-            vertices.push_back(0.0f);
-            vertices.push_back(-1.0f);
-            vertices.push_back((cosf(sectorAngle) + 1) * 0.5f);
-            vertices.push_back((sinf(sectorAngle) + 1) * 0.5f);
+            builder.addVertex(glm::vec3(x, 0.0f, z), glm::vec3(0.0f, -1.0f, 0.0f),
+                glm::vec2((cosf(sectorAngle) + 1) * 0.5f, (sinf(sectorAngle) + 1) * 0.5f));
         }
 
         // Apex point
-        vertices.push_back(0.0f);
-        vertices.push_back(height);
-        vertices.push_back(0.0f);
-        vertices.push_back(0.0f);
-        vertices.push_back(1.0f);
-        vertices.push_back(0.5f);
-        vertices.push_back(1.0f);
+        builder.addVertex(glm::vec3(0.0f, height, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec2(0.5f, 1.0f));
 
         // Indices for bottom circle
-        for (int i = 1; i <= sectorCount; ++i) {
-            indices.push_back(0);
-            indices.push_back(i);
-            indices.push_back(i + 1);
-        }
+        for (int i = 1; i <= sectors; ++i)
+            builder.addTriangle(0, i, i + 1);
 
         // Indices for side triangles
-        int apexIndex = sectorCount + 2;
-        for (int i = 1; i <= sectorCount; ++i) {
-            indices.push_back(i);
-            indices.push_back(apexIndex);
-            indices.push_back(i + 1);
-        }
+        int apexIndex = sectors + 2;
+        for (int i = 1; i <= sectors; ++i)
+            builder.addTriangle(i, apexIndex, i + 1);
     }
 
     void setUpConeVertexDataAndConfigureVertexAttribute() {
-        glGenVertexArrays(1, &coneVAO);
-        glGenBuffers(1, &coneVBO);
-        glGenBuffers(1, &coneEBO);
-
-        glBindVertexArray(coneVAO);
-
-        glBindBuffer(GL_ARRAY_BUFFER, coneVBO);
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
-
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, coneEBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
-
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 7 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(0);
-
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 7 * sizeof(float), (void*)(3 * sizeof(float)));
-        glEnableVertexAttribArray(1);
-
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 7 * sizeof(float), (void*)(6 * sizeof(float)));
-        glEnableVertexAttribArray(2);
+        for (int level = 0; level < CONE_LOD_LEVELS; level++) {
+            float r = radius, h = height;
+            int sectors = std::max(sectorCount >> level, 3);
+
+            submitMesh((MeshKey("cone") << r << h << sectors).str(),
+                [r, h, sectors](MeshBuilder& builder) { buildLevel(builder, r, h, sectors); },
+                VERTEX_FORMAT_PACKED,
+                [this, level](unsigned int mesh) {
+                    levelMeshes[level].reset(mesh);
+                    lod.addLevel(mesh);
+                });
+        }
+        lod.setThresholds({ 40.0f, 12.0f });
     }
 };
 #pragma once
@@ -0,0 +1,9 @@
+#version 430 core
+layout (location = 0) in vec2 aCorner;    // (t, fraction of a turn)
+
+out vec2 vCorner;
+
+void main()
+{
+    vCorner = aCorner;
+}
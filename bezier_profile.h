@@ -0,0 +1,177 @@
+#ifndef bezier_profile_h
+#define bezier_profile_h
+
+#include <glad/glad.h>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+
+// a point on the profile and its derivative with respect to t
+struct ProfileSample {
+    float t;
+    float r, y;         // radius (signed, as in the control points) and height
+    float dr, dy;
+};
+
+// Bezier profile curve for surfaces of revolution, read from (x, y, z)
+// control points where x is the radius.
+class BezierProfile {
+public:
+    BezierProfile(const GLfloat* ctrlpoints, int L)
+    {
+        for (int i = 0; i <= L; i++) {
+            r.push_back(ctrlpoints[i * 3]);
+            y.push_back(ctrlpoints[i * 3 + 1]);
+        }
+    }
+
+    int getDegree() const { return (int)r.size() - 1; }
+
+    // the profile and its derivative at each of ts, by de Casteljau's
+    // algorithm on the control points; one pair of scratch rows serves the
+    // whole batch
+    void sample(const vector<double>& ts, vector<ProfileSample>& out) const
+    {
+        int n = getDegree();
+        vector<double> pr, py;
+        out.resize(ts.size());
+        for (size_t s = 0; s < ts.size(); s++) {
+            double t = ts[s], u = 1.0 - t;
+            pr.assign(r.begin(), r.end());
+            py.assign(y.begin(), y.end());
+
+            // down to the two points of degree n - 1, whose difference
+            // times n is the derivative
+            for (int k = n; k > 1; k--) {
+                for (int i = 0; i < k; i++) {
+                    pr[i] = u * pr[i] + t * pr[i + 1];
+                    py[i] = u * py[i] + t * py[i + 1];
+                }
+            }
+
+            ProfileSample& p = out[s];
+            p.t = (float)t;
+            if (n == 0) {
+                p.r = (float)pr[0];
+                p.y = (float)py[0];
+                p.dr = p.dy = 0.0f;
+                continue;
+            }
+            p.r = (float)(u * pr[0] + t * pr[1]);
+            p.y = (float)(u * py[0] + t * py[1]);
+            p.dr = (float)(n * (pr[1] - pr[0]));
+            p.dy = (float)(n * (py[1] - py[0]));
+        }
+    }
+
+    // Refines the profile until every span is within tolerance of the curve
+    // (distance from its midpoint to the chord, in profile units) and turns
+    // the normal by at most maxAngle radians. Spans are split in batches, a
+    // pass at a time, starting from a few uniform spans so no feature is
+    // stepped over.
+    void sampleAdaptive(float tolerance, float maxAngle, vector<ProfileSample>& out, int maxSamples = 1025) const
+    {
+        const int seedSpans = 4;
+        vector<double> ts;
+        for (int s = 0; s <= seedSpans; s++)
+            ts.push_back((double)s / seedSpans);
+        sample(ts, out);
+
+        vector<bool> open(seedSpans, true);
+        vector<double> midpoints;
+        vector<ProfileSample> middles;
+        while ((int)out.size() < maxSamples) {
+            midpoints.clear();
+            for (size_t i = 0; i < open.size(); i++) {
+                if (open[i])
+                    midpoints.push_back(0.5 * ((double)out[i].t + (double)out[i + 1].t));
+            }
+            if (midpoints.empty())
+                break;
+            sample(midpoints, middles);
+
+            vector<ProfileSample> refined;
+            vector<bool> refinedOpen;
+            size_t m = 0;
+            for (size_t i = 0; i < open.size(); i++) {
+                refined.push_back(out[i]);
+                if (!open[i]) {
+                    refinedOpen.push_back(false);
+                    continue;
+                }
+                const ProfileSample& mid = middles[m++];
+                if (spanWithinTolerance(out[i], mid, out[i + 1], tolerance, maxAngle)) {
+                    refinedOpen.push_back(false);
+                }
+                else {
+                    refined.push_back(mid);
+                    refinedOpen.push_back(true);
+                    refinedOpen.push_back(true);
+                }
+            }
+            refined.push_back(out.back());
+            out.swap(refined);
+            open.swap(refinedOpen);
+        }
+    }
+
+    // whether every span of an existing sampling meets the same test
+    bool withinTolerance(const vector<ProfileSample>& samples, float tolerance, float maxAngle) const
+    {
+        vector<double> midpoints;
+        for (size_t i = 0; i + 1 < samples.size(); i++)
+            midpoints.push_back(0.5 * ((double)samples[i].t + (double)samples[i + 1].t));
+        vector<ProfileSample> middles;
+        sample(midpoints, middles);
+
+        for (size_t i = 0; i < middles.size(); i++) {
+            if (!spanWithinTolerance(samples[i], middles[i], samples[i + 1], tolerance, maxAngle))
+                return false;
+        }
+        return true;
+    }
+
+private:
+    vector<double> r, y;
+
+    static bool spanWithinTolerance(const ProfileSample& a, const ProfileSample& mid, const ProfileSample& b, float tolerance, float maxAngle)
+    {
+        float chordR = b.r - a.r, chordY = b.y - a.y;
+        float chordLength = sqrtf(chordR * chordR + chordY * chordY);
+        float deviation;
+        if (chordLength > 0.0f)
+            deviation = fabsf((mid.r - a.r) * chordY - (mid.y - a.y) * chordR) / chordLength;
+        else
+            deviation = sqrtf((mid.r - a.r) * (mid.r - a.r) + (mid.y - a.y) * (mid.y - a.y));
+        if (deviation > tolerance)
+            return false;
+
+        // angle between the tangents at the ends, which is the normal turn
+        float lengthA = sqrtf(a.dr * a.dr + a.dy * a.dy), lengthB = sqrtf(b.dr * b.dr + b.dy * b.dy);
+        if (lengthA == 0.0f || lengthB == 0.0f)
+            return true;
+        float cosAngle = (a.dr * b.dr + a.dy * b.dy) / (lengthA * lengthB);
+        return cosAngle >= cosf(maxAngle);
+    }
+};
+
+// Segments around the axis so the widest ring stays within tolerance of
+// the true circle (sagitta of each step) and the normal turns by at most
+// maxAngle per step.
+inline int revolutionSegments(const vector<ProfileSample>& profile, float tolerance, float maxAngle, int minSegments = 6)
+{
+    float radius = 0.0f;
+    for (size_t i = 0; i < profile.size(); i++)
+        radius = max(radius, fabsf(profile[i].r));
+
+    float step = maxAngle;
+    if (radius > tolerance)
+        step = min(step, 2.0f * acosf(1.0f - tolerance / radius));
+
+    const float pi = 3.14159265f;
+    return max(minSegments, (int)ceilf(2.0f * pi / step));
+}
+
+#endif /* bezier_profile_h */
@@ -0,0 +1,95 @@
+#ifndef bezier_revolution_h
+#define bezier_revolution_h
+
+#include <glad/glad.h>
+#include <vector>
+#include <iostream>
+#include <glm/glm.hpp>
+#include "shader.h"
+#include "geometry_arena.h"
+
+using namespace std;
+
+const int BEZIER_MAX_CONTROL_POINTS = 32;    // size of the profile array in the shaders
+const int BEZIER_PATCH_RINGS = 8;            // patches along the profile
+const int BEZIER_PATCH_SECTORS = 4;          // patches around the axis
+
+// Surface of revolution tessellated on the GPU. Only the profile control
+// points are kept and uploaded; the tessellation control shader splits each
+// patch edge by its length on screen and the evaluation shader runs de
+// Casteljau for the position and the true normal. Every surface shares one
+// tiny grid of patch corners, so changing the profile needs no remeshing.
+class BezierRevolution {
+public:
+    BezierRevolution(const GLfloat* ctrlpoints, int L)
+    {
+        setControlPoints(ctrlpoints, L);
+    }
+
+    // ctrlpoints are (x, y, z) with x the radius, as for hollowBezier
+    void setControlPoints(const GLfloat* ctrlpoints, int L)
+    {
+        int count = L + 1;
+        if (count > BEZIER_MAX_CONTROL_POINTS) {
+            cout << "bezier revolution: " << count << " control points, only the first " << BEZIER_MAX_CONTROL_POINTS << " are used" << endl;
+            count = BEZIER_MAX_CONTROL_POINTS;
+        }
+
+        profile.clear();
+        for (int i = 0; i < count; i++)
+            profile.push_back(glm::vec2(ctrlpoints[i * 3], ctrlpoints[i * 3 + 1]));
+    }
+
+    int getControlPointCount() const { return (int)profile.size(); }
+
+    // GPU bytes this surface owns; the shared patch grid is not counted
+    size_t getMemoryBytes() const { return profile.size() * sizeof(glm::vec2); }
+
+    // the shader must have view, projection, viewportSize and edgePixels set
+    void draw(Shader& shader, const glm::mat4& model)
+    {
+        shader.use();
+        shader.setMat4("model", model);
+        shader.setInt("profileDegree", (int)profile.size() - 1);
+        glUniform2fv(glGetUniformLocation(shader.ID, "profile"), (GLsizei)profile.size(), &profile[0][0]);
+
+        glBindVertexArray(patchVAO());
+        GeometryArena::shared().forgetBinding();
+        glPatchParameteri(GL_PATCH_VERTICES, 4);
+        glDrawArrays(GL_PATCHES, 0, BEZIER_PATCH_RINGS * BEZIER_PATCH_SECTORS * 4);
+    }
+
+private:
+    vector<glm::vec2> profile;
+
+    // (t, fraction of a turn) at the corners of every patch, in the order
+    // the control shader expects: (t0, u0), (t0, u1), (t1, u1), (t1, u0)
+    static unsigned int patchVAO()
+    {
+        static unsigned int vao = 0;
+        if (vao != 0)
+            return vao;
+
+        vector<float> corners;
+        for (int i = 0; i < BEZIER_PATCH_RINGS; i++) {
+            float t0 = (float)i / BEZIER_PATCH_RINGS, t1 = (float)(i + 1) / BEZIER_PATCH_RINGS;
+            for (int j = 0; j < BEZIER_PATCH_SECTORS; j++) {
+                float u0 = (float)j / BEZIER_PATCH_SECTORS, u1 = (float)(j + 1) / BEZIER_PATCH_SECTORS;
+                float patch[8] = { t0, u0, t0, u1, t1, u1, t1, u0 };
+                corners.insert(corners.end(), patch, patch + 8);
+            }
+        }
+
+        unsigned int vbo;
+        glGenVertexArrays(1, &vao);
+        glGenBuffers(1, &vbo);
+        glBindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferData(GL_ARRAY_BUFFER, corners.size() * sizeof(float), corners.data(), GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        return vao;
+    }
+};
+
+#endif /* bezier_revolution_h */
@@ -0,0 +1,73 @@
+#ifndef camera_uniforms_h
+#define camera_uniforms_h
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "shader.h"
+
+// std140 image of the Camera uniform block every shader declares:
+//
+//     layout (std140) uniform Camera {
+//         mat4 view;
+//         mat4 projection;
+//         mat4 viewProjection;
+//         vec3 viewPos;
+//         float time;
+//         vec2 viewportSize;
+//     };
+struct CameraUniformData {
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::mat4 viewProjection;
+    glm::vec3 viewPos;
+    float time;
+    glm::vec2 viewportSize;
+    glm::vec2 padding;
+};
+static_assert(sizeof(CameraUniformData) == 224, "CameraUniformData must match the std140 Camera block");
+
+// The per-frame camera state in one uniform buffer at
+// Shader::CAMERA_BLOCK_BINDING. Shader binds the block of every program it
+// links to that index, so a frame costs one upload however many programs
+// read it, and a new program needs no per-frame setup.
+class CameraUniforms {
+public:
+    static CameraUniforms& shared()
+    {
+        static CameraUniforms uniforms;
+        return uniforms;
+    }
+
+    void update(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& viewPos, float time, const glm::vec2& viewportSize)
+    {
+        data.view = view;
+        data.projection = projection;
+        data.viewProjection = projection * view;
+        data.viewPos = viewPos;
+        data.time = time;
+        data.viewportSize = viewportSize;
+        data.padding = glm::vec2(0.0f);
+
+        if (buffer == 0) {
+            glGenBuffers(1, &buffer);
+            glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+            glBufferData(GL_UNIFORM_BUFFER, sizeof(CameraUniformData), NULL, GL_DYNAMIC_DRAW);
+            glBindBufferBase(GL_UNIFORM_BUFFER, Shader::CAMERA_BLOCK_BINDING, buffer);
+        }
+        glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(CameraUniformData), &data);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    const CameraUniformData& get() const { return data; }
+
+private:
+    CameraUniforms() {}
+    CameraUniforms(const CameraUniforms&) = delete;
+    CameraUniforms& operator=(const CameraUniforms&) = delete;
+
+    CameraUniformData data;
+    unsigned int buffer = 0;
+};
+
+#endif /* camera_uniforms_h */
@@ -14,6 +14,14 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include "shader.h"
+#include "geometry_arena.h"
+#include "mesh_handle.h"
+#include "static_scene.h"
+#include "procedural_primitives.h"
+#include "mesh_batch.h"
+#include "primitive_tables.h"
+#include "material_table.h"
+#include "texture_residency.h"
 
 using namespace std;
 
@@ -31,16 +39,12 @@ public:
     float TYmin = 0.0f;
     float TYmax = 1.0f;
     unsigned int diffuseMap;
-    unsigned int specularMap;
 
     // common property
     float shininess;
 
     // constructors
-    Cube()
-    {
-        setUpCubeVertexDataAndConfigureVertexAttribute();
-    }
+    Cube() {}
 
     Cube(glm::vec3 amb, glm::vec3 diff, glm::vec3 spec, float shiny)
     {
@@ -48,53 +52,44 @@ public:
         this->diffuse = diff;
         this->specular = spec;
         this->shininess = shiny;
-
-        setUpCubeVertexDataAndConfigureVertexAttribute();
     }
 
-    Cube(unsigned int dMap, unsigned int sMap, float shiny, float textureXmin, float textureYmin, float textureXmax, float textureYmax)
+    Cube(unsigned int dMap, float shiny, float textureXmin, float textureYmin, float textureXmax, float textureYmax)
     {
         this->diffuseMap = dMap;
-        this->specularMap = sMap;
         this->shininess = shiny;
         this->TXmin = textureXmin;
         this->TYmin = textureYmin;
         this->TXmax = textureXmax;
         this->TYmax = textureYmax;
-
-        setUpCubeVertexDataAndConfigureVertexAttribute();
-    }
-
-    // destructor
-    ~Cube()
-    {
-        glDeleteVertexArrays(1, &cubeVAO);
-        glDeleteVertexArrays(1, &lightCubeVAO);
-        glDeleteVertexArrays(1, &lightTexCubeVAO);
-        glDeleteBuffers(1, &cubeVBO);
-        glDeleteBuffers(1, &cubeEBO);
     }
 
     void drawCubeWithTexture(Shader& lightingShaderWithTexture, glm::mat4 model = glm::mat4(1.0f))
     {
+        if (StaticScene* scene = StaticScene::recording()) {
+            unsigned int material = scene->addMaterial(this->diffuseMap, this->shininess);
+            if (scene->usesProceduralPrimitives())
+                scene->addProceduralDraw(STATIC_PASS_TEXTURED, PROCEDURAL_CUBE, 0, model, material, glm::vec3(1.0f), textureTransform());
+            else
+                scene->addDraw(STATIC_PASS_TEXTURED, mesh(), model, material);
+            return;
+        }
+
         lightingShaderWithTexture.use();
 
         lightingShaderWithTexture.setInt("material.diffuse", 0);
-        lightingShaderWithTexture.setInt("material.specular", 1);
         lightingShaderWithTexture.setFloat("material.shininess", this->shininess);
 
 
         // bind diffuse map
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, this->diffuseMap);
-        // bind specular map
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, this->specularMap);
+        TextureResidency::shared().use(this->diffuseMap, model, GeometryArena::shared().meshBounds(mesh()),
+            max(TXmax - TXmin, TYmax - TYmin));
 
         lightingShaderWithTexture.setMat4("model", model);
 
-        glBindVertexArray(lightTexCubeVAO);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
+        GeometryArena::shared().drawMesh(mesh());
     }
 
     void drawCubeWithMaterialisticProperty(Shader& lightingShader, glm::mat4 model, glm::vec3 lightColor)
@@ -103,39 +98,49 @@ public:
 
         lightingShader.setVec3("color", lightColor);
 
-        lightingShader.setVec3("material.ambient", this->ambient);
-        lightingShader.setVec3("material.diffuse", this->diffuse);
-        lightingShader.setVec3("material.specular", this->specular);
-        lightingShader.setFloat("material.shininess", this->shininess);
+        lightingShader.setInt("materialIndex", MaterialTable::shared().add(this->ambient, this->diffuse, this->specular, this->shininess));
 
         lightingShader.setMat4("model", model);
 
-        glBindVertexArray(lightCubeVAO);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
+        GeometryArena::shared().drawMesh(mesh());
     }
 
     void drawCube(Shader& shader, glm::mat4 model = glm::mat4(1.0f), float r = 1.0f, float g = 1.0f, float b = 1.0f)
     {
+        if (StaticScene* scene = StaticScene::recording()) {
+            if (scene->usesProceduralPrimitives())
+                scene->addProceduralDraw(STATIC_PASS_FLAT, PROCEDURAL_CUBE, 0, model, 0, glm::vec3(r, g, b));
+            else
+                scene->addDraw(STATIC_PASS_FLAT, mesh(), model, 0, glm::vec3(r, g, b));
+            return;
+        }
+
         shader.use();
 
         shader.setVec3("color", glm::vec3(r, g, b));
         shader.setMat4("model", model);
 
-        glBindVertexArray(cubeVAO);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
+        GeometryArena::shared().drawMesh(mesh());
     }
 
 
     void drawLightCube(Shader& lightShader, glm::mat4 model, glm::vec3 lightColor)
     {
+        if (StaticScene* scene = StaticScene::recording()) {
+            if (scene->usesProceduralPrimitives())
+                scene->addProceduralDraw(STATIC_PASS_FLAT, PROCEDURAL_CUBE, 0, model, 0, lightColor);
+            else
+                scene->addDraw(STATIC_PASS_FLAT, mesh(), model, 0, lightColor);
+            return;
+        }
+
         lightShader.use();
 
         lightShader.setVec3("color", lightColor);
 
         lightShader.setMat4("model", model);
 
-        glBindVertexArray(lightCubeVAO);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
+        GeometryArena::shared().drawMesh(mesh());
     }
 
     void setMaterialisticProperty(glm::vec3 amb, glm::vec3 diff, glm::vec3 spec, float shiny)
@@ -146,125 +151,35 @@ public:
         this->shininess = shiny;
     }
 
-    void setTextureProperty(unsigned int dMap, unsigned int sMap, float shiny)
+    void setTextureProperty(unsigned int dMap, float shiny)
     {
         this->diffuseMap = dMap;
-        this->specularMap = sMap;
         this->shininess = shiny;
     }
 
 private:
-    unsigned int cubeVAO;
-    unsigned int lightCubeVAO;
-    unsigned int lightTexCubeVAO;
-    unsigned int cubeVBO;
-    unsigned int cubeEBO;
+    MeshHandle cubeMesh;
 
-    void setUpCubeVertexDataAndConfigureVertexAttribute()
+    // the arena mesh for direct draws, built on first use; procedural
+    // draws in the static scene need none
+    unsigned int mesh()
     {
-        // set up vertex data (and buffer(s)) and configure vertex attributes
-        // ------------------------------------------------------------------
-
-        float cube_vertices[] = {
-            // positions      // normals         // texture
-            0.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, TXmax, TYmin,
-            1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, TXmin, TYmin,
-            1.0f, 1.0f, 0.0f, 0.0f, 0.0f, -1.0f, TXmin, TYmax,
-            0.0f, 1.0f, 0.0f, 0.0f, 0.0f, -1.0f, TXmax, TYmax,
-
-            1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, TXmax, TYmin,
-            1.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, TXmax, TYmax,
-            1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, TXmin, TYmin,
-            1.0f, 1.0f, 1.0f, 1.0f, 0.0f, 0.0f, TXmin, TYmax,
-
-            0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, TXmin, TYmin,
-            1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, TXmax, TYmin,
-            1.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f, TXmax, TYmax,
-            0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f, TXmin, TYmax,
-
-            0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, TXmax, TYmin,
-            0.0f, 1.0f, 1.0f, -1.0f, 0.0f, 0.0f, TXmax, TYmax,
-            0.0f, 1.0f, 0.0f, -1.0f, 0.0f, 0.0f, TXmin, TYmax,
-            0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f, TXmin, TYmin,
-
-            1.0f, 1.0f, 1.0f, 0.0f, 1.0f, 0.0f, TXmax, TYmin,
-            1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, TXmax, TYmax,
-            0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, TXmin, TYmax,
-            0.0f, 1.0f, 1.0f, 0.0f, 1.0f, 0.0f, TXmin, TYmin,
-
-            0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, TXmin, TYmin,
-            1.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, TXmax, TYmin,
-            1.0f, 0.0f, 1.0f, 0.0f, -1.0f, 0.0f, TXmax, TYmax,
-            0.0f, 0.0f, 1.0f, 0.0f, -1.0f, 0.0f, TXmin, TYmax
-        };
-        unsigned int cube_indices[] = {
-            0, 3, 2,
-            2, 1, 0,
-
-            4, 5, 7,
-            7, 6, 4,
-
-            8, 9, 10,
-            10, 11, 8,
-
-            12, 13, 14,
-            14, 15, 12,
-
-            16, 17, 18,
-            18, 19, 16,
-
-            20, 21, 22,
-            22, 23, 20
-        };
-
-
-        glGenVertexArrays(1, &cubeVAO);
-        glGenVertexArrays(1, &lightCubeVAO);
-        glGenVertexArrays(1, &lightTexCubeVAO);
-        glGenBuffers(1, &cubeVBO);
-        glGenBuffers(1, &cubeEBO);
-
-
-        glBindVertexArray(lightTexCubeVAO);
-
-        glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(cube_vertices), cube_vertices, GL_STATIC_DRAW);
-
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cubeEBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(cube_indices), cube_indices, GL_STATIC_DRAW);
-
-        // position attribute
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(0);
-
-        // vertex normal attribute
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)12);
-        glEnableVertexAttribArray(1);
-
-        // texture coordinate attribute
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)24);
-        glEnableVertexAttribArray(2);
-
-
-        glBindVertexArray(lightCubeVAO);
-
-        glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cubeEBO);
-
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(0);
-
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)12);
-        glEnableVertexAttribArray(1);
-
-
-        glBindVertexArray(cubeVAO);
+        if (!cubeMesh.valid()) {
+            string key = (MeshKey("cube") << TXmin << TYmin << TXmax << TYmax).str();
+            cubeMesh.reset(GeometryArena::shared().upload(
+                prepareMesh(key, [this](MeshBuilder& builder) { buildCube(builder); }, VERTEX_FORMAT_PACKED), key));
+        }
+        return cubeMesh;
+    }
 
-        glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cubeEBO);
+    // maps the unit texture coordinates of the cube table and the
+    // procedural cube onto the texture range
+    glm::vec4 textureTransform() const { return glm::vec4(TXmax - TXmin, TYmax - TYmin, TXmin, TYmin); }
 
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(0);
+    // the direct-draw mesh: the compiled unit cube over the texture range
+    void buildCube(MeshBuilder& builder)
+    {
+        addCube(builder, textureTransform());
     }
 
 };
@@ -43,8 +43,20 @@ struct SpotLight {
 
 #define NR_POINT_LIGHTS 2
 
-uniform vec3 viewPos;
-uniform Material material;
+layout (std140) uniform Camera {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec3 viewPos;
+    float time;
+    vec2 viewportSize;
+};
+#define MAX_MATERIALS 256
+
+layout (std140) uniform Materials {
+    Material materials[MAX_MATERIALS];
+};
+uniform int materialIndex;
 uniform PointLight pointLights[NR_POINT_LIGHTS];
 uniform DiectionalLight diectionalLight;
 uniform SpotLight spotlight;
@@ -57,6 +69,7 @@ vec3 CalcSpotLight(Material material, SpotLight light, vec3 N, vec3 fragPos, vec
 
 void main()
 {
+    Material material = materials[materialIndex];
     vec3 N = normalize(Normal);
     vec3 V = normalize(viewPos - FragPos);
     
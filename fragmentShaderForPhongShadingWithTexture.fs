@@ -6,8 +6,7 @@ in vec2 TexCoords; // Added to pass texture coordinates from vertex shader
 out vec4 FragColor;
 
 struct Material {
-    sampler2D diffuse;   // Texture for diffuse lighting
-    sampler2D specular;  // Texture for specular lighting
+    sampler2D diffuse;   // Texture for diffuse lighting, specular intensity in alpha
     float shininess;     // Shininess factor for specular highlights
 };
 
@@ -42,7 +41,14 @@ struct SpotLight {
 
 #define NR_POINT_LIGHTS 2
 
-uniform vec3 viewPos;
+layout (std140) uniform Camera {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec3 viewPos;
+    float time;
+    vec2 viewportSize;
+};
 uniform Material material;
 uniform PointLight pointLights[NR_POINT_LIGHTS];
 uniform DiectionalLight diectionalLight;
@@ -51,26 +57,31 @@ uniform bool dlighton;
 uniform bool spotlighton;
 
 // Function prototypes
-vec3 CalcPointLight(Material material, PointLight light, vec3 N, vec3 fragPos, vec3 V);
-vec3 CalcDirectionalLight(Material material, DiectionalLight light, vec3 N, vec3 V);
-vec3 CalcSpotLight(Material material, SpotLight light, vec3 N, vec3 fragPos, vec3 V);
+vec3 CalcPointLight(Material material, PointLight light, vec3 N, vec3 fragPos, vec3 V, vec3 texDiffuse, vec3 texSpecular);
+vec3 CalcDirectionalLight(Material material, DiectionalLight light, vec3 N, vec3 V, vec3 texDiffuse, vec3 texSpecular);
+vec3 CalcSpotLight(Material material, SpotLight light, vec3 N, vec3 fragPos, vec3 V, vec3 texDiffuse, vec3 texSpecular);
 
 void main()
 {
     vec3 N = normalize(Normal);
     vec3 V = normalize(viewPos - FragPos);
     
+    // one fetch for both terms
+    vec4 texel = texture(material.diffuse, TexCoords);
+    vec3 texDiffuse = texel.rgb;
+    vec3 texSpecular = vec3(texel.a);
+
     vec3 result = vec3(0.0);
     
     // Add lighting contributions
     for (int i = 0; i < NR_POINT_LIGHTS; i++)
-        result += CalcPointLight(material, pointLights[i], N, FragPos, V);
+        result += CalcPointLight(material, pointLights[i], N, FragPos, V, texDiffuse, texSpecular);
     
     if (dlighton)
-        result += CalcDirectionalLight(material, diectionalLight, N, V);
+        result += CalcDirectionalLight(material, diectionalLight, N, V, texDiffuse, texSpecular);
 
     if (spotlighton)
-        result += CalcSpotLight(material, spotlight, N, FragPos, V);
+        result += CalcSpotLight(material, spotlight, N, FragPos, V, texDiffuse, texSpecular);
 
     // Final color output
     FragColor = vec4(result, 1.0);
@@ -78,15 +89,11 @@ void main()
 
 }
 
-vec3 CalcPointLight(Material material, PointLight light, vec3 N, vec3 fragPos, vec3 V)
+vec3 CalcPointLight(Material material, PointLight light, vec3 N, vec3 fragPos, vec3 V, vec3 texDiffuse, vec3 texSpecular)
 {
     vec3 L = normalize(light.position - fragPos);
     vec3 R = reflect(-L, N);
 
-    // Sample texture values
-    vec3 texDiffuse = vec3(texture(material.diffuse, TexCoords));
-    vec3 texSpecular = vec3(texture(material.specular, TexCoords));
-
     float d = length(light.position - fragPos);
     float attenuation = 1.0 / (light.k_c + light.k_l * d + light.k_q * (d * d));
 
@@ -97,15 +104,11 @@ vec3 CalcPointLight(Material material, PointLight light, vec3 N, vec3 fragPos, v
     return ambient + diffuse + specular;
 }
 
-vec3 CalcDirectionalLight(Material material, DiectionalLight light, vec3 N, vec3 V)
+vec3 CalcDirectionalLight(Material material, DiectionalLight light, vec3 N, vec3 V, vec3 texDiffuse, vec3 texSpecular)
 {
     vec3 L = normalize(-light.direction);
     vec3 R = reflect(-L, N);
 
-    // Sample texture values
-    vec3 texDiffuse = vec3(texture(material.diffuse, TexCoords));
-    vec3 texSpecular = vec3(texture(material.specular, TexCoords));
-
     vec3 ambient = texDiffuse * light.ambient;
     vec3 diffuse = texDiffuse * max(dot(N, L), 0.0) * light.diffuse;
     vec3 specular = texSpecular * pow(max(dot(V, R), 0.0), material.shininess) * light.specular;
@@ -113,15 +116,11 @@ vec3 CalcDirectionalLight(Material material, DiectionalLight light, vec3 N, vec3
     return ambient + diffuse + specular;
 }
 
-vec3 CalcSpotLight(Material material, SpotLight light, vec3 N, vec3 fragPos, vec3 V)
+vec3 CalcSpotLight(Material material, SpotLight light, vec3 N, vec3 fragPos, vec3 V, vec3 texDiffuse, vec3 texSpecular)
 {
     vec3 L = normalize(light.position - fragPos);
     vec3 R = reflect(-L, N);
 
-    // Sample texture values
-    vec3 texDiffuse = vec3(texture(material.diffuse, TexCoords));
-    vec3 texSpecular = vec3(texture(material.specular, TexCoords));
-
     float d = length(light.position - fragPos);
     float attenuation = 1.0 / (light.k_c + light.k_l * d + light.k_q * (d * d));
 
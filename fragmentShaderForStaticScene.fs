@@ -0,0 +1,23 @@
+#version 430 core
+
+flat in vec3 Color;
+flat in float Fade;
+
+out vec4 FragColor;
+
+// clustered geometry hands over to its impostor: impostor.fs keeps the
+// fragments whose threshold is below the fade, this keeps the rest
+const float bayer[16] = float[](
+     0.0,  8.0,  2.0, 10.0,
+    12.0,  4.0, 14.0,  6.0,
+     3.0, 11.0,  1.0,  9.0,
+    15.0,  7.0, 13.0,  5.0);
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy) & 3;
+    if (Fade >= (bayer[pixel.y * 4 + pixel.x] + 0.5) / 16.0)
+        discard;
+
+    FragColor = vec4(Color, 0.15f);
+}
@@ -0,0 +1,153 @@
+#version 430 core
+// Phong shading of the static scene: the same lights as
+// fragmentShaderForPhongShadingWithTexture.fs, with the map taken from the
+// layer of the batch's texture array chosen per draw.
+in vec3 FragPos;
+in vec3 Normal;
+in vec2 TexCoords;
+flat in uint DiffuseLayer;
+flat in float Shininess;
+flat in float Fade;
+
+out vec4 FragColor;
+
+struct Material {
+    sampler2DArray diffuse;     // specular intensity in alpha
+};
+
+struct PointLight {
+    vec3 position;
+    float k_c;           // Constant attenuation
+    float k_l;           // Linear attenuation
+    float k_q;           // Quadratic attenuation
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
+
+struct DiectionalLight {
+    vec3 direction;
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
+
+struct SpotLight {
+    vec3 position;
+    vec3 direction;
+    float cos_theta;     // Spotlight cutoff
+    float k_c;           // Constant attenuation
+    float k_l;           // Linear attenuation
+    float k_q;           // Quadratic attenuation
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
+
+#define NR_POINT_LIGHTS 2
+
+layout (std140) uniform Camera {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec3 viewPos;
+    float time;
+    vec2 viewportSize;
+};
+uniform Material material;
+uniform PointLight pointLights[NR_POINT_LIGHTS];
+uniform DiectionalLight diectionalLight;
+uniform SpotLight spotlight;
+uniform bool dlighton;
+uniform bool spotlighton;
+
+// clustered geometry hands over to its impostor: impostor.fs keeps the
+// fragments whose threshold is below the fade, this keeps the rest
+const float bayer[16] = float[](
+     0.0,  8.0,  2.0, 10.0,
+    12.0,  4.0, 14.0,  6.0,
+     3.0, 11.0,  1.0,  9.0,
+    15.0,  7.0, 13.0,  5.0);
+
+// Function prototypes
+vec3 CalcPointLight(Material material, PointLight light, vec3 N, vec3 fragPos, vec3 V, vec3 texDiffuse, vec3 texSpecular);
+vec3 CalcDirectionalLight(Material material, DiectionalLight light, vec3 N, vec3 V, vec3 texDiffuse, vec3 texSpecular);
+vec3 CalcSpotLight(Material material, SpotLight light, vec3 N, vec3 fragPos, vec3 V, vec3 texDiffuse, vec3 texSpecular);
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy) & 3;
+    if (Fade >= (bayer[pixel.y * 4 + pixel.x] + 0.5) / 16.0)
+        discard;
+
+    vec3 N = normalize(Normal);
+    vec3 V = normalize(viewPos - FragPos);
+    
+    // one fetch for both terms
+    vec4 texel = texture(material.diffuse, vec3(TexCoords, DiffuseLayer));
+    vec3 texDiffuse = texel.rgb;
+    vec3 texSpecular = vec3(texel.a);
+
+    vec3 result = vec3(0.0);
+    
+    // Add lighting contributions
+    for (int i = 0; i < NR_POINT_LIGHTS; i++)
+        result += CalcPointLight(material, pointLights[i], N, FragPos, V, texDiffuse, texSpecular);
+    
+    if (dlighton)
+        result += CalcDirectionalLight(material, diectionalLight, N, V, texDiffuse, texSpecular);
+
+    if (spotlighton)
+        result += CalcSpotLight(material, spotlight, N, FragPos, V, texDiffuse, texSpecular);
+
+    FragColor = vec4(result, 1.0);
+}
+
+vec3 CalcPointLight(Material material, PointLight light, vec3 N, vec3 fragPos, vec3 V, vec3 texDiffuse, vec3 texSpecular)
+{
+    vec3 L = normalize(light.position - fragPos);
+    vec3 R = reflect(-L, N);
+
+    float d = length(light.position - fragPos);
+    float attenuation = 1.0 / (light.k_c + light.k_l * d + light.k_q * (d * d));
+
+    vec3 ambient = texDiffuse * light.ambient * attenuation;
+    vec3 diffuse = texDiffuse * max(dot(N, L), 0.0) * light.diffuse * attenuation;
+    vec3 specular = texSpecular * pow(max(dot(V, R), 0.0), Shininess) * light.specular * attenuation;
+
+    return ambient + diffuse + specular;
+}
+
+vec3 CalcDirectionalLight(Material material, DiectionalLight light, vec3 N, vec3 V, vec3 texDiffuse, vec3 texSpecular)
+{
+    vec3 L = normalize(-light.direction);
+    vec3 R = reflect(-L, N);
+
+    vec3 ambient = texDiffuse * light.ambient;
+    vec3 diffuse = texDiffuse * max(dot(N, L), 0.0) * light.diffuse;
+    vec3 specular = texSpecular * pow(max(dot(V, R), 0.0), Shininess) * light.specular;
+
+    return ambient + diffuse + specular;
+}
+
+vec3 CalcSpotLight(Material material, SpotLight light, vec3 N, vec3 fragPos, vec3 V, vec3 texDiffuse, vec3 texSpecular)
+{
+    vec3 L = normalize(light.position - fragPos);
+    vec3 R = reflect(-L, N);
+
+    float d = length(light.position - fragPos);
+    float attenuation = 1.0 / (light.k_c + light.k_l * d + light.k_q * (d * d));
+
+    float cos_alpha = dot(L, normalize(-light.direction));
+    float intensity = cos_alpha > light.cos_theta ? cos_alpha : 0.0;
+
+    vec3 ambient = texDiffuse * light.ambient;
+    vec3 diffuse = texDiffuse * max(dot(N, L), 0.0) * light.diffuse;
+    vec3 specular = texSpecular * pow(max(dot(V, R), 0.0), Shininess) * light.specular;
+
+    ambient *= attenuation * intensity;
+    diffuse *= attenuation * intensity;
+    specular *= attenuation * intensity;
+
+    return ambient + diffuse + specular;
+}
\ No newline at end of file
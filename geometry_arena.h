@@ -0,0 +1,697 @@
+#ifndef geometry_arena_h
+#define geometry_arena_h
+
+#include <glad/glad.h>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <glm/glm.hpp>
+#include "vertex_format.h"
+#include "mesh_optimizer.h"
+
+using namespace std;
+
+// a mesh's sub-allocation inside the arena buffers
+struct ArenaMesh {
+    VertexFormat format;
+    int baseVertex;             // first vertex in the format's VBO
+    int vertexCount;
+    GLenum indexType;           // GL_UNSIGNED_SHORT whenever the vertex count allows
+    unsigned int firstIndex;    // first index in the shared EBO, in units of indexType
+    int indexCount;
+    glm::mat4 dequantization;   // stored position -> mesh space, identity unless quantized
+    glm::vec3 center;           // mesh-space bounding sphere
+    float radius;
+    MeshOptimizationReport optimization;
+    bool live;
+};
+
+struct ArenaStats {
+    int liveMeshes;
+    int liveVertices;
+    int liveIndices;
+    int weldedVertices;
+    float acmrBefore;           // over all live triangles
+    float acmrAfter;
+    int vertexBytes;            // live vertex data in the meshes' own formats
+    int floatVertexBytes;       // the same vertices in VERTEX_FORMAT_FLOAT
+    int indexBytes;             // live index data at the meshes' own index types
+    int wideIndexBytes;         // the same indices as GL_UNSIGNED_INT
+    int shortIndexMeshes;
+    int indexCapacity;          // in bytes
+    int freeVertexBlocks;       // holes left behind by released meshes
+    int freeIndexBlocks;
+    int freeVertices;
+    int freeIndices;
+    int defragmentations;
+    int growths;
+};
+
+// positions and indices kept on the CPU after upload, for picking or
+// collision; meshes keep none unless asked to
+struct RetainedGeometry {
+    vector<glm::vec3> positions;        // mesh space, dequantized
+    vector<unsigned int> indices;
+};
+
+// a mesh optimised and encoded on the CPU, waiting for its arena ranges
+struct PreparedMesh {
+    ArenaMesh mesh;                     // everything but baseVertex and firstIndex
+    vector<unsigned char> vertices;     // in mesh.format
+    vector<unsigned char> indices;      // in mesh.indexType
+
+    // set instead of the vectors when the data lives in a mapped cache file,
+    // which storage keeps open
+    shared_ptr<const void> storage;
+    const unsigned char* mappedVertices = nullptr;
+    const unsigned char* mappedIndices = nullptr;
+
+    const unsigned char* vertexData() const { return storage ? mappedVertices : vertices.data(); }
+    const unsigned char* indexData() const { return storage ? mappedIndices : indices.data(); }
+    size_t vertexBytes() const { return (size_t)mesh.vertexCount * vertexFormatStride(mesh.format); }
+    size_t indexBytes() const { return (size_t)mesh.indexCount * (mesh.indexType == GL_UNSIGNED_SHORT ? 2 : 4); }
+};
+
+// All primitive meshes share one EBO and, per vertex format, one VBO and VAO,
+// and are drawn with glDrawElementsBaseVertex. Indices stay local to their
+// mesh, so a mesh can be moved by the arena without touching its index data,
+// and meshes of up to 65536 vertices store them as 16-bit. The EBO is
+// allocated in 2-byte units, 32-bit index ranges aligned to 4 bytes.
+// Every VAO bind goes through the arena, which skips redundant ones.
+class GeometryArena {
+public:
+    static const int VERTEX_FLOATS = SOURCE_VERTEX_FLOATS;
+    static const unsigned int NO_MESH = 0xffffffffu;     // a handle release() ignores
+
+    static GeometryArena& shared()
+    {
+        static GeometryArena arena;
+        return arena;
+    }
+
+    // Deletes the arena's GL objects while the context is still current.
+    // Handles released after this only drop their bookkeeping, without
+    // compacting or any GL call, so meshes may be owned by objects that
+    // outlive the context.
+    void shutdown()
+    {
+        for (int f = 0; f < VERTEX_FORMAT_COUNT; f++) {
+            glDeleteVertexArrays(1, &pools[f].vao);
+            glDeleteBuffers(1, &pools[f].vbo);
+            pools[f].vao = pools[f].vbo = 0;
+        }
+        glDeleteBuffers(1, &arenaEBO);
+        glDeleteBuffers(1, &drawIDBuffer);
+        arenaEBO = drawIDBuffer = 0;
+        drawIDCount = 0;
+        boundVAO = 0;
+        shutDown = true;
+    }
+
+    // The CPU half of adding a mesh: the 8-float source vertices are
+    // optimised in place for the vertex cache, then encoded into format, and
+    // the bounds taken. It touches no GL or arena state, so worker threads
+    // may prepare meshes while the GL thread uploads others.
+    static PreparedMesh prepare(vector<float>& optimizedVertices, vector<unsigned int>& optimizedIndices, VertexFormat format)
+    {
+        PreparedMesh prepared;
+        ArenaMesh& mesh = prepared.mesh;
+        mesh.optimization = optimizeMesh(optimizedVertices, optimizedIndices, VERTEX_FLOATS);
+
+        const float* vertices = optimizedVertices.data();
+        int vertexCount = (int)optimizedVertices.size() / VERTEX_FLOATS;
+        int indexCount = (int)optimizedIndices.size();
+
+        mesh.format = format;
+        mesh.vertexCount = vertexCount;
+        mesh.indexCount = indexCount;
+        mesh.indexType = vertexCount <= 65536 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+        mesh.baseVertex = 0;
+        mesh.firstIndex = 0;
+        mesh.live = false;
+
+        prepared.vertices = encodeVertices(vertices, vertexCount, format, mesh.dequantization);
+        if (mesh.indexType == GL_UNSIGNED_SHORT) {
+            prepared.indices.resize((size_t)indexCount * sizeof(unsigned short));
+            unsigned short* shortIndices = (unsigned short*)prepared.indices.data();
+            for (int i = 0; i < indexCount; i++)
+                shortIndices[i] = (unsigned short)optimizedIndices[i];
+        }
+        else {
+            prepared.indices.resize((size_t)indexCount * sizeof(unsigned int));
+            memcpy(prepared.indices.data(), optimizedIndices.data(), prepared.indices.size());
+        }
+
+        glm::vec3 minCorner(1e30f), maxCorner(-1e30f);
+        for (int i = 0; i < vertexCount; i++) {
+            glm::vec3 p(vertices[i * VERTEX_FLOATS], vertices[i * VERTEX_FLOATS + 1], vertices[i * VERTEX_FLOATS + 2]);
+            minCorner = glm::min(minCorner, p);
+            maxCorner = glm::max(maxCorner, p);
+        }
+        mesh.center = (minCorner + maxCorner) * 0.5f;
+        mesh.radius = glm::length(maxCorner - minCorner) * 0.5f;
+        return prepared;
+    }
+
+    // the GL half: takes ranges in the arena and fills them.
+    // The prepared data is not kept unless retainGeometry is set, in which
+    // case positions and indices are decoded from it first.
+    unsigned int upload(const PreparedMesh& prepared, const string& label = string(), bool retainGeometry = false)
+    {
+        if (arenaEBO == 0)
+            create(65536 * 2);
+
+        ArenaMesh mesh = prepared.mesh;
+        VertexPool& pool = pools[mesh.format];
+        if (pool.vao == 0)
+            createPool(mesh.format, 16384);
+
+        mesh.baseVertex = takeRange(pool.freeList, pool.top, mesh.vertexCount, 1);
+        int unitsPerIndex = indexUnitSize(mesh);
+        mesh.firstIndex = (unsigned int)(takeRange(freeIndices, indexTop, indexUnits(mesh), unitsPerIndex) / unitsPerIndex);
+        mesh.live = true;
+
+        if (pool.top > pool.capacity)
+            growPool(mesh.format, pool.top * 2);
+        if (indexTop * 2 > indexCapacity)
+            growIndices(indexTop * 4);
+
+        int stride = vertexFormatStride(mesh.format);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, pool.vbo);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)mesh.baseVertex * stride, (GLsizeiptr)prepared.vertexBytes(), prepared.vertexData());
+        glBindBuffer(GL_COPY_WRITE_BUFFER, arenaEBO);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, indexOffset(mesh), (GLsizeiptr)prepared.indexBytes(), prepared.indexData());
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        // reuse a released handle before growing the table
+        size_t handle = 0;
+        while (handle < meshes.size() && meshes[handle].live)
+            handle++;
+        if (handle == meshes.size()) {
+            meshes.push_back(mesh);
+            labels.push_back(label);
+            retained.push_back(RetainedGeometry());
+        }
+        else {
+            meshes[handle] = mesh;
+            labels[handle] = label;
+        }
+        if (retainGeometry)
+            retained[handle] = decodeGeometry(prepared);
+        return (unsigned int)handle;
+    }
+
+    // the CPU copy kept for a mesh uploaded with retainGeometry, or null
+    const RetainedGeometry* getRetainedGeometry(unsigned int handle) const
+    {
+        if (handle >= meshes.size() || !meshes[handle].live || retained[handle].indices.empty())
+            return nullptr;
+        return &retained[handle];
+    }
+
+    // frees a mesh's ranges; compacts the arena once the holes make up more
+    // than a quarter of the used space
+    void release(unsigned int handle)
+    {
+        if (handle >= meshes.size() || !meshes[handle].live)
+            return;
+
+        ArenaMesh& mesh = meshes[handle];
+        VertexPool& pool = pools[mesh.format];
+        giveRange(pool.freeList, pool.top, mesh.baseVertex, mesh.vertexCount);
+        giveRange(freeIndices, indexTop, (int)indexOffset(mesh) / 2, indexUnits(mesh));
+        mesh.live = false;
+        RetainedGeometry().positions.swap(retained[handle].positions);
+        vector<unsigned int>().swap(retained[handle].indices);
+
+        if (!shutDown && (holeSize(pool.freeList) * 4 > pool.top || holeSize(freeIndices) * 4 > indexTop))
+            defragment();
+    }
+
+    // packs all live meshes to the front of freshly allocated buffers
+    void defragment()
+    {
+        if (arenaEBO == 0)
+            return;
+
+        for (int f = 0; f < VERTEX_FORMAT_COUNT; f++) {
+            VertexPool& pool = pools[f];
+            if (pool.vao == 0)
+                continue;
+
+            int stride = vertexFormatStride((VertexFormat)f);
+            unsigned int packedVBO;
+            glGenBuffers(1, &packedVBO);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, packedVBO);
+            glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)pool.capacity * stride, NULL, GL_STATIC_DRAW);
+            glBindBuffer(GL_COPY_READ_BUFFER, pool.vbo);
+
+            int cursor = 0;
+            for (size_t i = 0; i < meshes.size(); i++) {
+                if (!meshes[i].live || meshes[i].format != f)
+                    continue;
+                glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                    (GLintptr)meshes[i].baseVertex * stride, (GLintptr)cursor * stride,
+                    (GLsizeiptr)meshes[i].vertexCount * stride);
+                meshes[i].baseVertex = cursor;
+                cursor += meshes[i].vertexCount;
+            }
+
+            glDeleteBuffers(1, &pool.vbo);
+            pool.vbo = packedVBO;
+            pool.top = cursor;
+            pool.freeList.clear();
+        }
+
+        unsigned int packedEBO;
+        glGenBuffers(1, &packedEBO);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, packedEBO);
+        glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)indexCapacity, NULL, GL_STATIC_DRAW);
+        glBindBuffer(GL_COPY_READ_BUFFER, arenaEBO);
+
+        // 32-bit ranges first, so every one of them stays 4-byte aligned
+        int indexCursor = 0;
+        for (int pass = 0; pass < 2; pass++) {
+            GLenum type = pass == 0 ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT;
+            for (size_t i = 0; i < meshes.size(); i++) {
+                if (!meshes[i].live || meshes[i].indexType != type)
+                    continue;
+                int units = indexUnits(meshes[i]);
+                glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                    indexOffset(meshes[i]), (GLintptr)indexCursor * 2, (GLsizeiptr)units * 2);
+                meshes[i].firstIndex = (unsigned int)(indexCursor / indexUnitSize(meshes[i]));
+                indexCursor += units;
+            }
+        }
+
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        glDeleteBuffers(1, &arenaEBO);
+        arenaEBO = packedEBO;
+        indexTop = indexCursor;
+        freeIndices.clear();
+        configureVertexArrays();
+
+        defragmentations++;
+        generation++;
+    }
+
+    void bind(VertexFormat format)
+    {
+        if (boundVAO != pools[format].vao) {
+            boundVAO = pools[format].vao;
+            glBindVertexArray(boundVAO);
+        }
+    }
+
+    // for code that binds a vertex array of its own, so the next arena
+    // draw binds again
+    void forgetBinding()
+    {
+        boundVAO = 0;
+    }
+
+    void drawMesh(unsigned int handle, GLenum mode = GL_TRIANGLES)
+    {
+        const ArenaMesh& mesh = meshes[handle];
+        bind(mesh.format);
+        glDrawElementsBaseVertex(mode, mesh.indexCount, mesh.indexType, (void*)indexOffset(mesh), mesh.baseVertex);
+    }
+
+    // model matrix for a mesh, including its dequantization
+    glm::mat4 meshModel(unsigned int handle, const glm::mat4& model) const
+    {
+        return model * meshes[handle].dequantization;
+    }
+
+    // attribute 3 is an identity sequence advanced per instance, so an
+    // indirect command's baseInstance doubles as its draw id
+    void reserveDrawIDs(int count)
+    {
+        if (count <= drawIDCount)
+            return;
+
+        drawIDCount = max(count, drawIDCount * 2);
+        vector<unsigned int> drawIDs(drawIDCount);
+        for (int i = 0; i < drawIDCount; i++)
+            drawIDs[i] = (unsigned int)i;
+
+        glBindBuffer(GL_ARRAY_BUFFER, drawIDBuffer);
+        glBufferData(GL_ARRAY_BUFFER, drawIDs.size() * sizeof(unsigned int), drawIDs.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    const ArenaMesh& getMesh(unsigned int handle) const { return meshes[handle]; }
+    glm::vec4 meshBounds(unsigned int handle) const { return glm::vec4(meshes[handle].center, meshes[handle].radius); }
+
+    // bumped whenever meshes move, so cached offsets can be refreshed
+    unsigned int getGeneration() const { return generation; }
+
+    ArenaStats getStats() const
+    {
+        ArenaStats stats = ArenaStats();
+        for (size_t i = 0; i < meshes.size(); i++) {
+            if (!meshes[i].live)
+                continue;
+            stats.liveMeshes++;
+            stats.liveVertices += meshes[i].vertexCount;
+            stats.liveIndices += meshes[i].indexCount;
+            stats.weldedVertices += meshes[i].optimization.weldedVertices;
+            stats.acmrBefore += meshes[i].optimization.acmrBefore * (meshes[i].indexCount / 3);
+            stats.acmrAfter += meshes[i].optimization.acmrAfter * (meshes[i].indexCount / 3);
+            stats.vertexBytes += meshes[i].vertexCount * vertexFormatStride(meshes[i].format);
+            stats.floatVertexBytes += meshes[i].vertexCount * vertexFormatStride(VERTEX_FORMAT_FLOAT);
+            stats.indexBytes += indexUnits(meshes[i]) * 2;
+            stats.wideIndexBytes += meshes[i].indexCount * (int)sizeof(unsigned int);
+            if (meshes[i].indexType == GL_UNSIGNED_SHORT)
+                stats.shortIndexMeshes++;
+        }
+        for (int f = 0; f < VERTEX_FORMAT_COUNT; f++) {
+            stats.freeVertexBlocks += (int)pools[f].freeList.size();
+            stats.freeVertices += holeSize(pools[f].freeList);
+        }
+        if (stats.liveIndices >= 3) {
+            stats.acmrBefore /= (float)(stats.liveIndices / 3);
+            stats.acmrAfter /= (float)(stats.liveIndices / 3);
+        }
+        stats.indexCapacity = indexCapacity;
+        stats.freeIndexBlocks = (int)freeIndices.size();
+        stats.freeIndices = holeSize(freeIndices) / 2;
+        stats.defragmentations = defragmentations;
+        stats.growths = growths;
+        return stats;
+    }
+
+    void printStats() const
+    {
+        ArenaStats stats = getStats();
+        cout << "GEOMETRY_ARENA: " << stats.liveMeshes << " meshes, "
+            << stats.liveVertices << " vertices (" << stats.vertexBytes << " bytes, "
+            << stats.floatVertexBytes << " as float), "
+            << stats.weldedVertices << " welded, ACMR " << stats.acmrBefore << " -> " << stats.acmrAfter << ", "
+            << stats.liveIndices << " indices (" << stats.indexBytes << " bytes, "
+            << stats.wideIndexBytes << " as 32-bit, " << stats.shortIndexMeshes << " meshes 16-bit), "
+            << stats.freeVertexBlocks << " vertex holes (" << stats.freeVertices << "), "
+            << stats.freeIndexBlocks << " index holes (" << stats.freeIndices << "), "
+            << stats.growths << " growths, " << stats.defragmentations << " defragmentations" << endl;
+    }
+
+    // vertex memory of one mesh against the float format; the same ratio
+    // applies to the vertex fetch bandwidth of every draw of it
+    void printMeshFootprint(const char* name, unsigned int handle) const
+    {
+        const ArenaMesh& mesh = meshes[handle];
+        int bytes = mesh.vertexCount * vertexFormatStride(mesh.format);
+        int floatBytes = mesh.vertexCount * vertexFormatStride(VERTEX_FORMAT_FLOAT);
+        cout << "GEOMETRY_ARENA: " << name << ": " << mesh.vertexCount << " vertices, "
+            << vertexFormatName(mesh.format) << " " << bytes << " bytes, float " << floatBytes << " bytes ("
+            << (floatBytes > 0 ? 100 - bytes * 100 / floatBytes : 0) << "% less per draw), "
+            << mesh.optimization.weldedVertices << " welded, " << mesh.optimization.clusters << " clusters, ACMR "
+            << mesh.optimization.acmrBefore << " -> " << mesh.optimization.acmrAfter << endl;
+    }
+
+    // every live mesh with the GPU bytes its ranges take and the CPU bytes
+    // it keeps (its record plus any retained geometry), then the totals
+    // against what the arena has allocated
+    void printMemoryReport() const
+    {
+        size_t gpuBytes = 0, cpuBytes = 0;
+        cout << "GEOMETRY_ARENA memory: handle, mesh, format, vertices, indices, GPU bytes, CPU bytes" << endl;
+        for (size_t i = 0; i < meshes.size(); i++) {
+            if (!meshes[i].live)
+                continue;
+            size_t gpu = (size_t)meshes[i].vertexCount * vertexFormatStride(meshes[i].format) + (size_t)indexUnits(meshes[i]) * 2;
+            size_t cpu = sizeof(ArenaMesh) + labels[i].capacity() + retained[i].positions.capacity() * sizeof(glm::vec3)
+                + retained[i].indices.capacity() * sizeof(unsigned int);
+            gpuBytes += gpu;
+            cpuBytes += cpu;
+            cout << "  " << i << "  " << (labels[i].empty() ? "-" : labels[i]) << "  " << vertexFormatName(meshes[i].format)
+                << "  " << meshes[i].vertexCount << "  " << meshes[i].indexCount << "  " << gpu << "  " << cpu << endl;
+        }
+
+        size_t gpuAllocated = (size_t)indexCapacity + (size_t)drawIDCount * sizeof(unsigned int);
+        for (int f = 0; f < VERTEX_FORMAT_COUNT; f++)
+            gpuAllocated += (size_t)pools[f].capacity * vertexFormatStride((VertexFormat)f);
+        cout << "GEOMETRY_ARENA memory: " << gpuBytes << " GPU bytes in use of " << gpuAllocated << " allocated, "
+            << cpuBytes << " CPU bytes" << endl;
+    }
+
+private:
+    static RetainedGeometry decodeGeometry(const PreparedMesh& prepared)
+    {
+        const ArenaMesh& mesh = prepared.mesh;
+        RetainedGeometry geometry;
+        geometry.positions.resize(mesh.vertexCount);
+        geometry.indices.resize(mesh.indexCount);
+
+        int stride = vertexFormatStride(mesh.format);
+        const unsigned char* vertices = prepared.vertexData();
+        for (int i = 0; i < mesh.vertexCount; i++) {
+            const unsigned char* v = vertices + (size_t)i * stride;
+            if (mesh.format == VERTEX_FORMAT_QUANTIZED) {
+                unsigned short q[3];
+                memcpy(q, v, sizeof(q));
+                glm::vec4 p(q[0] / 65535.0f, q[1] / 65535.0f, q[2] / 65535.0f, 1.0f);
+                geometry.positions[i] = glm::vec3(mesh.dequantization * p);
+            }
+            else {
+                memcpy(&geometry.positions[i][0], v, 3 * sizeof(float));
+            }
+        }
+
+        const unsigned char* indices = prepared.indexData();
+        for (int i = 0; i < mesh.indexCount; i++) {
+            if (mesh.indexType == GL_UNSIGNED_SHORT) {
+                unsigned short index;
+                memcpy(&index, indices + (size_t)i * 2, 2);
+                geometry.indices[i] = index;
+            }
+            else {
+                memcpy(&geometry.indices[i], indices + (size_t)i * 4, 4);
+            }
+        }
+        return geometry;
+    }
+
+    struct FreeBlock {
+        int offset;
+        int count;
+    };
+
+    struct VertexPool {
+        unsigned int vao = 0;
+        unsigned int vbo = 0;
+        int capacity = 0;
+        int top = 0;
+        vector<FreeBlock> freeList;
+    };
+
+    VertexPool pools[VERTEX_FORMAT_COUNT];
+    unsigned int boundVAO = 0;
+
+    vector<string> labels;                  // per handle, for reports
+    vector<RetainedGeometry> retained;      // per handle, empty unless retained
+
+    unsigned int arenaEBO = 0;
+    int indexCapacity = 0;      // bytes
+    int indexTop = 0;           // 2-byte units, as are the free ranges
+    vector<FreeBlock> freeIndices;
+
+    unsigned int drawIDBuffer = 0;
+    int drawIDCount = 0;
+
+    vector<ArenaMesh> meshes;
+    bool shutDown = false;
+
+    unsigned int generation = 0;
+    int defragmentations = 0;
+    int growths = 0;
+
+    GeometryArena() {}
+    GeometryArena(const GeometryArena&);
+    GeometryArena& operator=(const GeometryArena&);
+
+    void create(int indexBytes)
+    {
+        indexCapacity = indexBytes;
+
+        glGenBuffers(1, &arenaEBO);
+        glGenBuffers(1, &drawIDBuffer);
+
+        glBindBuffer(GL_COPY_WRITE_BUFFER, arenaEBO);
+        glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)indexCapacity, NULL, GL_STATIC_DRAW);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        reserveDrawIDs(1024);
+    }
+
+    void createPool(VertexFormat format, int vertices)
+    {
+        VertexPool& pool = pools[format];
+        pool.capacity = vertices;
+
+        glGenVertexArrays(1, &pool.vao);
+        glGenBuffers(1, &pool.vbo);
+
+        glBindBuffer(GL_COPY_WRITE_BUFFER, pool.vbo);
+        glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)pool.capacity * vertexFormatStride(format), NULL, GL_STATIC_DRAW);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        configureVertexArray(format);
+    }
+
+    void configureVertexArray(VertexFormat format)
+    {
+        VertexPool& pool = pools[format];
+        glBindVertexArray(pool.vao);
+        boundVAO = pool.vao;
+
+        glBindBuffer(GL_ARRAY_BUFFER, pool.vbo);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, arenaEBO);
+        configureVertexFormat(format);
+
+        // draw id attribute
+        glBindBuffer(GL_ARRAY_BUFFER, drawIDBuffer);
+        glVertexAttribIPointer(3, 1, GL_UNSIGNED_INT, sizeof(unsigned int), (void*)0);
+        glVertexAttribDivisor(3, 1);
+        glEnableVertexAttribArray(3);
+
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    void configureVertexArrays()
+    {
+        for (int f = 0; f < VERTEX_FORMAT_COUNT; f++) {
+            if (pools[f].vao != 0)
+                configureVertexArray((VertexFormat)f);
+        }
+    }
+
+    void growPool(VertexFormat format, int vertices)
+    {
+        VertexPool& pool = pools[format];
+        int stride = vertexFormatStride(format);
+
+        unsigned int largerVBO;
+        glGenBuffers(1, &largerVBO);
+        glBindBuffer(GL_COPY_READ_BUFFER, pool.vbo);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, largerVBO);
+        glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)vertices * stride, NULL, GL_STATIC_DRAW);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, (GLsizeiptr)pool.capacity * stride);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        glDeleteBuffers(1, &pool.vbo);
+        pool.vbo = largerVBO;
+        pool.capacity = vertices;
+        configureVertexArray(format);
+
+        growths++;
+    }
+
+    void growIndices(int indexBytes)
+    {
+        unsigned int largerEBO;
+        glGenBuffers(1, &largerEBO);
+        glBindBuffer(GL_COPY_READ_BUFFER, arenaEBO);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, largerEBO);
+        glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)indexBytes, NULL, GL_STATIC_DRAW);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, (GLsizeiptr)indexCapacity);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        glDeleteBuffers(1, &arenaEBO);
+        arenaEBO = largerEBO;
+        indexCapacity = indexBytes;
+        configureVertexArrays();
+
+        growths++;
+    }
+
+    // 2-byte units per index
+    static int indexUnitSize(const ArenaMesh& mesh)
+    {
+        return mesh.indexType == GL_UNSIGNED_SHORT ? 1 : 2;
+    }
+
+    static int indexUnits(const ArenaMesh& mesh)
+    {
+        return mesh.indexCount * indexUnitSize(mesh);
+    }
+
+    static GLintptr indexOffset(const ArenaMesh& mesh)
+    {
+        return (GLintptr)mesh.firstIndex * indexUnitSize(mesh) * 2;
+    }
+
+    // first fit from the free list, otherwise from the top of the arena;
+    // the skipped head of an aligned range stays free
+    static int takeRange(vector<FreeBlock>& freeList, int& top, int count, int alignment)
+    {
+        for (size_t i = 0; i < freeList.size(); i++) {
+            int offset = (freeList[i].offset + alignment - 1) / alignment * alignment;
+            int head = offset - freeList[i].offset;
+            if (freeList[i].count < head + count)
+                continue;
+
+            FreeBlock tail = { offset + count, freeList[i].count - head - count };
+            if (head > 0) {
+                freeList[i].count = head;
+                if (tail.count > 0)
+                    freeList.insert(freeList.begin() + i + 1, tail);
+            }
+            else if (tail.count > 0) {
+                freeList[i] = tail;
+            }
+            else {
+                freeList.erase(freeList.begin() + i);
+            }
+            return offset;
+        }
+
+        int offset = (top + alignment - 1) / alignment * alignment;
+        if (offset > top)
+            giveRange(freeList, top, top, offset - top);
+        top = offset + count;
+        return offset;
+    }
+
+    // returns a range to the free list, merging neighbours and the top
+    static void giveRange(vector<FreeBlock>& freeList, int& top, int offset, int count)
+    {
+        FreeBlock block = { offset, count };
+        vector<FreeBlock>::iterator it = freeList.begin();
+        while (it != freeList.end() && it->offset < offset)
+            ++it;
+        it = freeList.insert(it, block);
+
+        size_t i = it - freeList.begin();
+        if (i + 1 < freeList.size() && freeList[i].offset + freeList[i].count == freeList[i + 1].offset) {
+            freeList[i].count += freeList[i + 1].count;
+            freeList.erase(freeList.begin() + i + 1);
+        }
+        if (i > 0 && freeList[i - 1].offset + freeList[i - 1].count == freeList[i].offset) {
+            freeList[i - 1].count += freeList[i].count;
+            freeList.erase(freeList.begin() + i);
+            i--;
+        }
+        if (freeList[i].offset + freeList[i].count == top) {
+            top = freeList[i].offset;
+            freeList.erase(freeList.begin() + i);
+        }
+    }
+
+    static int holeSize(const vector<FreeBlock>& freeList)
+    {
+        int size = 0;
+        for (size_t i = 0; i < freeList.size(); i++)
+            size += freeList[i].count;
+        return size;
+    }
+};
+
+#endif /* geometry_arena_h */
@@ -0,0 +1,163 @@
+#version 430 core
+// Surface of an impostor: the fragment's prefab-space position is projected
+// onto the chosen frame, the stored normal and depth rebuild the point the
+// bake saw there, and it is lit with the scene's lights like the geometry.
+// Over the fade band a dither keeps a growing share of the fragments; the
+// clustered geometry keeps the complementary share, so every pixel shows
+// exactly one of the two.
+
+struct ImpostorInstance {
+    mat4 model;
+    vec4 bounds;
+    uint prefab;
+};
+
+layout (std430, binding = 0) readonly buffer ImpostorInstanceBuffer {
+    ImpostorInstance impostors[];
+};
+
+in vec3 LocalPos;
+flat in uint Instance;
+flat in vec3 FrameRight;
+flat in vec3 FrameUp;
+flat in vec3 FrameDirection;
+flat in vec2 FrameOrigin;
+flat in vec4 PrefabBounds;
+flat in float Fade;
+flat in mat3 NormalMatrix;
+
+out vec4 FragColor;
+
+struct PointLight {
+    vec3 position;
+    float k_c;           // Constant attenuation
+    float k_l;           // Linear attenuation
+    float k_q;           // Quadratic attenuation
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
+
+struct DiectionalLight {
+    vec3 direction;
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
+
+struct SpotLight {
+    vec3 position;
+    vec3 direction;
+    float cos_theta;     // Spotlight cutoff
+    float k_c;           // Constant attenuation
+    float k_l;           // Linear attenuation
+    float k_q;           // Quadratic attenuation
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
+
+#define NR_POINT_LIGHTS 2
+#define MAX_PREFABS 8
+
+layout (std140) uniform Camera {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec3 viewPos;
+    float time;
+    vec2 viewportSize;
+};
+uniform PointLight pointLights[NR_POINT_LIGHTS];
+uniform DiectionalLight diectionalLight;
+uniform SpotLight spotlight;
+uniform bool dlighton;
+uniform bool spotlighton;
+
+uniform mat4 world;
+uniform sampler2DArray albedoAtlas;     // rgb albedo, a coverage
+uniform sampler2DArray surfaceAtlas;    // rg octahedral normal, b depth, a specular
+uniform int framesPerSide;
+uniform float prefabShininess[MAX_PREFABS];
+
+const float bayer[16] = float[](
+     0.0,  8.0,  2.0, 10.0,
+    12.0,  4.0, 14.0,  6.0,
+     3.0, 11.0,  1.0,  9.0,
+    15.0,  7.0, 13.0,  5.0);
+
+vec3 octahedronDirection(vec2 e)
+{
+    vec3 n = vec3(e.x, 1.0 - abs(e.x) - abs(e.y), e.y);
+    if (n.y < 0.0)
+        n.xz = (1.0 - abs(n.zx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.z >= 0.0 ? 1.0 : -1.0);
+    return normalize(n);
+}
+
+vec3 lightSurface(vec3 albedo, float specularStrength, float shininess, vec3 L, vec3 N, vec3 V,
+    vec3 ambient, vec3 diffuse, vec3 specular)
+{
+    vec3 R = reflect(-L, N);
+    return albedo * ambient
+        + albedo * max(dot(N, L), 0.0) * diffuse
+        + specularStrength * pow(max(dot(V, R), 0.0), shininess) * specular;
+}
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy) & 3;
+    if (Fade < (bayer[pixel.y * 4 + pixel.x] + 0.5) / 16.0)
+        discard;
+
+    vec3 rel = LocalPos - PrefabBounds.xyz;
+    vec2 frameUV = vec2(dot(rel, FrameRight), dot(rel, FrameUp)) / PrefabBounds.w * 0.5 + 0.5;
+    if (any(lessThan(frameUV, vec2(0.0))) || any(greaterThan(frameUV, vec2(1.0))))
+        discard;
+
+    ImpostorInstance impostor = impostors[Instance];
+    vec3 uv = vec3(FrameOrigin + frameUV / float(framesPerSide), float(impostor.prefab));
+    vec4 albedo = texture(albedoAtlas, uv);
+    if (albedo.a < 0.5)
+        discard;
+    // filtered texels mix in empty ones, which are all zero
+    vec4 surface = texture(surfaceAtlas, uv) / albedo.a;
+    albedo.rgb /= albedo.a;
+
+    vec3 localNormal = octahedronDirection(surface.rg * 2.0 - 1.0);
+    vec3 local = PrefabBounds.xyz + FrameRight * dot(rel, FrameRight) + FrameUp * dot(rel, FrameUp)
+        + FrameDirection * (surface.b * 2.0 - 1.0) * PrefabBounds.w;
+
+    mat4 model = world * impostor.model;
+    vec3 fragPos = vec3(model * vec4(local, 1.0));
+    vec3 N = normalize(NormalMatrix * localNormal);
+    vec3 V = normalize(viewPos - fragPos);
+
+    vec4 clip = viewProjection * vec4(fragPos, 1.0);
+    gl_FragDepth = clip.z / clip.w * 0.5 + 0.5;
+
+    float shininess = prefabShininess[impostor.prefab];
+    vec3 result = vec3(0.0);
+    for (int i = 0; i < NR_POINT_LIGHTS; i++) {
+        PointLight light = pointLights[i];
+        float d = length(light.position - fragPos);
+        float attenuation = 1.0 / (light.k_c + light.k_l * d + light.k_q * (d * d));
+        result += attenuation * lightSurface(albedo.rgb, surface.a, shininess, normalize(light.position - fragPos), N, V,
+            light.ambient, light.diffuse, light.specular);
+    }
+
+    if (dlighton)
+        result += lightSurface(albedo.rgb, surface.a, shininess, normalize(-diectionalLight.direction), N, V,
+            diectionalLight.ambient, diectionalLight.diffuse, diectionalLight.specular);
+
+    if (spotlighton) {
+        vec3 L = normalize(spotlight.position - fragPos);
+        float d = length(spotlight.position - fragPos);
+        float attenuation = 1.0 / (spotlight.k_c + spotlight.k_l * d + spotlight.k_q * (d * d));
+        float cos_alpha = dot(L, normalize(-spotlight.direction));
+        float intensity = cos_alpha > spotlight.cos_theta ? cos_alpha : 0.0;
+        result += attenuation * intensity * lightSurface(albedo.rgb, surface.a, shininess, L, N, V,
+            spotlight.ambient, spotlight.diffuse, spotlight.specular);
+    }
+
+    FragColor = vec4(result, 1.0);
+}
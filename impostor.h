@@ -0,0 +1,334 @@
+#ifndef impostor_h
+#define impostor_h
+
+#include <glad/glad.h>
+#include <vector>
+#include <string>
+#include <memory>
+#include <functional>
+#include <iostream>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include "shader.h"
+#include "static_scene.h"
+#include "camera_uniforms.h"
+
+using namespace std;
+
+// How far and how well impostors replace furniture. The atlas of each
+// prefab is framesPerSide x framesPerSide views of frameSize pixels;
+// from distance, impostors replace the geometry over fadeWidth.
+struct ImpostorQuality {
+    int framesPerSide;
+    int frameSize;
+    float distance;
+    float fadeWidth;
+};
+
+// 0 = low, 1 = medium, 2 = high; better impostors also take over later
+inline ImpostorQuality impostorQuality(int level)
+{
+    static const ImpostorQuality levels[3] = {
+        { 8, 64, 16.0f, 4.0f },     //  512 x  512 per prefab
+        { 12, 96, 24.0f, 5.0f },    // 1152 x 1152
+        { 16, 96, 32.0f, 6.0f },    // 1536 x 1536
+    };
+    return levels[level < 0 ? 0 : (level > 2 ? 2 : level)];
+}
+
+// per-instance record read by impostor.vs (std430, 96 bytes)
+struct ImpostorInstance {
+    glm::mat4 model;            // prefab space to scene space
+    glm::vec4 bounds;           // scene-space bounding sphere
+    unsigned int prefab;
+    unsigned int padding[3];
+};
+
+// Octahedral impostors of static prefabs. Each prefab is recorded once into
+// its own StaticScene and baked at startup from one view direction per
+// cell of an octahedral grid over the sphere of directions. A bake stores
+// albedo and coverage in one layer of an RGBA8 array and the octahedral
+// normal, depth along the view and specular in another, so the impostor
+// is lit like the geometry and writes a depth close to it.
+//
+// At runtime every instance is one camera-facing quad; impostor.vs picks
+// the frame whose direction is closest to the view and impostor.fs
+// reconstructs the surface from it. Over the fade band instances dither
+// in while their geometry, put in a StaticScene cluster, dithers out with
+// the complementary threshold; past the band the cull pass drops the
+// geometry.
+class ImpostorAtlas {
+public:
+    static const int MAX_PREFABS = 8;  // prefabBounds[] in impostor.vs
+
+    explicit ImpostorAtlas(const ImpostorQuality& quality) : quality(quality) {}
+
+    ~ImpostorAtlas()
+    {
+        glDeleteTextures(1, &albedoTexture);
+        glDeleteTextures(1, &surfaceTexture);
+        glDeleteBuffers(1, &instanceSSBO);
+    }
+
+    // owns its GL textures and buffer
+    ImpostorAtlas(const ImpostorAtlas&) = delete;
+    ImpostorAtlas& operator=(const ImpostorAtlas&) = delete;
+
+    const ImpostorQuality& getQuality() const { return quality; }
+
+    // the band StaticScene::setClusterFade hands the geometry over in
+    float getFadeStart() const { return quality.distance; }
+    float getFadeWidth() const { return quality.fadeWidth; }
+
+    // records a prefab in its own space: draw issues the primitive draw
+    // calls with an identity placement. Returns the prefab index.
+    unsigned int addPrefab(const string& name, const function<void()>& draw, bool proceduralPrimitives, float shininess = 32.0f)
+    {
+        if ((int)prefabs.size() == MAX_PREFABS) {
+            cout << "ERROR::IMPOSTOR::TOO_MANY_PREFABS: " << name << endl;
+            return 0;
+        }
+
+        Prefab prefab;
+        prefab.name = name;
+        prefab.shininess = shininess;
+        prefab.scene.reset(new StaticScene());
+        prefab.scene->setProceduralPrimitives(proceduralPrimitives);
+
+        StaticScene* outer = StaticScene::recording();
+        prefab.scene->beginRecording();
+        draw();
+        prefab.scene->endRecording();
+        StaticScene::recording() = outer;
+
+        prefab.bounds = prefab.scene->getBounds();
+        prefabs.push_back(move(prefab));
+        return (unsigned int)prefabs.size() - 1;
+    }
+
+    // renders every frame of every prefab, leaving the camera uniforms
+    // to be rewritten by the next frame; meshShader is built on
+    // vertexShaderForStaticScene.vs and proceduralShader on
+    // vertexShaderForProceduralScene.vs, both with impostorBake.fs
+    void bake(Shader& meshShader, Shader& proceduralShader, Shader& cullShader)
+    {
+        if (prefabs.empty())
+            return;
+
+        int size = quality.framesPerSide * quality.frameSize;
+        int levels = 1;
+        while ((quality.frameSize >> levels) >= 4)
+            levels++;       // stop while a frame is still 4 texels wide
+
+        createArray(albedoTexture, size, levels);
+        createArray(surfaceTexture, size, levels);
+
+        unsigned int depth, framebuffer;
+        glGenRenderbuffers(1, &depth);
+        glBindRenderbuffer(GL_RENDERBUFFER, depth);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, size, size);
+        glGenFramebuffers(1, &framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth);
+        const GLenum attachments[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+        glDrawBuffers(2, attachments);
+
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        const glm::mat4 identity(1.0f);
+
+        for (size_t p = 0; p < prefabs.size(); p++) {
+            const Prefab& prefab = prefabs[p];
+            glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, albedoTexture, 0, (int)p);
+            glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, surfaceTexture, 0, (int)p);
+            if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+                cout << "ERROR::IMPOSTOR::FRAMEBUFFER_INCOMPLETE: " << prefab.name << endl;
+                break;
+            }
+
+            // coverage, and so every channel, starts at zero
+            const float zero[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+            const float clearDepth = 1.0f;
+            glViewport(0, 0, size, size);
+            glClearBufferfv(GL_COLOR, 0, zero);
+            glClearBufferfv(GL_COLOR, 1, zero);
+            glClearBufferfv(GL_DEPTH, 0, &clearDepth);
+
+            glm::vec3 center(prefab.bounds);
+            float radius = prefab.bounds.w;
+            glm::mat4 projection = glm::ortho(-radius, radius, -radius, radius, 0.5f * radius, 3.5f * radius);
+
+            for (int y = 0; y < quality.framesPerSide; y++) {
+                for (int x = 0; x < quality.framesPerSide; x++) {
+                    glm::vec3 direction = frameDirection(x, y);
+                    glm::mat4 view = glm::lookAt(center + direction * (2.0f * radius), center, frameUp(direction));
+
+                    // the ortho box holds the bounding sphere of every part,
+                    // so the cull keeps them all
+                    if (x == 0 && y == 0)
+                        prefab.scene->cull(cullShader, projection * view, identity, center + direction * (2.0f * radius));
+
+                    glViewport(x * quality.frameSize, y * quality.frameSize, quality.frameSize, quality.frameSize);
+                    CameraUniforms::shared().update(view, projection, center + direction * (2.0f * radius), 0.0f,
+                        glm::vec2((float)quality.frameSize));
+                    setBakeUniforms(meshShader, center, radius, direction);
+                    setBakeUniforms(proceduralShader, center, radius, direction);
+                    prefab.scene->draw(meshShader, meshShader, identity);
+                    prefab.scene->drawProcedural(proceduralShader, proceduralShader, identity);
+                }
+            }
+        }
+
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glDeleteFramebuffers(1, &framebuffer);
+        glDeleteRenderbuffers(1, &depth);
+        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+        glBindTexture(GL_TEXTURE_2D_ARRAY, albedoTexture);
+        glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, surfaceTexture);
+        glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+        cout << "Impostors: " << prefabs.size() << " prefabs, " << quality.framesPerSide * quality.framesPerSide
+             << " frames of " << quality.frameSize << "px, " << size << "x" << size << " atlas" << endl;
+    }
+
+    void clearInstances()
+    {
+        instances.clear();
+        instancesDirty = true;
+    }
+
+    // places a prefab; returns its scene-space bounds for
+    // StaticScene::beginCluster
+    glm::vec4 addInstance(unsigned int prefab, const glm::mat4& model)
+    {
+        const glm::vec4& bounds = prefabs[prefab].bounds;
+        float scale = max(glm::length(glm::vec3(model[0])), max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+
+        ImpostorInstance instance;
+        instance.model = model;
+        instance.bounds = glm::vec4(glm::vec3(model * glm::vec4(glm::vec3(bounds), 1.0f)), bounds.w * scale);
+        instance.prefab = prefab;
+        instance.padding[0] = instance.padding[1] = instance.padding[2] = 0;
+        instances.push_back(instance);
+        instancesDirty = true;
+
+        return instance.bounds;
+    }
+
+    // every instance as a quad; instances nearer than the fade band
+    // collapse in impostor.vs. Lighting must be set.
+    void draw(Shader& impostorShader, const glm::mat4& world, const glm::vec3& cameraPosition)
+    {
+        if (instances.empty() || albedoTexture == 0)
+            return;
+
+        if (instancesDirty) {
+            if (instanceSSBO == 0)
+                glGenBuffers(1, &instanceSSBO);
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, instanceSSBO);
+            glBufferData(GL_SHADER_STORAGE_BUFFER, instances.size() * sizeof(ImpostorInstance), instances.data(), GL_STATIC_DRAW);
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+            instancesDirty = false;
+        }
+
+        glm::vec4 bounds[MAX_PREFABS];
+        float shininess[MAX_PREFABS];
+        for (size_t p = 0; p < prefabs.size(); p++) {
+            bounds[p] = prefabs[p].bounds;
+            shininess[p] = prefabs[p].shininess;
+        }
+
+        impostorShader.use();
+        impostorShader.setMat4("world", world);
+        impostorShader.setVec3("sceneCamera", glm::vec3(glm::inverse(world) * glm::vec4(cameraPosition, 1.0f)));
+        impostorShader.setInt("framesPerSide", quality.framesPerSide);
+        impostorShader.setFloat("fadeStart", quality.distance);
+        impostorShader.setFloat("fadeWidth", quality.fadeWidth);
+        glUniform4fv(glGetUniformLocation(impostorShader.ID, "prefabBounds"), (int)prefabs.size(), &bounds[0][0]);
+        glUniform1fv(glGetUniformLocation(impostorShader.ID, "prefabShininess"), (int)prefabs.size(), shininess);
+        impostorShader.setInt("albedoAtlas", 0);
+        impostorShader.setInt("surfaceAtlas", 1);
+
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, albedoTexture);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, surfaceTexture);
+
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, instanceSSBO);
+        glBindVertexArray(proceduralVAO());
+        GeometryArena::shared().forgetBinding();
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (int)instances.size());
+
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    unsigned int getInstanceCount() const { return (unsigned int)instances.size(); }
+
+private:
+    struct Prefab {
+        string name;
+        unique_ptr<StaticScene> scene;
+        glm::vec4 bounds;       // prefab-space bounding sphere
+        float shininess;
+    };
+
+    ImpostorQuality quality;
+    vector<Prefab> prefabs;
+    vector<ImpostorInstance> instances;
+    bool instancesDirty = false;
+
+    unsigned int albedoTexture = 0;     // rgb albedo, a coverage
+    unsigned int surfaceTexture = 0;    // rg octahedral normal, b depth, a specular
+    unsigned int instanceSSBO = 0;
+
+    // unit direction from the octahedral square [-1, 1]^2, y up; must match
+    // octahedronDirection in impostor.vs
+    static glm::vec3 octahedronDirection(glm::vec2 e)
+    {
+        glm::vec3 n(e.x, 1.0f - fabs(e.x) - fabs(e.y), e.y);
+        if (n.y < 0.0f) {
+            float x = (1.0f - fabs(n.z)) * (n.x >= 0.0f ? 1.0f : -1.0f);
+            float z = (1.0f - fabs(n.x)) * (n.z >= 0.0f ? 1.0f : -1.0f);
+            n.x = x;
+            n.z = z;
+        }
+        return glm::normalize(n);
+    }
+
+    // the view direction of a frame points from the prefab to the eye
+    glm::vec3 frameDirection(int x, int y) const
+    {
+        glm::vec2 cell((x + 0.5f) / quality.framesPerSide, (y + 0.5f) / quality.framesPerSide);
+        return octahedronDirection(cell * 2.0f - 1.0f);
+    }
+
+    static glm::vec3 frameUp(const glm::vec3& direction)
+    {
+        return fabs(direction.y) > 0.999f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+    }
+
+    static void setBakeUniforms(Shader& shader, const glm::vec3& center, float radius, const glm::vec3& direction)
+    {
+        shader.use();
+        shader.setVec3("center", center);
+        shader.setFloat("radius", radius);
+        shader.setVec3("frameDirection", direction);
+    }
+
+    void createArray(unsigned int& texture, int size, int levels)
+    {
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+        glTexStorage3D(GL_TEXTURE_2D_ARRAY, levels, GL_RGBA8, size, size, (int)prefabs.size());
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    }
+};
+
+#endif /* impostor_h */
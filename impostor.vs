@@ -0,0 +1,106 @@
+#version 430 core
+// One camera-facing quad per impostor instance, drawn as a 4-vertex strip.
+// The quad covers the instance's bounding sphere as seen from the camera;
+// the atlas frame whose view direction is nearest the camera's, in prefab
+// space, is handed to impostor.fs. Instances nearer than the fade band
+// collapse to a point.
+
+struct ImpostorInstance {
+    mat4 model;         // prefab space to scene space
+    vec4 bounds;        // scene-space bounding sphere
+    uint prefab;
+};
+
+layout (std430, binding = 0) readonly buffer ImpostorInstanceBuffer {
+    ImpostorInstance impostors[];
+};
+
+#define MAX_PREFABS 8
+
+out vec3 LocalPos;              // prefab space
+flat out uint Instance;
+flat out vec3 FrameRight;       // prefab-space basis of the frame
+flat out vec3 FrameUp;
+flat out vec3 FrameDirection;
+flat out vec2 FrameOrigin;      // atlas coordinates of the frame's corner
+flat out vec4 PrefabBounds;     // prefab-space bounding sphere
+flat out float Fade;
+flat out mat3 NormalMatrix;     // prefab space to world space, for normals
+
+uniform mat4 world;
+layout (std140) uniform Camera {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec3 viewPos;
+    float time;
+    vec2 viewportSize;
+};
+
+uniform vec3 sceneCamera;       // camera position in scene space
+uniform vec4 prefabBounds[MAX_PREFABS];
+uniform int framesPerSide;
+uniform float fadeStart;
+uniform float fadeWidth;
+
+// must match ImpostorAtlas::octahedronDirection
+vec3 octahedronDirection(vec2 e)
+{
+    vec3 n = vec3(e.x, 1.0 - abs(e.x) - abs(e.y), e.y);
+    if (n.y < 0.0)
+        n.xz = (1.0 - abs(n.zx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.z >= 0.0 ? 1.0 : -1.0);
+    return normalize(n);
+}
+
+vec2 octahedronEncode(vec3 n)
+{
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    vec2 e = n.xz;
+    if (n.y < 0.0)
+        e = (1.0 - abs(e.yx)) * vec2(e.x >= 0.0 ? 1.0 : -1.0, e.y >= 0.0 ? 1.0 : -1.0);
+    return e;
+}
+
+// the basis glm::lookAt builds for a frame in ImpostorAtlas::bake
+void frameBasis(vec3 direction, out vec3 right, out vec3 up)
+{
+    vec3 worldUp = abs(direction.y) > 0.999 ? vec3(0.0, 0.0, 1.0) : vec3(0.0, 1.0, 0.0);
+    right = normalize(cross(worldUp, direction));
+    up = cross(direction, right);
+}
+
+void main()
+{
+    ImpostorInstance impostor = impostors[gl_InstanceID];
+    vec3 center = impostor.bounds.xyz;
+    float radius = impostor.bounds.w;
+
+    vec3 toCamera = sceneCamera - center;
+    float distanceToCamera = length(toCamera);
+    Fade = clamp((distanceToCamera - fadeStart) / fadeWidth, 0.0, 1.0);
+    if (Fade <= 0.0) {
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+        return;
+    }
+
+    // nearest frame to the view direction in prefab space
+    mat4 toPrefab = inverse(impostor.model);
+    vec3 localView = normalize(mat3(toPrefab) * toCamera);
+    vec2 cell = clamp(floor((octahedronEncode(localView) * 0.5 + 0.5) * float(framesPerSide)), 0.0, float(framesPerSide - 1));
+    FrameDirection = octahedronDirection((cell + 0.5) / float(framesPerSide) * 2.0 - 1.0);
+    frameBasis(FrameDirection, FrameRight, FrameUp);
+    FrameOrigin = cell / float(framesPerSide);
+    Instance = uint(gl_InstanceID);
+    PrefabBounds = prefabBounds[impostor.prefab];
+    NormalMatrix = mat3(transpose(inverse(world * impostor.model)));
+
+    // a sphere seen from close by is wider than its radius
+    vec3 right, up;
+    frameBasis(toCamera / distanceToCamera, right, up);
+    float extent = radius * distanceToCamera / sqrt(max(distanceToCamera * distanceToCamera - radius * radius, 1e-4));
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 2.0 - 1.0;
+    vec3 position = center + (right * corner.x + up * corner.y) * extent;
+
+    LocalPos = vec3(toPrefab * vec4(position, 1.0));
+    gl_Position = viewProjection * world * vec4(position, 1.0);
+}
@@ -0,0 +1,39 @@
+#version 430 core
+// One frame of an impostor atlas: albedo and coverage, then the normal
+// folded onto the octahedron, the depth toward the eye in bounding radii
+// and the specular strength, all mapped to [0, 1] for RGBA8.
+in vec3 FragPos;
+in vec3 Normal;
+in vec2 TexCoords;
+flat in uint DiffuseLayer;
+
+layout (location = 0) out vec4 Albedo;
+layout (location = 1) out vec4 Surface;
+
+struct Material {
+    sampler2DArray diffuse;     // specular intensity in alpha
+};
+
+uniform Material material;
+uniform vec3 center;            // prefab bounding sphere
+uniform float radius;
+uniform vec3 frameDirection;    // from the prefab toward the eye
+
+vec2 octahedronEncode(vec3 n)
+{
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    vec2 e = n.xz;
+    if (n.y < 0.0)
+        e = (1.0 - abs(e.yx)) * vec2(e.x >= 0.0 ? 1.0 : -1.0, e.y >= 0.0 ? 1.0 : -1.0);
+    return e;
+}
+
+void main()
+{
+    vec3 N = normalize(Normal);
+    float depth = dot(FragPos - center, frameDirection) / radius;
+
+    vec4 texel = texture(material.diffuse, vec3(TexCoords, DiffuseLayer));
+    Albedo = vec4(texel.rgb, 1.0);
+    Surface = vec4(octahedronEncode(N) * 0.5 + 0.5, clamp(depth * 0.5 + 0.5, 0.0, 1.0), texel.a);
+}
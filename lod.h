@@ -0,0 +1,104 @@
+#ifndef lod_h
+#define lod_h
+
+#include <vector>
+#include <algorithm>
+#include <glm/glm.hpp>
+#include "geometry_arena.h"
+
+using namespace std;
+
+// camera data LOD selection needs, refreshed once per frame
+struct LODContext {
+    glm::mat4 view = glm::mat4(1.0f);
+    float pixelsPerUnit = 1.0f;     // screen pixels covered by one unit at distance 1
+    unsigned int frame = 0;
+
+    static LODContext& current()
+    {
+        static LODContext context;
+        return context;
+    }
+
+    void update(const glm::mat4& view, const glm::mat4& projection, float viewportHeight)
+    {
+        this->view = view;
+        this->pixelsPerUnit = projection[1][1] * viewportHeight * 0.5f;
+        frame++;
+    }
+};
+
+// A chain of arena meshes from finest (level 0) to coarsest. Each draw picks
+// the level from its projected bounding-sphere radius in pixels; a level is
+// only left once the radius is past its threshold by the hysteresis
+// fraction, so objects hovering at a boundary do not pop. The n-th draw of
+// a chain in a frame remembers the level of the n-th draw of the last one.
+class LODChain {
+public:
+    LODChain() {}
+
+    void addLevel(unsigned int mesh) { levels.push_back(mesh); }
+
+    // thresholds[k] is the radius in pixels below which level k + 1 is used
+    void setThresholds(const vector<float>& pixels, float hysteresis = 0.15f)
+    {
+        this->thresholds = pixels;
+        this->hysteresis = hysteresis;
+    }
+
+    unsigned int select(const glm::mat4& model)
+    {
+        const LODContext& context = LODContext::current();
+        if (frame != context.frame) {
+            frame = context.frame;
+            drawCursor = 0;
+        }
+        if (drawCursor >= drawLevels.size())
+            drawLevels.push_back(-1);
+        int& level = drawLevels[drawCursor++];
+
+        int coarsest = min((int)levels.size(), (int)thresholds.size() + 1) - 1;
+        float radius = projectedRadius(model);
+
+        if (level < 0 || level > coarsest) {
+            level = 0;
+            while (level < coarsest && radius < thresholds[level])
+                level++;
+        }
+        else {
+            while (level < coarsest && radius < thresholds[level] * (1.0f - hysteresis))
+                level++;
+            while (level > 0 && radius > thresholds[level - 1] * (1.0f + hysteresis))
+                level--;
+        }
+
+        return levels[level];
+    }
+
+    unsigned int getLevel(int level) const { return levels[level]; }
+    int getLevelCount() const { return (int)levels.size(); }
+
+private:
+    vector<unsigned int> levels;
+    vector<float> thresholds;
+    float hysteresis = 0.15f;
+
+    vector<int> drawLevels;
+    size_t drawCursor = 0;
+    unsigned int frame = 0;
+
+    // bounding sphere of the finest level, which all levels share
+    float projectedRadius(const glm::mat4& model) const
+    {
+        const ArenaMesh& mesh = GeometryArena::shared().getMesh(levels[0]);
+        const LODContext& context = LODContext::current();
+
+        glm::vec3 center = glm::vec3(context.view * model * glm::vec4(mesh.center, 1.0f));
+        float scale = max(glm::length(glm::vec3(model[0])), max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+        float distance = max(glm::length(center), 1e-3f);
+
+        return mesh.radius * scale * context.pixelsPerUnit / distance;
+    }
+};
+
+#endif /* lod_h */
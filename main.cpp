@@ -19,6 +19,21 @@
 #include "cube.h"
 #include "polygon.h"
 #include "hollow_polygon.h"
+#include "geometry_arena.h"
+#include "lod.h"
+#include "bezier_profile.h"
+#include "bezier_revolution.h"
+#include "mesh_builder.h"
+#include "mesh_batch.h"
+#include "mesh_handle.h"
+#include "static_scene.h"
+#include "impostor.h"
+#include "camera_uniforms.h"
+#include "material_table.h"
+#include "texture_array.h"
+#include "texture_cooker.h"
+#include "texture_residency.h"
+#include "mip_feedback.h"
 #include "basic_camera.h"
 #include "pointLight.h"
 #include "stb_image.h"
@@ -31,8 +46,10 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 void processInput(GLFWwindow* window);
-void drawCube(unsigned int& cubeVAO, Shader& lightingShader, glm::mat4 model, float r, float g, float b);
-unsigned int loadTexture(char const* path, GLenum textureWrappingModeS, GLenum textureWrappingModeT, GLenum textureFilteringModeMin, GLenum textureFilteringModeMax);
+void runScene(GLFWwindow* window);
+void drawCube(unsigned int cubeMesh, Shader& lightingShader, glm::mat4 model, float r, float g, float b);
+void drawBalloon(Shader& lightingShader, Shader& bezierShader, LODChain& lod, BezierRevolution& surface, glm::mat4 model, glm::vec3 color);
+unsigned int loadMaterialTexture(char const* diffusePath, char const* specularPath, GLenum textureWrappingModeS, GLenum textureWrappingModeT, GLenum textureFilteringModeMin, GLenum textureFilteringModeMax, unsigned int group = 0);
 
 glm::mat4 RotationMatricesX(float theta);
 glm::mat4 RotationMatricesY(float theta);
@@ -43,8 +60,22 @@ const unsigned int SCR_WIDTH = 1800;
 const unsigned int SCR_HEIGHT = 900;
 
 const double pi = 3.14159265389;
-const int nt = 40;
-const int ntheta = 20;
+const float bezierTolerance = 0.002f;  // chordal error of bezier surfaces at the finest level
+const float bezierMaxAngle = 0.35f;    // normal turn allowed per ring and segment, radians
+const bool tessellateBezierOnGPU = true;  // bezier surfaces from their control points, no CPU mesh
+const float bezierEdgePixels = 8.0f;   // screen length of one GPU-tessellated edge
+const bool pullProceduralVertices = true;  // static cubes and prisms rebuilt from gl_VertexID, no vertex buffers
+const bool raycastSpheres = true;          // spheres as ray-cast quads: exact silhouette, 2 triangles each
+const int furnitureImpostorQuality = 1;    // 0 low, 1 medium, 2 high: atlas resolution and swap distance
+const bool useCookedTextures = true;       // block-compressed .ctex textures with prebuilt mips, cooked on first load
+const bool streamTextures = true;          // fine mip levels uploaded as they come into view, within textureBudgetMB
+const int textureBudgetMB = 48;
+const bool recordMipFeedback = false;      // benchmark mode: mip levels each texture shows, sizes written to mip_feedback.txt on exit
+const bool applyMipFeedback = true;        // textures capped at the sizes in mip_feedback.txt, when there is one
+
+// residency groups: textures only one room shows share texture arrays
+// that can drop their fine levels while the room is out of sight
+enum TextureGroup { TEXTURES_SHARED = 0, TEXTURES_KITCHEN, TEXTURES_THEATER };
 bool showControlPoints = true;
 bool loadBezierCurvePoints = false;
 bool showHollowBezier = false;
@@ -56,11 +87,6 @@ unsigned int bezierLightsVAO;
 float ang = 20.0f;
 float ballonSpeed = 0.0f;
 
-vector <float> coordinates;
-vector <float> normals;
-vector <int> indices;
-vector <float> vertices;
-
 // modelling transform
 float rotateAngle_X = 0.0;
 float rotateAngle_Y = -90.0;
@@ -227,7 +253,6 @@ float lastFrame = 0.0f;
 
 void setUpLighting(Shader& lightingShader) {
     lightingShader.use();
-    lightingShader.setVec3("viewPos", camera.Position);
 
     // Assuming pointLights is a vector of PointLight objects
     for (size_t i = 0; i < pointLights.size(); ++i) {
@@ -287,6 +312,17 @@ void setUpLighting(Shader& lightingShader) {
 }
     
 
+// translation, then rotation about x, y and z in degrees; the furniture
+// impostors are placed with the same matrix
+glm::mat4 furnitureTransform(const glm::mat4& identityMatrix, const glm::vec3& translation, const glm::vec3& rotation)
+{
+    glm::mat4 transform = glm::translate(identityMatrix, translation);
+    transform = glm::rotate(transform, glm::radians(rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
+    transform = glm::rotate(transform, glm::radians(rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
+    transform = glm::rotate(transform, glm::radians(rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
+    return transform;
+}
+
 void drawChairWithTransformations(const glm::mat4& identityMatrix,
     const glm::mat4& globalTranslationMatrix,
     const glm::vec3& translation,
@@ -297,13 +333,8 @@ void drawChairWithTransformations(const glm::mat4& identityMatrix,
     Cube& cube_floor,
     const glm::vec3& viewPos) {
 
-    // Start with the identity matrix for the whole chair
-    glm::mat4 chairTransformMatrix = glm::translate(identityMatrix, translation);
-
-    // Apply rotation (on all axes)
-    chairTransformMatrix = glm::rotate(chairTransformMatrix, glm::radians(rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
-    chairTransformMatrix = glm::rotate(chairTransformMatrix, glm::radians(rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
-    chairTransformMatrix = glm::rotate(chairTransformMatrix, glm::radians(rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
+    // Placement of the whole chair
+    glm::mat4 chairTransformMatrix = furnitureTransform(identityMatrix, translation, rotation);
 
     // Keep the original structure for the chair as it was
     glm::mat4 translateMatrix, rotateMatrix, scaleMatrix, model;
@@ -379,13 +410,8 @@ void drawTableWithTransformations(const glm::mat4& identityMatrix,
     Shader& ourShader,
     Cube& cube_floor) {
 
-    // Start with the identity matrix for the whole table
-    glm::mat4 tableTransformMatrix = glm::translate(identityMatrix, translation);
-
-    // Apply rotation (on all axes)
-    tableTransformMatrix = glm::rotate(tableTransformMatrix, glm::radians(rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
-    tableTransformMatrix = glm::rotate(tableTransformMatrix, glm::radians(rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
-    tableTransformMatrix = glm::rotate(tableTransformMatrix, glm::radians(rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
+    // Placement of the whole table
+    glm::mat4 tableTransformMatrix = furnitureTransform(identityMatrix, translation, rotation);
 
     // Keep the original structure for the table as it was
     glm::mat4 translateMatrix, scaleMatrix, model;
@@ -422,13 +448,8 @@ void drawSofaWithTransformations(const glm::mat4& identityMatrix,
     Cube& cube_floor,
     Cube& cube_box) {
 
-    // Start with the identity matrix for the whole sofa
-    glm::mat4 sofaTransformMatrix = glm::translate(identityMatrix, translation);
-
-    // Apply rotation (on all axes)
-    sofaTransformMatrix = glm::rotate(sofaTransformMatrix, glm::radians(rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
-    sofaTransformMatrix = glm::rotate(sofaTransformMatrix, glm::radians(rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
-    sofaTransformMatrix = glm::rotate(sofaTransformMatrix, glm::radians(rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
+    // Placement of the whole sofa
+    glm::mat4 sofaTransformMatrix = furnitureTransform(identityMatrix, translation, rotation);
 
     glm::mat4 translateMatrix, scaleMatrix, model;
 
@@ -619,164 +640,77 @@ void drawLift(glm::mat4 globalTranslationMatrix, Shader& lightingShaderWithTextu
     cube_wall.drawLightCube(ourShader, model, glm::vec3(0.0f, 0.0f, 0.0f));
 }
 
-long long nCr(int n, int r)
+// rings and segments are placed adaptively so the surface stays within
+// tolerance of the true curve and circle; may run on a mesh batch worker
+void hollowBezier(MeshBuilder& builder, const GLfloat* ctrlpoints, int L, float tolerance, float maxAngle)
 {
-    if (r > n / 2)
-        r = n - r; // because C(n, r) == C(n, n - r)
-    long long ans = 1;
-    int i;
-
-    for (i = 1; i <= r; i++)
+    // all rings of the profile, with derivatives
+    vector<ProfileSample> profile;
+    BezierProfile(ctrlpoints, L).sampleAdaptive(tolerance, maxAngle, profile);
+    const int rings = (int)profile.size() - 1;
+    const int segments = revolutionSegments(profile, tolerance, maxAngle);
+
+    // one turn of sines and cosines, shared by every ring
+    vector<float> sines(segments + 1), cosines(segments + 1);
+    const float dtheta = 2 * pi / segments;        //angular step size
+    for (int j = 0; j <= segments; ++j)
     {
-        ans *= n - r + i;
-        ans /= i;
+        sines[j] = sinf(j * dtheta);
+        cosines[j] = cosf(j * dtheta);
     }
 
-    return ans;
-}
-
-void BezierCurve(double t, float xy[2], GLfloat ctrlpoints[], int L)
-{
-    double y = 0;
-    double x = 0;
-    t = t > 1.0 ? 1.0 : t;
-    for (int i = 0; i < L + 1; i++)
+    builder.reserve(MeshBuilder::gridVertexCount(rings, segments), MeshBuilder::gridIndexCount(rings, segments));
+    for (int i = 0; i <= rings; ++i)              //step through y
     {
-        long long ncr = nCr(L, i);
-        double oneMinusTpow = pow(1 - t, double(L - i));
-        double tPow = pow(t, double(i));
-        double coef = oneMinusTpow * tPow * ncr;
-        x += coef * ctrlpoints[i * 3];
-        y += coef * ctrlpoints[(i * 3) + 1];
-
-    }
-    xy[0] = float(x);
-    xy[1] = float(y);
-}
+        const ProfileSample& sample = profile[i];
 
-unsigned int hollowBezier(GLfloat ctrlpoints[], int L)
-{
-    int i, j;
-    float x, y, z, r;                //current coordinates
-    float theta;
-    float nx, ny, nz, lengthInv;    // vertex normal
-
-
-    const float dtheta = 2 * pi / ntheta;        //angular step size
-
-    float t = 0;
-    float dt = 1.0 / nt;
-    float xy[2];
+        // the profile normal (dy, -dr) revolved with the ring gives the
+        // surface normal; a profile that stalls falls back to the radial one
+        float lengthInv = 1.0f / sqrtf(sample.dy * sample.dy + sample.dr * sample.dr);
+        if (!isfinite(lengthInv))
+            lengthInv = 0.0f;
 
-    for (i = 0; i <= nt; ++i)              //step through y
-    {
-        BezierCurve(t, xy, ctrlpoints, L);
-        r = xy[0];
-        y = xy[1];
-        theta = 0;
-        t += dt;
-        lengthInv = 1.0 / r;
-
-        for (j = 0; j <= ntheta; ++j)
+        for (int j = 0; j <= segments; ++j)
         {
-            double cosa = cos(theta);
-            double sina = sin(theta);
-            z = r * cosa;
-            x = r * sina;
-
-            coordinates.push_back(x);
-            coordinates.push_back(y);
-            coordinates.push_back(z);
-
-            // normalized vertex normal (nx, ny, nz)
-            // center point of the circle (0,y,0)
-            nx = (x - 0) * lengthInv;
-            ny = (y - y) * lengthInv;
-            nz = (z - 0) * lengthInv;
-
-            normals.push_back(nx);
-            normals.push_back(ny);
-            normals.push_back(nz);
-
-            theta += dtheta;
-        }
-    }
+            glm::vec3 position(sample.r * sines[j], sample.y, sample.r * cosines[j]);
+            glm::vec3 normal(sines[j], 0.0f, cosines[j]);
+            if (lengthInv > 0.0f)
+                normal = glm::vec3(sample.dy * sines[j], -sample.dr, sample.dy * cosines[j]) * lengthInv;
 
-    // generate index list of triangles
-    // k1--k1+1
-    // |  / |
-    // | /  |
-    // k2--k2+1
-
-    int k1, k2;
-    for (int i = 0; i < nt; ++i)
-    {
-        k1 = i * (ntheta + 1);     // beginning of current stack
-        k2 = k1 + ntheta + 1;      // beginning of next stack
-
-        for (int j = 0; j < ntheta; ++j, ++k1, ++k2)
-        {
-            // k1 => k2 => k1+1
-            indices.push_back(k1);
-            indices.push_back(k2);
-            indices.push_back(k1 + 1);
-
-            // k1+1 => k2 => k2+1
-            indices.push_back(k1 + 1);
-            indices.push_back(k2);
-            indices.push_back(k2 + 1);
+            // texture coordinates follow the (t, theta) parameterisation
+            builder.addVertex(position, normal, glm::vec2((float)j / segments, sample.t));
         }
     }
+    builder.addGrid(rings, segments);
+}
 
-    size_t count = coordinates.size();
-    for (int i = 0; i < count; i += 3)
-    {
-        vertices.push_back(coordinates[i]);
-        vertices.push_back(coordinates[i + 1]);
-        vertices.push_back(coordinates[i + 2]);
-
-        vertices.push_back(normals[i]);
-        vertices.push_back(normals[i + 1]);
-        vertices.push_back(normals[i + 2]);
-    }
-
-    unsigned int bezierVAO;
-    glGenVertexArrays(1, &bezierVAO);
-    glBindVertexArray(bezierVAO);
-
-    // create VBO to copy vertex data to VBO
-    unsigned int bezierVBO;
-    glGenBuffers(1, &bezierVBO);
-    glBindBuffer(GL_ARRAY_BUFFER, bezierVBO);           // for vertex data
-    glBufferData(GL_ARRAY_BUFFER,                   // target
-        (unsigned int)vertices.size() * sizeof(float), // data size, # of bytes
-        vertices.data(),   // ptr to vertex data
-        GL_STATIC_DRAW);                   // usage
-
-    // create EBO to copy index data
-    unsigned int bezierEBO;
-    glGenBuffers(1, &bezierEBO);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, bezierEBO);   // for index data
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER,           // target
-        (unsigned int)indices.size() * sizeof(unsigned int),             // data size, # of bytes
-        indices.data(),               // ptr to index data
-        GL_STATIC_DRAW);                   // usage
-
-    // activate attrib arrays
-    glEnableVertexAttribArray(0);
-    glEnableVertexAttribArray(1);
-
-    // set attrib arrays with stride and offset
-    int stride = 24;     // should be 24 bytes
-    glVertexAttribPointer(0, 3, GL_FLOAT, false, stride, (void*)0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, false, stride, (void*)(sizeof(float) * 3));
-
-    // unbind VAO, VBO and EBO
-    glBindVertexArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-
-    return bezierVAO;
+// triangles of the adaptive surface against the fewest uniform rings that
+// meet the same tolerance
+void reportBezierTessellation(const char* name, GLfloat ctrlpoints[], int L, float tolerance, float maxAngle)
+{
+    BezierProfile bezier(ctrlpoints, L);
+    vector<ProfileSample> profile;
+    bezier.sampleAdaptive(tolerance, maxAngle, profile);
+    int segments = revolutionSegments(profile, tolerance, maxAngle);
+    int rings = (int)profile.size() - 1;
+
+    int uniformRings = 1;
+    vector<double> ts;
+    vector<ProfileSample> uniform;
+    for (; uniformRings < 1024; uniformRings++) {
+        ts.resize(uniformRings + 1);
+        for (int i = 0; i <= uniformRings; i++)
+            ts[i] = (double)i / uniformRings;
+        bezier.sample(ts, uniform);
+        if (bezier.withinTolerance(uniform, tolerance, maxAngle))
+            break;
+    }
+
+    int triangles = 2 * rings * segments, uniformTriangles = 2 * uniformRings * segments;
+    cout << name << " tessellation (tolerance " << tolerance << ", " << maxAngle << " rad): "
+        << rings << " rings x " << segments << " segments = " << triangles << " triangles, uniform "
+        << uniformRings << " rings = " << uniformTriangles << " triangles ("
+        << (100 - 100 * triangles / max(uniformTriangles, 1)) << "% fewer)" << endl;
 }
 
 void drawFan(
@@ -822,8 +756,12 @@ void drawFan(
     }
 }
 
-int main()
+int main(int argc, char** argv)
 {
+    // cooking only: Lighting --cook image...
+    if (argc > 2 && string(argv[1]) == "--cook")
+        return TextureCooker::shared().cookFiles(argc - 2, argv + 2) ? 0 : 1;
+
     for (int i = 0; i < noOfLights; ++i) {
         pointLights.emplace_back(
             pointLightPositions[i].x, pointLightPositions[i].y, pointLightPositions[i].z, // position
@@ -840,7 +778,7 @@ int main()
     // glfw: initialize and configure
     // ------------------------------
     glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
@@ -873,6 +811,19 @@ int main()
         return -1;
     }
 
+    // every GL object the scene owns is deleted before runScene returns,
+    // while the context is still current
+    runScene(window);
+
+    // glfw: terminate, clearing all previously allocated GLFW resources.
+    // ------------------------------------------------------------------
+    glfwTerminate();
+    return 0;
+}
+
+// builds the cafeteria and runs the render loop until the window closes
+void runScene(GLFWwindow* window)
+{
     // configure global opengl state
     // -----------------------------
     glEnable(GL_DEPTH_TEST);
@@ -882,41 +833,42 @@ int main()
     Shader lightingShader("vertexShaderForPhongShading.vs", "fragmentShaderForPhongShading.fs");
     //Shader lightingShader("vertexShaderForGouraudShading.vs", "fragmentShaderForGouraudShading.fs");
     Shader ourShader("vertexShader.vs", "fragmentShader.fs");
+    Shader bezierShader("bezierRevolution.vs", "bezierRevolution.tcs", "bezierRevolution.tes", "fragmentShaderForPhongShading.fs");
 
     // set up vertex data (and buffer(s)) and configure vertex attributes
     // ------------------------------------------------------------------
 
     float cube_vertices[] = {
-        0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f,
-        0.5f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f,
-        0.5f, 0.5f, 0.0f, 1.0f, 0.0f, 0.0f,
-        0.0f, 0.5f, 0.0f, 1.0f, 0.0f, 0.0f,
-
-        0.5f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f,
-        0.5f, 0.5f, 0.0f, 0.0f, 1.0f, 0.0f,
-        0.5f, 0.0f, 0.5f, 0.0f, 1.0f, 0.0f,
-        0.5f, 0.5f, 0.5f, 0.0f, 1.0f, 0.0f,
-
-        0.0f, 0.0f, 0.5f, 0.0f, 0.0f, 1.0f,
-        0.5f, 0.0f, 0.5f, 0.0f, 0.0f, 1.0f,
-        0.5f, 0.5f, 0.5f, 0.0f, 0.0f, 1.0f,
-        0.0f, 0.5f, 0.5f, 0.0f, 0.0f, 1.0f,
-
-        0.0f, 0.0f, 0.5f, 1.0f, 1.0f, 0.0f,
-        0.0f, 0.5f, 0.5f, 1.0f, 1.0f, 0.0f,
-        0.0f, 0.5f, 0.0f, 1.0f, 1.0f, 0.0f,
-        0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f,
+        0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f,
+        0.5f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f,
+        0.5f, 0.5f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f,
+        0.0f, 0.5f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f,
+
+        0.5f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f,
+        0.5f, 0.5f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f,
+        0.5f, 0.0f, 0.5f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f,
+        0.5f, 0.5f, 0.5f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f,
+
+        0.0f, 0.0f, 0.5f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f,
+        0.5f, 0.0f, 0.5f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f,
+        0.5f, 0.5f, 0.5f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f,
+        0.0f, 0.5f, 0.5f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f,
+
+        0.0f, 0.0f, 0.5f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f,
+        0.0f, 0.5f, 0.5f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f,
+        0.0f, 0.5f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f,
+        0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f,
 
         //Uper Plane
-        0.5f, 0.5f, 0.5f, 0.0f, 1.0f, 1.0f,
-        0.5f, 0.5f, 0.0f, 0.0f, 1.0f, 1.0f,
-        0.0f, 0.5f, 0.0f, 0.0f, 1.0f, 1.0f,
-        0.0f, 0.5f, 0.5f, 0.0f, 1.0f, 1.0f,
-
-        0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f,
-        0.5f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f,
-        0.5f, 0.0f, 0.5f, 1.0f, 0.0f, 1.0f,
-        0.0f, 0.0f, 0.5f, 1.0f, 0.0f, 1.0f
+        0.5f, 0.5f, 0.5f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f,
+        0.5f, 0.5f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f,
+        0.0f, 0.5f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f,
+        0.0f, 0.5f, 0.5f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f,
+
+        0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f,
+        0.5f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f,
+        0.5f, 0.0f, 0.5f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f,
+        0.0f, 0.0f, 0.5f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f
     };
 
     unsigned int cube_indices[] = {
@@ -963,99 +915,90 @@ int main()
     0.0950, 0.8500, 5.1000,
     };
 
-    unsigned int bezierCylinderVAO;
-    coordinates.clear();
-    normals.clear();
-    indices.clear();
-    vertices.clear();
-    bezierCylinderVAO = hollowBezier(cntrlPointsCylinder.data(), ((unsigned int)cntrlPointsCylinder.size() / 3) - 1);
-
-    unsigned int VBO, VAO, EBO;
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glGenBuffers(1, &EBO);
-
-    glBindVertexArray(VAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(cube_vertices), cube_vertices, GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(cube_indices), cube_indices, GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    // vertex normal attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)12);
-    glEnableVertexAttribArray(1);
-
-    unsigned int cubeVAO, cubeVBO, cubeEBO;
-    glGenVertexArrays(1, &cubeVAO);
-    glGenBuffers(1, &cubeVBO);
-    glGenBuffers(1, &cubeEBO);
-
-    glBindVertexArray(cubeVAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(cube_vertices), cube_vertices, GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cubeEBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(cube_indices), cube_indices, GL_STATIC_DRAW);
-
-    // position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    // vertex normal attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)12);
-    glEnableVertexAttribArray(1);
-
-
-    unsigned int lightCubeVAO;
-    glGenVertexArrays(1, &lightCubeVAO);
-    glBindVertexArray(lightCubeVAO);
+    // every primitive mesh below is generated on worker threads and
+    // uploaded together at startupMeshes.finish()
+    MeshBatch startupMeshes;
+    startupMeshes.begin();
+
+    int cylinderDegree = ((unsigned int)cntrlPointsCylinder.size() / 3) - 1;
+    BezierRevolution bezierCylinder(cntrlPointsCylinder.data(), cylinderDegree);
+
+    // CPU balloon LOD chain, when not tessellating on the GPU: each level
+    // allows four times the chordal error and twice the normal turn of the
+    // one before
+    LODChain bezierCylinderLOD;
+    MeshHandle bezierCylinderMeshes[3];
+    if (!tessellateBezierOnGPU) {
+        const GLfloat* cylinderPoints = cntrlPointsCylinder.data();
+        MeshKey profileKey("hollow bezier");
+        for (size_t i = 0; i < cntrlPointsCylinder.size(); i++)
+            profileKey << cntrlPointsCylinder[i];
+        string cylinderKey = profileKey.str();
+
+        for (int level = 0; level < 3; level++) {
+            float tolerance = bezierTolerance * (1 << (2 * level)), maxAngle = bezierMaxAngle * (1 << level);
+            submitMesh((MeshKey(cylinderKey.c_str()) << tolerance << maxAngle).str(),
+                [=](MeshBuilder& builder) { hollowBezier(builder, cylinderPoints, cylinderDegree, tolerance, maxAngle); },
+                VERTEX_FORMAT_QUANTIZED, [&, level](unsigned int mesh) {
+                    bezierCylinderMeshes[level].reset(mesh);
+                    bezierCylinderLOD.addLevel(mesh);
+                });
+        }
+        bezierCylinderLOD.setThresholds({ 96.0f, 32.0f });
+        reportBezierTessellation("bezier cylinder", cntrlPointsCylinder.data(), cylinderDegree, bezierTolerance, bezierMaxAngle);
+    }
+    else {
+        cout << "bezier cylinder: tessellated on the GPU from " << bezierCylinder.getControlPointCount()
+            << " control points (" << bezierCylinder.getMemoryBytes() << " bytes)" << endl;
+    }
 
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    // note that we update the lamp's position attribute's stride to reflect the updated buffer data
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
+    MeshHandle cubeMesh;
+    submitMesh("light cube", [&](MeshBuilder& builder) {
+            builder.addVertices(cube_vertices, 24);
+            builder.addIndices(cube_indices, 36);
+        }, VERTEX_FORMAT_PACKED, [&](unsigned int mesh) { cubeMesh.reset(mesh); });
 
-    Sphere sphere = Sphere();
+    Sphere sphere;
+    sphere.setImpostorMode(raycastSpheres);
+    Shader sphereImpostorShader("sphereImpostor.vs", "sphereImpostor.fs");
 
     //glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
     Shader lightingShaderWithTexture("vertexShaderForPhongShadingWithTexture.vs", "fragmentShaderForPhongShadingWithTexture.fs");
 
     string diffuseMapPath;
     unsigned int diffMap;
-    string specularMapPath = "container2_specular.png";
-    unsigned int specMap = loadTexture(specularMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
+    string specularMapPath = "container2_specular.png";  // packed into the alpha of every diffuse map
+
+    if (applyMipFeedback && !recordMipFeedback)
+        TextureCooker::shared().loadSizeLimits("mip_feedback.txt");
+    // mip feedback needs every level at base level 0
+    TextureResidency::shared().setStreaming(streamTextures && !recordMipFeedback);
+    TextureResidency::shared().setBudget((size_t)textureBudgetMB * 1048576);
 
     diffuseMapPath = "wall.jpg";
-    diffMap = loadTexture(diffuseMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
-    Cube cube_wall = Cube(diffMap, specMap, 32.0f, 0.0f, 0.0f, 2.0f, 1.0f);
+    diffMap = loadMaterialTexture(diffuseMapPath.c_str(), specularMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
+    Cube cube_wall = Cube(diffMap, 32.0f, 0.0f, 0.0f, 2.0f, 1.0f);
 
     diffuseMapPath = "curtain.jpg";
-    diffMap = loadTexture(diffuseMapPath.c_str(), GL_MIRRORED_REPEAT, GL_MIRRORED_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
-    Cube cube_curtain = Cube(diffMap, specMap, 32.0f, 0.0f, 0.0f, 2.0f, 1.0f);
+    diffMap = loadMaterialTexture(diffuseMapPath.c_str(), specularMapPath.c_str(), GL_MIRRORED_REPEAT, GL_MIRRORED_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR, TEXTURES_THEATER);
+    Cube cube_curtain = Cube(diffMap, 32.0f, 0.0f, 0.0f, 2.0f, 1.0f);
 
     diffuseMapPath = "floor_.jpg";
-    diffMap = loadTexture(diffuseMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
-    Cube cube_floor = Cube(diffMap, specMap, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f);
+    diffMap = loadMaterialTexture(diffuseMapPath.c_str(), specularMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
+    Cube cube_floor = Cube(diffMap, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f);
 
     diffuseMapPath = "box.jpeg";
-    diffMap = loadTexture(diffuseMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
-    Cube cube_box = Cube(diffMap, specMap, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f);
+    diffMap = loadMaterialTexture(diffuseMapPath.c_str(), specularMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
+    Cube cube_box = Cube(diffMap, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f);
 
     diffuseMapPath = "bottol.png";
-    diffMap = loadTexture(diffuseMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
-    Cube bottol_box = Cube(diffMap, specMap, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f);
+    diffMap = loadMaterialTexture(diffuseMapPath.c_str(), specularMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
+    Cube bottol_box = Cube(diffMap, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f);
 
     diffuseMapPath = "cone.jpeg";
-    diffMap = loadTexture(diffuseMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
+    diffMap = loadMaterialTexture(diffuseMapPath.c_str(), specularMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
     // Create a Cone2 object
-    Cone2 cone_chair = Cone2(
+    Cone2 cone_chair(
         1.0f,                   // Radius
         2.0f,                   // Height
         36,                     // Sector count (smoothness of the cone base)
@@ -1063,115 +1006,159 @@ int main()
         glm::vec3(1.0f, 0.5f, 0.3f), // Diffuse color
         glm::vec3(1.0f, 1.0f, 1.0f), // Specular color
         32.0f,                 // Shininess
-        diffMap,            // Diffuse texture ID
-        specMap,           // Specular texture ID
+        diffMap,            // Diffuse texture ID, specular in alpha
         0.0f, 0.0f,            // Texture coordinates (Xmin, Ymin)
         1.0f, 1.0f             // Texture coordinates (Xmax, Ymax)
     );
 
     diffuseMapPath = "mirror.jpg";
-    diffMap = loadTexture(diffuseMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
-    Polygon cylinder_mirror(diffMap, specMap, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f, 30);
+    diffMap = loadMaterialTexture(diffuseMapPath.c_str(), specularMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
+    Polygon cylinder_mirror(diffMap, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f, 30);
 
     diffuseMapPath = "besin_tile.jpg";
-    diffMap = loadTexture(diffuseMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
-    HollowPolygon cylinder_besin(diffMap, specMap, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f, 6, 1.9f, 2.2f, 1.0f, 1.3f);
+    diffMap = loadMaterialTexture(diffuseMapPath.c_str(), specularMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
+    HollowPolygon cylinder_besin(diffMap, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f, 6, 1.9f, 2.2f, 1.0f, 1.3f);
 
-    diffMap = loadTexture(diffuseMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
-    HollowPolygon cylinder_kitchen_besin(diffMap, specMap, 32.0f, 0.0f, 0.0f, 4.0f, 1.0f, 4, 1.9f, 2.2f, 1.8f, 2.1f);
+    diffMap = loadMaterialTexture(diffuseMapPath.c_str(), specularMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
+    HollowPolygon cylinder_kitchen_besin(diffMap, 32.0f, 0.0f, 0.0f, 4.0f, 1.0f, 4, 1.9f, 2.2f, 1.8f, 2.1f);
 
     diffuseMapPath = "besin.jpg";
-    diffMap = loadTexture(diffuseMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
-    Cube cube_besin = Cube(diffMap, specMap, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f);
+    diffMap = loadMaterialTexture(diffuseMapPath.c_str(), specularMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
+    Cube cube_besin = Cube(diffMap, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f);
 
     diffuseMapPath = "design1.jpeg";
-    diffMap = loadTexture(diffuseMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
-    Polygon cylinder_design1(diffMap, specMap, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f, 30);
+    diffMap = loadMaterialTexture(diffuseMapPath.c_str(), specularMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
+    Polygon cylinder_design1(diffMap, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f, 30);
 
     diffuseMapPath = "design2.jpg";
-    diffMap = loadTexture(diffuseMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
-    Polygon cylinder_design2(diffMap, specMap, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f, 30);
+    diffMap = loadMaterialTexture(diffuseMapPath.c_str(), specularMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
+    Polygon cylinder_design2(diffMap, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f, 30);
 
     diffuseMapPath = "design3.jpg";
-    diffMap = loadTexture(diffuseMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
-    Polygon cylinder_design3(diffMap, specMap, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f, 30);
+    diffMap = loadMaterialTexture(diffuseMapPath.c_str(), specularMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
+    Polygon cylinder_design3(diffMap, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f, 30);
 
     diffuseMapPath = "design4.jpg";
-    diffMap = loadTexture(diffuseMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
-    Polygon cylinder_design4(diffMap, specMap, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f, 30);
+    diffMap = loadMaterialTexture(diffuseMapPath.c_str(), specularMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
+    Polygon cylinder_design4(diffMap, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f, 30);
 
     diffuseMapPath = "design5.jpg";
-    diffMap = loadTexture(diffuseMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
-    Polygon cylinder_design5(diffMap, specMap, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f, 30);
+    diffMap = loadMaterialTexture(diffuseMapPath.c_str(), specularMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
+    Polygon cylinder_design5(diffMap, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f, 30);
 
     diffuseMapPath = "hexagon.jpg";
-    diffMap = loadTexture(diffuseMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
-    Polygon hexagon_design1(diffMap, specMap, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f, 6);
+    diffMap = loadMaterialTexture(diffuseMapPath.c_str(), specularMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
+    Polygon hexagon_design1(diffMap, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f, 6);
 
     diffuseMapPath = "hexagon2.jpg";
-    diffMap = loadTexture(diffuseMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
-    Polygon hexagon_design2(diffMap, specMap, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f, 6);
+    diffMap = loadMaterialTexture(diffuseMapPath.c_str(), specularMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
+    Polygon hexagon_design2(diffMap, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f, 6);
 
     diffuseMapPath = "hexagon3.jpg";
-    diffMap = loadTexture(diffuseMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
-    Polygon hexagon_design3(diffMap, specMap, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f, 6);
+    diffMap = loadMaterialTexture(diffuseMapPath.c_str(), specularMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
+    Polygon hexagon_design3(diffMap, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f, 6);
 
     diffuseMapPath = "sofa.jpg";
-    diffMap = loadTexture(diffuseMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
-    Cube cube_sofa = Cube(diffMap, specMap, 32.0f, 0.0f, 0.0f, 2.0f, 1.0f);
+    diffMap = loadMaterialTexture(diffuseMapPath.c_str(), specularMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
+    Cube cube_sofa = Cube(diffMap, 32.0f, 0.0f, 0.0f, 2.0f, 1.0f);
 
     diffuseMapPath = "chair.jpg";
-    diffMap = loadTexture(diffuseMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
-    Cube cube_table = Cube(diffMap, specMap, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f);
+    diffMap = loadMaterialTexture(diffuseMapPath.c_str(), specularMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
+    Cube cube_table = Cube(diffMap, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f);
 
     diffuseMapPath = "table.png";
-    diffMap = loadTexture(diffuseMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
-    Cube cube_chair = Cube(diffMap, specMap, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f);
+    diffMap = loadMaterialTexture(diffuseMapPath.c_str(), specularMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
+    Cube cube_chair = Cube(diffMap, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f);
 
     diffuseMapPath = "kitchen_box.jpg";
-    diffMap = loadTexture(diffuseMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
-    Cube cube_kitchen_box = Cube(diffMap, specMap, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f);
+    diffMap = loadMaterialTexture(diffuseMapPath.c_str(), specularMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR, TEXTURES_KITCHEN);
+    Cube cube_kitchen_box = Cube(diffMap, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f);
 
     diffuseMapPath = "stove.png";
-    diffMap = loadTexture(diffuseMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
-    Cube cube_stove = Cube(diffMap, specMap, 32.0f, 0.0f, 0.0f, 1.0f, 2.0f);
+    diffMap = loadMaterialTexture(diffuseMapPath.c_str(), specularMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR, TEXTURES_KITCHEN);
+    Cube cube_stove = Cube(diffMap, 32.0f, 0.0f, 0.0f, 1.0f, 2.0f);
 
     diffuseMapPath = "oven.jpg";
-    diffMap = loadTexture(diffuseMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
-    Cube cube_oven = Cube(diffMap, specMap, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f);
+    diffMap = loadMaterialTexture(diffuseMapPath.c_str(), specularMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR, TEXTURES_KITCHEN);
+    Cube cube_oven = Cube(diffMap, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f);
 
     diffuseMapPath = "white.jpg";
-    diffMap = loadTexture(diffuseMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
-    Cube cube_white = Cube(diffMap, specMap, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f);
+    diffMap = loadMaterialTexture(diffuseMapPath.c_str(), specularMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
+    Cube cube_white = Cube(diffMap, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f);
 
     diffuseMapPath = "tile.png";
-    diffMap = loadTexture(diffuseMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
-    Cube cube_tile = Cube(diffMap, specMap, 32.0f, 0.0f, 0.0f, 4.0, 2.0f);
+    diffMap = loadMaterialTexture(diffuseMapPath.c_str(), specularMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
+    Cube cube_tile = Cube(diffMap, 32.0f, 0.0f, 0.0f, 4.0, 2.0f);
 
-    diffMap = loadTexture(diffuseMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
-    Cube cube_tile2 = Cube(diffMap, specMap, 32.0f, 0.0f, 0.0f, 1.0, 2.0f);
+    diffMap = loadMaterialTexture(diffuseMapPath.c_str(), specularMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
+    Cube cube_tile2 = Cube(diffMap, 32.0f, 0.0f, 0.0f, 1.0, 2.0f);
 
-    diffMap = loadTexture(diffuseMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
-    Polygon polygon_star1(diffMap, specMap, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f, 3);
+    diffMap = loadMaterialTexture(diffuseMapPath.c_str(), specularMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
+    Polygon polygon_star1(diffMap, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f, 3);
 
-    diffMap = loadTexture(diffuseMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
-    Polygon polygon_star2(diffMap, specMap, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f, 4);
+    diffMap = loadMaterialTexture(diffuseMapPath.c_str(), specularMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
+    Polygon polygon_star2(diffMap, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f, 4);
 
     diffuseMapPath = "grass.jpg";
-    diffMap = loadTexture(diffuseMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
-    Cube cube_grass = Cube(diffMap, specMap, 32.0f, 0.0f, 0.0f, 30.0f, 30.0f);
+    diffMap = loadMaterialTexture(diffuseMapPath.c_str(), specularMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
+    Cube cube_grass = Cube(diffMap, 32.0f, 0.0f, 0.0f, 30.0f, 30.0f);
 
     diffuseMapPath = "tv.png";
-    diffMap = loadTexture(diffuseMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
-    Cube cube_tv = Cube(diffMap, specMap, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f);
+    diffMap = loadMaterialTexture(diffuseMapPath.c_str(), specularMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR, TEXTURES_THEATER);
+    Cube cube_tv = Cube(diffMap, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f);
 
     diffuseMapPath = "tv2.jpg";
-    diffMap = loadTexture(diffuseMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
-    Cube cube_tv2 = Cube(diffMap, specMap, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f);
+    diffMap = loadMaterialTexture(diffuseMapPath.c_str(), specularMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR, TEXTURES_THEATER);
+    Cube cube_tv2 = Cube(diffMap, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f);
 
     diffuseMapPath = "theater_floor.jpg";
-    diffMap = loadTexture(diffuseMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
-    Cube cube_theater_floor = Cube(diffMap, specMap, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f);
+    diffMap = loadMaterialTexture(diffuseMapPath.c_str(), specularMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR, TEXTURES_THEATER);
+    Cube cube_theater_floor = Cube(diffMap, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f);
+
+    TextureArrays::shared().build();
+    startupMeshes.finish();
+    if (!tessellateBezierOnGPU)
+        GeometryArena::shared().printMeshFootprint("bezier cylinder", bezierCylinderLOD.getLevel(0));
+    GeometryArena::shared().printMeshFootprint("sphere", sphere.getMesh());
+    GeometryArena::shared().printMemoryReport();
+    if (useCookedTextures)
+        TextureCooker::shared().printReport();
+    TextureResidency::shared().printReport();
+
+    // static part of the scene, drawn with multi-draw indirect
+    Shader staticSceneShader("vertexShaderForStaticScene.vs", "fragmentShaderForTextureArrays.fs");
+    Shader staticSceneFlatShader("vertexShaderForStaticScene.vs", "fragmentShaderForStaticScene.fs");
+    Shader proceduralSceneShader("vertexShaderForProceduralScene.vs", "fragmentShaderForTextureArrays.fs");
+    Shader proceduralSceneFlatShader("vertexShaderForProceduralScene.vs", "fragmentShaderForStaticScene.fs");
+    Shader mipFeedbackShader("vertexShaderForStaticScene.vs", "mipFeedback.fs");
+    Shader mipFeedbackProceduralShader("vertexShaderForProceduralScene.vs", "mipFeedback.fs");
+    Shader staticSceneCullShader("staticSceneCull.cs");
+    StaticScene staticScene;
+    staticScene.setProceduralPrimitives(pullProceduralVertices);
+
+    // distant chairs, tables and sofas drawn as octahedral impostors
+    Shader impostorShader("impostor.vs", "impostor.fs");
+    Shader impostorBakeShader("vertexShaderForStaticScene.vs", "impostorBake.fs");
+    Shader impostorProceduralBakeShader("vertexShaderForProceduralScene.vs", "impostorBake.fs");
+    ImpostorAtlas furnitureImpostors(impostorQuality(furnitureImpostorQuality));
+    unsigned int chairPrefab, tablePrefab, sofaPrefab;
+    {
+        glm::mat4 identityMatrix = glm::mat4(1.0f);
+        glm::vec3 origin(0.0f);
+        glm::vec3 viewPos(0.0f, 0.0f, 5.0f);
+        chairPrefab = furnitureImpostors.addPrefab("chair", [&]() {
+            drawChairWithTransformations(identityMatrix, identityMatrix, origin, origin, lightingShaderWithTexture, lightingShaderWithTexture, cube_chair, cube_chair, viewPos);
+        }, pullProceduralVertices);
+        tablePrefab = furnitureImpostors.addPrefab("table", [&]() {
+            drawTableWithTransformations(identityMatrix, identityMatrix, origin, origin, lightingShaderWithTexture, ourShader, cube_table);
+        }, pullProceduralVertices);
+        sofaPrefab = furnitureImpostors.addPrefab("sofa", [&]() {
+            drawSofaWithTransformations(identityMatrix, identityMatrix, origin, origin, lightingShaderWithTexture, ourShader, cube_floor, cube_sofa);
+        }, pullProceduralVertices);
+        TextureResidency::shared().uploadAllLevels();
+        furnitureImpostors.bake(impostorBakeShader, impostorProceduralBakeShader, staticSceneCullShader);
+    }
+    staticScene.setClusterFade(furnitureImpostors.getFadeStart(), furnitureImpostors.getFadeWidth());
 
     //ourShader.use();
     //lightingShader.use();
@@ -1200,23 +1187,21 @@ int main()
 
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        // be sure to activate shader when setting uniforms/drawing objects
-
-
-        setUpLighting(lightingShader);
-
-
-        lightingShader.use();
-
-        // pass projection matrix to shader (note that in this case it could change every frame)
+        // projection matrix (note that in this case it could change every frame)
         glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
         //glm::mat4 projection = glm::ortho(-2.0f, +2.0f, -1.5f, +1.5f, 0.1f, 100.0f);
-        lightingShader.setMat4("projection", projection);
 
         // camera/view transformation
         glm::mat4 view = camera.GetViewMatrix();
         //glm::mat4 view = basic_camera.createViewMatrix();
-        lightingShader.setMat4("view", view);
+
+        // one upload for every program: they all read the Camera block
+        CameraUniforms::shared().update(view, projection, camera.Position, currentFrame, glm::vec2((float)SCR_WIDTH, (float)SCR_HEIGHT));
+
+        // be sure to activate shader when setting uniforms/drawing objects
+        setUpLighting(lightingShader);
+
+        LODContext::current().update(view, projection, (float)SCR_HEIGHT);
 
         // Modelling Transformation
         glm::mat4 identityMatrix = glm::mat4(1.0f); // make sure to initialize matrix to identity matrix first
@@ -1231,59 +1216,29 @@ int main()
 
         // be sure to activate shader when setting uniforms/drawing objects
         setUpLighting(lightingShaderWithTexture);
-        lightingShaderWithTexture.use();
-
-        // pass projection matrix to shader (note that in this case it could change every frame)
-        // glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
-        //glm::mat4 projection = glm::ortho(-2.0f, +2.0f, -1.5f, +1.5f, 0.1f, 100.0f);
-        lightingShaderWithTexture.setMat4("projection", projection);
-
-        // camera/view transformation
-        // glm::mat4 view = camera.GetViewMatrix();
-        //glm::mat4 view = basic_camera.createViewMatrix();
-        lightingShaderWithTexture.setMat4("view", view);
+        setUpLighting(staticSceneShader);
+        setUpLighting(proceduralSceneShader);
+        setUpLighting(impostorShader);
 
+        setUpLighting(bezierShader);
+        bezierShader.setFloat("edgePixels", bezierEdgePixels);
 
         // bezier curve
  
         translateMatrix = glm::translate(identityMatrix, glm::vec3(17.5, 16.5, 0 +ballonSpeed));
         scaleMatrix = glm::scale(translateMatrix, glm::vec3(3.0, 8, 3.0));
         model = globalTranslationMatrix * scaleMatrix;
-        lightingShader.use();
-        lightingShader.setMat4("model", model);
-        lightingShader.setVec3("material.ambient", glm::vec3(1.0f, 0.0f, 0.0f));
-        lightingShader.setVec3("material.diffuse", glm::vec3(1.0f, 0.0f, 0.0f));
-        lightingShader.setVec3("material.specular", glm::vec3(1.0f, 0.0f, 0.0f));
-        lightingShader.setFloat("material.shininess", 32.0f);
-        glBindVertexArray(bezierCylinderVAO);
-        glDrawElements(GL_TRIANGLES, (unsigned int)indices.size(), GL_UNSIGNED_INT, (void*)0);
-        glBindVertexArray(0);
+        drawBalloon(lightingShader, bezierShader, bezierCylinderLOD, bezierCylinder, model, glm::vec3(1.0f, 0.0f, 0.0f));
 
         translateMatrix = glm::translate(identityMatrix, glm::vec3(20.0, 16.5, 2 + ballonSpeed));
         scaleMatrix = glm::scale(translateMatrix, glm::vec3(3.0, 9.5, 3.0));
         model = globalTranslationMatrix * scaleMatrix;
-        lightingShader.use();
-        lightingShader.setMat4("model", model);
-        lightingShader.setVec3("material.ambient", glm::vec3(1.0f, 1.0f, 0.0f));
-        lightingShader.setVec3("material.diffuse", glm::vec3(1.0f, 1.0f, 0.0f));
-        lightingShader.setVec3("material.specular", glm::vec3(1.0f, 1.0f, 0.0f));
-        lightingShader.setFloat("material.shininess", 32.0f);
-        glBindVertexArray(bezierCylinderVAO);
-        glDrawElements(GL_TRIANGLES, (unsigned int)indices.size(), GL_UNSIGNED_INT, (void*)0);
-        glBindVertexArray(0);
+        drawBalloon(lightingShader, bezierShader, bezierCylinderLOD, bezierCylinder, model, glm::vec3(1.0f, 1.0f, 0.0f));
 
         translateMatrix = glm::translate(identityMatrix, glm::vec3(17.5, 16.5, 4 +ballonSpeed));
         scaleMatrix = glm::scale(translateMatrix, glm::vec3(3.0, 8, 3.0));
         model = globalTranslationMatrix * scaleMatrix;
-        lightingShader.use();
-        lightingShader.setMat4("model", model);
-        lightingShader.setVec3("material.ambient", glm::vec3(1.0f, 0.5f, 0.0f));
-        lightingShader.setVec3("material.diffuse", glm::vec3(1.0f, 0.5f, 0.0f));
-        lightingShader.setVec3("material.specular", glm::vec3(1.0f, 0.5f, 0.0f));
-        lightingShader.setFloat("material.shininess", 32.0f);
-        glBindVertexArray(bezierCylinderVAO);
-        glDrawElements(GL_TRIANGLES, (unsigned int)indices.size(), GL_UNSIGNED_INT, (void*)0);
-        glBindVertexArray(0);
+        drawBalloon(lightingShader, bezierShader, bezierCylinderLOD, bezierCylinder, model, glm::vec3(1.0f, 0.5f, 0.0f));
 
         translateMatrix = glm::translate(identityMatrix, glm::vec3(27.0, 20.5, -10 + ballonSpeed));
         scaleMatrix = glm::scale(translateMatrix, glm::vec3(1.0, 1.5, 1.0));
@@ -1300,6 +1255,8 @@ int main()
         model = globalTranslationMatrix * scaleMatrix;
         sphere.drawSphere(ourShader, model, glm::vec3(1.0f, 0.5f, 0.5f));
 
+        sphere.drawImpostors(sphereImpostorShader);
+
         ballonSpeed += 0.05;
 
         drawFan(globalTranslationMatrix, glm::vec3(12.0, 17.0, 10.0), glm::vec3(1.0, 1.0, 1.0), 0.0, true, lightingShaderWithTexture, ourShader, ang, cylinder_mirror, cube_table);
@@ -1310,464 +1267,562 @@ int main()
             ang = (float)((int)ang % 360); // Keep angle within 360 degrees
         }
 
-        // grass
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(-30.0f, -1.2f, -30.0f));
-        scaleMatrix = glm::scale(translateMatrix, glm::vec3(100.0f, 0.7f, 100.0f));
-        model = globalTranslationMatrix * scaleMatrix;
-        cube_grass.drawCubeWithTexture(lightingShaderWithTexture, model);
+        // ************************************************************************ Static Scene ************************************************************************
 
-        // ************************************************************************ Cafeteria Boundary ************************************************************************
+        // Everything below that never moves is only walked when the static scene has to be
+        // re-recorded; the draw calls are captured into the scene instead of being issued.
+        // It is recorded in scene space and the global transform is applied per frame.
+        if (staticScene.needsRebuild()) {
+            glm::mat4 globalTranslationMatrix = identityMatrix;
+            staticScene.beginRecording();
+            furnitureImpostors.clearInstances();
 
-        // Drink Wall
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(0.0f, 0.0f, 0.0f));
-        scaleMatrix = glm::scale(translateMatrix, glm::vec3(23.0f, 7.5f, 0.5f));
-        model = globalTranslationMatrix * scaleMatrix;
-        //cube_wall.drawCubeWithTexture(lightingShaderWithTexture, model);
+            // grass
+            translateMatrix = glm::translate(identityMatrix, glm::vec3(-30.0f, -1.2f, -30.0f));
+            scaleMatrix = glm::scale(translateMatrix, glm::vec3(100.0f, 0.7f, 100.0f));
+            model = globalTranslationMatrix * scaleMatrix;
+            cube_grass.drawCubeWithTexture(lightingShaderWithTexture, model);
 
-        //Design Wall
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(-0.5f, 0.0f, 30.0f));
-        scaleMatrix = glm::scale(translateMatrix, glm::vec3(23.5f, 7.5f, 0.5f));
-        model = globalTranslationMatrix * scaleMatrix;
-        cube_wall.drawCubeWithTexture(lightingShaderWithTexture, model);
+            // ************************************************************************ Cafeteria Boundary ************************************************************************
 
-        //Besin Wall
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(0.0f, 0.0f, 0.0f));
-        scaleMatrix = glm::scale(translateMatrix, glm::vec3(-0.5f, 7.5f, 30.0f));
-        model = globalTranslationMatrix * scaleMatrix;
-        cube_wall.drawCubeWithTexture(lightingShaderWithTexture, model);
+            // Drink Wall
+            translateMatrix = glm::translate(identityMatrix, glm::vec3(0.0f, 0.0f, 0.0f));
+            scaleMatrix = glm::scale(translateMatrix, glm::vec3(23.0f, 7.5f, 0.5f));
+            model = globalTranslationMatrix * scaleMatrix;
+            //cube_wall.drawCubeWithTexture(lightingShaderWithTexture, model);
 
-        // Floor
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(-0.5f, 0.0f, 0.0f));
-        scaleMatrix = glm::scale(translateMatrix, glm::vec3(23.5f, -0.5f, 30.5f));
-        model = globalTranslationMatrix * scaleMatrix;
-        ourShader.setMat4("model", model);
-        cube_floor.drawCubeWithTexture(lightingShaderWithTexture, model);
+            //Design Wall
+            translateMatrix = glm::translate(identityMatrix, glm::vec3(-0.5f, 0.0f, 30.0f));
+            scaleMatrix = glm::scale(translateMatrix, glm::vec3(23.5f, 7.5f, 0.5f));
+            model = globalTranslationMatrix * scaleMatrix;
+            cube_wall.drawCubeWithTexture(lightingShaderWithTexture, model);
 
-        // Ceiling
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(-0.5f, 7.5f, 0.0f));
-        scaleMatrix = glm::scale(translateMatrix, glm::vec3(23.5f, 0.5f, 30.5f));
-        model = globalTranslationMatrix * scaleMatrix;
-        ourShader.setMat4("model", model);
-        cube_floor.drawCubeWithTexture(lightingShaderWithTexture, model);
+            //Besin Wall
+            translateMatrix = glm::translate(identityMatrix, glm::vec3(0.0f, 0.0f, 0.0f));
+            scaleMatrix = glm::scale(translateMatrix, glm::vec3(-0.5f, 7.5f, 30.0f));
+            model = globalTranslationMatrix * scaleMatrix;
+            cube_wall.drawCubeWithTexture(lightingShaderWithTexture, model);
 
-        // ************************************************************************ Kitchen Boundary ************************************************************************
+            // Floor
+            translateMatrix = glm::translate(identityMatrix, glm::vec3(-0.5f, 0.0f, 0.0f));
+            scaleMatrix = glm::scale(translateMatrix, glm::vec3(23.5f, -0.5f, 30.5f));
+            model = globalTranslationMatrix * scaleMatrix;
+            ourShader.setMat4("model", model);
+            cube_floor.drawCubeWithTexture(lightingShaderWithTexture, model);
 
-        // Right Wall
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(0.0f, 0.0f, -9.0f));
-        scaleMatrix = glm::scale(translateMatrix, glm::vec3(18.0f, 7.5f, 0.5f));
-        model = globalTranslationMatrix * scaleMatrix;
-        cube_tile.drawCubeWithTexture(lightingShaderWithTexture, model);
+            // Ceiling
+            translateMatrix = glm::translate(identityMatrix, glm::vec3(-0.5f, 7.5f, 0.0f));
+            scaleMatrix = glm::scale(translateMatrix, glm::vec3(23.5f, 0.5f, 30.5f));
+            model = globalTranslationMatrix * scaleMatrix;
+            ourShader.setMat4("model", model);
+            cube_floor.drawCubeWithTexture(lightingShaderWithTexture, model);
 
-        //Far Wall
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(0.0f, 0.0f, -9.0f));
-        scaleMatrix = glm::scale(translateMatrix, glm::vec3(-0.5f, 7.5f, 9.0f));
-        model = globalTranslationMatrix * scaleMatrix;
-        cube_tile2.drawCubeWithTexture(lightingShaderWithTexture, model);
+            // ************************************************************************ Kitchen Boundary ************************************************************************
 
-        //Near Wall
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(23.0f, 0.0f, -9.0f));
-        scaleMatrix = glm::scale(translateMatrix, glm::vec3(-0.5f, 7.5f, 9.0f));
-        model = globalTranslationMatrix * scaleMatrix;
-        cube_tile2.drawCubeWithTexture(lightingShaderWithTexture, model);
+            // Right Wall
+            translateMatrix = glm::translate(identityMatrix, glm::vec3(0.0f, 0.0f, -9.0f));
+            scaleMatrix = glm::scale(translateMatrix, glm::vec3(18.0f, 7.5f, 0.5f));
+            model = globalTranslationMatrix * scaleMatrix;
+            cube_tile.drawCubeWithTexture(lightingShaderWithTexture, model);
 
-        // Floor
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(-0.5f, 0.0f, -9.0f));
-        scaleMatrix = glm::scale(translateMatrix, glm::vec3(23.5f, -0.5f, 9.5f));
-        model = globalTranslationMatrix * scaleMatrix;
-        ourShader.setMat4("model", model);
-        cube_floor.drawCubeWithTexture(lightingShaderWithTexture, model);
+            //Far Wall
+            translateMatrix = glm::translate(identityMatrix, glm::vec3(0.0f, 0.0f, -9.0f));
+            scaleMatrix = glm::scale(translateMatrix, glm::vec3(-0.5f, 7.5f, 9.0f));
+            model = globalTranslationMatrix * scaleMatrix;
+            cube_tile2.drawCubeWithTexture(lightingShaderWithTexture, model);
 
-        // Ceiling
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(-0.5f, 7.5f, -9.0f));
-        scaleMatrix = glm::scale(translateMatrix, glm::vec3(23.5f, 0.5f, 9.5f));
-        model = globalTranslationMatrix * scaleMatrix;
-        ourShader.setMat4("model", model);
-        cube_floor.drawCubeWithTexture(lightingShaderWithTexture, model);
+            //Near Wall
+            translateMatrix = glm::translate(identityMatrix, glm::vec3(23.0f, 0.0f, -9.0f));
+            scaleMatrix = glm::scale(translateMatrix, glm::vec3(-0.5f, 7.5f, 9.0f));
+            model = globalTranslationMatrix * scaleMatrix;
+            cube_tile2.drawCubeWithTexture(lightingShaderWithTexture, model);
 
-        // ************************************************************************ Kitchen Box ************************************************************************
+            // Floor
+            translateMatrix = glm::translate(identityMatrix, glm::vec3(-0.5f, 0.0f, -9.0f));
+            scaleMatrix = glm::scale(translateMatrix, glm::vec3(23.5f, -0.5f, 9.5f));
+            model = globalTranslationMatrix * scaleMatrix;
+            ourShader.setMat4("model", model);
+            cube_floor.drawCubeWithTexture(lightingShaderWithTexture, model);
 
-        for (int i = 0; i < 12; i++) {
-            translateMatrix = glm::translate(identityMatrix, glm::vec3(0.0f + i * 1.5, 2.5f, -8.5f));
-            scaleMatrix = glm::scale(translateMatrix, glm::vec3(1.5f, 0.1f, 2.0f));
+            // Ceiling
+            translateMatrix = glm::translate(identityMatrix, glm::vec3(-0.5f, 7.5f, -9.0f));
+            scaleMatrix = glm::scale(translateMatrix, glm::vec3(23.5f, 0.5f, 9.5f));
             model = globalTranslationMatrix * scaleMatrix;
-            cube_white.drawCubeWithTexture(lightingShaderWithTexture, model);
+            ourShader.setMat4("model", model);
+            cube_floor.drawCubeWithTexture(lightingShaderWithTexture, model);
 
-            if (i == 2 || i == 9) {
-                translateMatrix = glm::translate(identityMatrix, glm::vec3(0.0f + i * 1.5, 0.0f, -8.5f));
-                scaleMatrix = glm::scale(translateMatrix, glm::vec3(3.0f, 2.5f, 2.0f));
-                model = globalTranslationMatrix * scaleMatrix;
-                cube_oven.drawCubeWithTexture(lightingShaderWithTexture, model);
-            }
-            else if (i == 3 || i == 10);
+            // ************************************************************************ Kitchen Box ************************************************************************
 
-            else {
-                translateMatrix = glm::translate(identityMatrix, glm::vec3(0.0f + i * 1.5, 0.0f, -8.5f));
-                scaleMatrix = glm::scale(translateMatrix, glm::vec3(1.5f, 2.5f, 2.0f));
+            for (int i = 0; i < 12; i++) {
+                translateMatrix = glm::translate(identityMatrix, glm::vec3(0.0f + i * 1.5, 2.5f, -8.5f));
+                scaleMatrix = glm::scale(translateMatrix, glm::vec3(1.5f, 0.1f, 2.0f));
                 model = globalTranslationMatrix * scaleMatrix;
-                cube_kitchen_box.drawCubeWithTexture(lightingShaderWithTexture, model);
+                cube_white.drawCubeWithTexture(lightingShaderWithTexture, model);
+
+                if (i == 2 || i == 9) {
+                    translateMatrix = glm::translate(identityMatrix, glm::vec3(0.0f + i * 1.5, 0.0f, -8.5f));
+                    scaleMatrix = glm::scale(translateMatrix, glm::vec3(3.0f, 2.5f, 2.0f));
+                    model = globalTranslationMatrix * scaleMatrix;
+                    cube_oven.drawCubeWithTexture(lightingShaderWithTexture, model);
+                }
+                else if (i == 3 || i == 10);
+
+                else {
+                    translateMatrix = glm::translate(identityMatrix, glm::vec3(0.0f + i * 1.5, 0.0f, -8.5f));
+                    scaleMatrix = glm::scale(translateMatrix, glm::vec3(1.5f, 2.5f, 2.0f));
+                    model = globalTranslationMatrix * scaleMatrix;
+                    cube_kitchen_box.drawCubeWithTexture(lightingShaderWithTexture, model);
+                }
             }
-        }
-
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(18.0f, 2.6f, -8.5f));
-        scaleMatrix = glm::scale(translateMatrix, glm::vec3(0.1f, -2.6f, 2.0f));
-        model = globalTranslationMatrix * scaleMatrix;
-        cube_white.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(18.1f, 0.0f, -9.0f));
-        scaleMatrix = glm::scale(translateMatrix, glm::vec3(0.5f, 7.5f, 6.5f));
-        model = globalTranslationMatrix * scaleMatrix;
-        cube_tile2.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        // ************************************************************************ Kitchen Besin ************************************************************************
 
-        for (int i = 0; i < 1; i++) {
-            translateMatrix = glm::translate(identityMatrix, glm::vec3(0.9f, 2.3f, -3.0f));
-            glm::mat4 rotateMatrix = glm::rotate(translateMatrix, glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-            scaleMatrix = glm::scale(rotateMatrix, glm::vec3(0.45f, 1.5f, 0.3f));
-            model = globalTranslationMatrix * scaleMatrix;
-            cylinder_besin.drawPolygon(lightingShaderWithTexture, model);
-        }
-        for (int i = 0; i < 2; i++) {
-            translateMatrix = glm::translate(identityMatrix, glm::vec3(0.0f, 0.0f, -6.0f + i * 3));
-            scaleMatrix = glm::scale(translateMatrix, glm::vec3(1.5f, 2.0f, 3.0f));
+            translateMatrix = glm::translate(identityMatrix, glm::vec3(18.0f, 2.6f, -8.5f));
+            scaleMatrix = glm::scale(translateMatrix, glm::vec3(0.1f, -2.6f, 2.0f));
             model = globalTranslationMatrix * scaleMatrix;
-            cube_besin.drawCubeWithTexture(lightingShaderWithTexture, model);
-        }
-
-        // ************************************************************************ Stove ************************************************************************
+            cube_white.drawCubeWithTexture(lightingShaderWithTexture, model);
 
-        for (int i = 0; i < 2; i++) {
-            translateMatrix = glm::translate(identityMatrix, glm::vec3(6.5f + i * 3.5, 2.6f, -8.5f));
-            scaleMatrix = glm::scale(translateMatrix, glm::vec3(3.0f, 0.1f, 2.0f));
+            translateMatrix = glm::translate(identityMatrix, glm::vec3(18.1f, 0.0f, -9.0f));
+            scaleMatrix = glm::scale(translateMatrix, glm::vec3(0.5f, 7.5f, 6.5f));
             model = globalTranslationMatrix * scaleMatrix;
-            cube_stove.drawCubeWithTexture(lightingShaderWithTexture, model);
-        }
+            cube_tile2.drawCubeWithTexture(lightingShaderWithTexture, model);
 
-        // ************************************************************************ Lift ************************************************************************
+            // ************************************************************************ Kitchen Besin ************************************************************************
 
-        // Ceiling
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(18.0f, 12.0f, -12.3f));
-        scaleMatrix = glm::scale(translateMatrix, glm::vec3(5.0f, 0.2f, 3.5f));
-        model = globalTranslationMatrix * scaleMatrix;
-        ourShader.setMat4("model", model);
-        cube_floor.drawCubeWithTexture(lightingShaderWithTexture, model);
+            for (int i = 0; i < 1; i++) {
+                translateMatrix = glm::translate(identityMatrix, glm::vec3(0.9f, 2.3f, -3.0f));
+                glm::mat4 rotateMatrix = glm::rotate(translateMatrix, glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+                scaleMatrix = glm::scale(rotateMatrix, glm::vec3(0.45f, 1.5f, 0.3f));
+                model = globalTranslationMatrix * scaleMatrix;
+                cylinder_besin.drawPolygon(lightingShaderWithTexture, model);
+            }
+            for (int i = 0; i < 2; i++) {
+                translateMatrix = glm::translate(identityMatrix, glm::vec3(0.0f, 0.0f, -6.0f + i * 3));
+                scaleMatrix = glm::scale(translateMatrix, glm::vec3(1.5f, 2.0f, 3.0f));
+                model = globalTranslationMatrix * scaleMatrix;
+                cube_besin.drawCubeWithTexture(lightingShaderWithTexture, model);
+            }
 
-        // Floor
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(18.0f, 0.0f, -12.3f));
-        scaleMatrix = glm::scale(translateMatrix, glm::vec3(5.0f, -0.5f, 3.5f));
-        model = globalTranslationMatrix * scaleMatrix;
-        ourShader.setMat4("model", model);
-        cube_floor.drawCubeWithTexture(lightingShaderWithTexture, model);
+            // ************************************************************************ Stove ************************************************************************
 
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            for (int i = 0; i < 2; i++) {
+                translateMatrix = glm::translate(identityMatrix, glm::vec3(6.5f + i * 3.5, 2.6f, -8.5f));
+                scaleMatrix = glm::scale(translateMatrix, glm::vec3(3.0f, 0.1f, 2.0f));
+                model = globalTranslationMatrix * scaleMatrix;
+                cube_stove.drawCubeWithTexture(lightingShaderWithTexture, model);
+            }
 
-        if (liftMoveStill && liftMoveOff) {
-            t_lift_move = 0.0f;
+            // ************************************************************************ Lift ************************************************************************
 
-            glm::vec3 translation(22.5f, 0.0f, 11.0f);
-            glm::vec3 rotation(0.0f, 90.0f, 0.0f); // Rotation in degrees
-            glm::vec3 scale(1.0f, 1.0f, 1.0f);     // Uniform scaling
-
-            drawLift(globalTranslationMatrix, lightingShaderWithTexture, ourShader, cube_floor, cube_wall, translation, rotation, scale);
-        }
+            // Ceiling
+            translateMatrix = glm::translate(identityMatrix, glm::vec3(18.0f, 12.0f, -12.3f));
+            scaleMatrix = glm::scale(translateMatrix, glm::vec3(5.0f, 0.2f, 3.5f));
+            model = globalTranslationMatrix * scaleMatrix;
+            ourShader.setMat4("model", model);
+            cube_floor.drawCubeWithTexture(lightingShaderWithTexture, model);
 
-         if (!liftMoveStill && liftMoveOn) {
-            glm::vec3 translation(22.5f, 0.0f + t_lift_move, 11.0f);
-            glm::vec3 rotation(0.0f, 90.0f, 0.0f); // Rotation in degrees
-            glm::vec3 scale(1.0f, 1.0f, 1.0f);     // Uniform scaling
+            // Floor
+            translateMatrix = glm::translate(identityMatrix, glm::vec3(18.0f, 0.0f, -12.3f));
+            scaleMatrix = glm::scale(translateMatrix, glm::vec3(5.0f, -0.5f, 3.5f));
+            model = globalTranslationMatrix * scaleMatrix;
+            ourShader.setMat4("model", model);
+            cube_floor.drawCubeWithTexture(lightingShaderWithTexture, model);
 
-            drawLift(globalTranslationMatrix, lightingShaderWithTexture, ourShader, cube_floor, cube_wall, translation, rotation, scale);
+            // ************************************************************************ Box ************************************************************************
 
-            if (t_lift_move > 8.0f) {
-                liftMoveStill = true;
-            }
-            else {
-                t_lift_move += lift_move_speed;
-                liftMoveOn = true;
-                liftMoveOff = false;
+            for (int i = 0; i < 6; i++) {
+                translateMatrix = glm::translate(identityMatrix, glm::vec3(0.0f + i * 3, 0.0f, 0.5f));
+                scaleMatrix = glm::scale(translateMatrix, glm::vec3(3.0f, 2.5f, 2.0f));
+                model = globalTranslationMatrix * scaleMatrix;
+                cube_box.drawCubeWithTexture(lightingShaderWithTexture, model);
             }
-        }
 
-        else if (liftMoveStill && liftMoveOn) {
-            t_lift_move = 0.0f;
+            // ************************************************************************ Besin ************************************************************************
 
-            glm::vec3 translation(22.5f, 8.0f, 11.0f);
-            glm::vec3 rotation(0.0f, 90.0f, 0.0f); // Rotation in degrees
-            glm::vec3 scale(1.0f, 1.0f, 1.0f);     // Uniform scaling
-
-            drawLift(globalTranslationMatrix, lightingShaderWithTexture, ourShader, cube_floor, cube_wall, translation, rotation, scale);
-        }
-
-        else if (!liftMoveStill && liftMoveOff) {
-             glm::vec3 translation(22.5f, 8.0f - t_lift_move, 11.0f);
-             glm::vec3 rotation(0.0f, 90.0f, 0.0f); // Rotation in degrees
-             glm::vec3 scale(1.0f, 1.0f, 1.0f);     // Uniform scaling
+            glm::vec3 viewPos = glm::vec3(0.0f, 0.0f, 5.0f);
 
-             drawLift(globalTranslationMatrix, lightingShaderWithTexture, ourShader, cube_floor, cube_wall, translation, rotation, scale);
-
-            if (t_lift_move > 8.0) {
-                liftMoveStill = true;
+            for (int i = 0; i < 4; i++) {
+                translateMatrix = glm::translate(identityMatrix, glm::vec3(0.0f, 4.8f, 6.5f + i * 3));
+                glm::mat4 rotateMatrix = glm::rotate(translateMatrix, glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+                scaleMatrix = glm::scale(rotateMatrix, glm::vec3(1.75f, 1.75f, 0.1f));
+                model = globalTranslationMatrix * scaleMatrix;
+                cylinder_mirror.drawPolygonWithTexture(lightingShaderWithTexture, model);
             }
-            else {
-                t_lift_move += lift_move_speed;
-                liftMoveOn = false;
-                liftMoveOff = true;
+            for (int i = 0; i < 4; i++) {
+                translateMatrix = glm::translate(identityMatrix, glm::vec3(0.9f, 2.3f, 6.5f + i * 3));
+                glm::mat4 rotateMatrix = glm::rotate(translateMatrix, glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+                scaleMatrix = glm::scale(rotateMatrix, glm::vec3(0.45f, 0.45f, 0.3f));
+                model = globalTranslationMatrix * scaleMatrix;
+                cylinder_besin.drawPolygon(lightingShaderWithTexture, model);
+            }
+            for (int i = 0; i < 4; i++) {
+                translateMatrix = glm::translate(identityMatrix, glm::vec3(0.0f, 0.0f, 5.0f + i * 3));
+                scaleMatrix = glm::scale(translateMatrix, glm::vec3(1.5f, 2.0f, 3.0f));
+                model = globalTranslationMatrix * scaleMatrix;
+                cube_besin.drawCubeWithTexture(lightingShaderWithTexture, model);
             }
-        }
 
-        glDisable(GL_BLEND);
+            // ************************************************************************ Design ************************************************************************
 
-        // ************************************************************************ Box ************************************************************************
 
-        for (int i = 0; i < 6; i++) {
-            translateMatrix = glm::translate(identityMatrix, glm::vec3(0.0f + i * 3, 0.0f, 0.5f));
-            scaleMatrix = glm::scale(translateMatrix, glm::vec3(3.0f, 2.5f, 2.0f));
-            model = globalTranslationMatrix * scaleMatrix;
-            cube_box.drawCubeWithTexture(lightingShaderWithTexture, model);
-        }
+            for (int i = 0; i < 4; i++) {
+                translateMatrix = glm::translate(identityMatrix, glm::vec3(3.0f + 5 * i, 5.0f, 30.0f));
+                rotateMatrix = glm::rotate(translateMatrix, glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+                scaleMatrix = glm::scale(rotateMatrix, glm::vec3(0.65f, 0.65f, -0.1f));
+                model = globalTranslationMatrix * scaleMatrix;
+                cylinder_design1.drawPolygonWithTexture(lightingShaderWithTexture, model);
 
-        // ************************************************************************ Cone Chair ************************************************************************
+                translateMatrix = glm::translate(identityMatrix, glm::vec3(4.5f + 5 * i, 6.0f, 30.0f));
+                rotateMatrix = glm::rotate(translateMatrix, glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+                scaleMatrix = glm::scale(rotateMatrix, glm::vec3(0.55f, 0.55f, -0.1f));
+                model = globalTranslationMatrix * scaleMatrix;
+                cylinder_design2.drawPolygonWithTexture(lightingShaderWithTexture, model);
 
-        for (int i = 0; i < 6; i++) {
-            translateMatrix = glm::translate(identityMatrix, glm::vec3(2.0f + i * 2.7f, 0.0f, 4.5f));
-            scaleMatrix = glm::scale(translateMatrix, glm::vec3(0.7f, 0.7f, 0.7f));
-            model = globalTranslationMatrix * scaleMatrix;
-            cone_chair.drawConeWithTexture(lightingShaderWithTexture, model);
+                translateMatrix = glm::translate(identityMatrix, glm::vec3(5.8f + 5 * i, 5.2f, 30.0f));
+                rotateMatrix = glm::rotate(translateMatrix, glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+                scaleMatrix = glm::scale(rotateMatrix, glm::vec3(0.45f, 0.45f, -0.1f));
+                model = globalTranslationMatrix * scaleMatrix;
+                cylinder_design3.drawPolygonWithTexture(lightingShaderWithTexture, model);
 
-            translateMatrix = glm::translate(identityMatrix, glm::vec3(2.0f + i * 2.7f, 1.7f, 4.5f));
-            glm::mat4 rotateMatrix = glm::rotate(translateMatrix, glm::radians(180.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-            scaleMatrix = glm::scale(rotateMatrix, glm::vec3(0.7f, 0.7f, 0.7f));
-            model = globalTranslationMatrix * scaleMatrix;
-            cone_chair.drawConeWithTexture(lightingShaderWithTexture, model);
-        }
+                translateMatrix = glm::translate(identityMatrix, glm::vec3(5.3f + 5 * i, 4.0f, 30.0f));
+                rotateMatrix = glm::rotate(translateMatrix, glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+                scaleMatrix = glm::scale(rotateMatrix, glm::vec3(0.35f, 0.35f, -0.1f));
+                model = globalTranslationMatrix * scaleMatrix;
+                cylinder_design4.drawPolygonWithTexture(lightingShaderWithTexture, model);
 
-        // ************************************************************************ Besin ************************************************************************
+                translateMatrix = glm::translate(identityMatrix, glm::vec3(4.0f + 5 * i, 3.8f, 30.0f));
+                rotateMatrix = glm::rotate(translateMatrix, glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+                scaleMatrix = glm::scale(rotateMatrix, glm::vec3(0.25f, 0.25f, -0.1f));
+                model = globalTranslationMatrix * scaleMatrix;
+                cylinder_design5.drawPolygonWithTexture(lightingShaderWithTexture, model);
+            }
 
-        glm::vec3 viewPos = glm::vec3(0.0f, 0.0f, 5.0f);
+        
 
-        for (int i = 0; i < 4; i++) {
-            translateMatrix = glm::translate(identityMatrix, glm::vec3(0.0f, 4.8f, 6.5f + i * 3));
-            glm::mat4 rotateMatrix = glm::rotate(translateMatrix, glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-            scaleMatrix = glm::scale(rotateMatrix, glm::vec3(1.75f, 1.75f, 0.1f));
-            model = globalTranslationMatrix * scaleMatrix;
-            cylinder_mirror.drawPolygonWithTexture(lightingShaderWithTexture, model);
-        }
-        for (int i = 0; i < 4; i++) {
-            translateMatrix = glm::translate(identityMatrix, glm::vec3(0.9f, 2.3f, 6.5f + i * 3));
-            glm::mat4 rotateMatrix = glm::rotate(translateMatrix, glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-            scaleMatrix = glm::scale(rotateMatrix, glm::vec3(0.45f, 0.45f, 0.3f));
-            model = globalTranslationMatrix * scaleMatrix;
-            cylinder_besin.drawPolygon(lightingShaderWithTexture, model);
-        }
-        for (int i = 0; i < 4; i++) {
-            translateMatrix = glm::translate(identityMatrix, glm::vec3(0.0f, 0.0f, 5.0f + i * 3));
-            scaleMatrix = glm::scale(translateMatrix, glm::vec3(1.5f, 2.0f, 3.0f));
+            // ************************************************************************ Hexagon ************************************************************************
+        
+            translateMatrix = glm::translate(identityMatrix, glm::vec3(0.5f, 4.0f, 25.0f));
+            rotateMatrix = glm::rotate(translateMatrix, glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+            scaleMatrix = glm::scale(rotateMatrix, glm::vec3(1.8f, 1.8f, 0.1f));
             model = globalTranslationMatrix * scaleMatrix;
-            cube_besin.drawCubeWithTexture(lightingShaderWithTexture, model);
-        }
-
-        // ************************************************************************ Design ************************************************************************
+            hexagon_design1.drawPolygonWithTexture(lightingShaderWithTexture, model);
 
-
-        for (int i = 0; i < 4; i++) {
-            translateMatrix = glm::translate(identityMatrix, glm::vec3(3.0f + 5 * i, 5.0f, 30.0f));
-            rotateMatrix = glm::rotate(translateMatrix, glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-            scaleMatrix = glm::scale(rotateMatrix, glm::vec3(0.65f, 0.65f, -0.1f));
+            translateMatrix = glm::translate(identityMatrix, glm::vec3(0.5f, 2.6f, 22.25f));
+            rotateMatrix = glm::rotate(translateMatrix, glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+            scaleMatrix = glm::scale(rotateMatrix, glm::vec3(1.5f, 1.5f, 0.1f));
             model = globalTranslationMatrix * scaleMatrix;
-            cylinder_design1.drawPolygonWithTexture(lightingShaderWithTexture, model);
+            hexagon_design2.drawPolygonWithTexture(lightingShaderWithTexture, model);
 
-            translateMatrix = glm::translate(identityMatrix, glm::vec3(4.5f + 5 * i, 6.0f, 30.0f));
-            rotateMatrix = glm::rotate(translateMatrix, glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-            scaleMatrix = glm::scale(rotateMatrix, glm::vec3(0.55f, 0.55f, -0.1f));
+            translateMatrix = glm::translate(identityMatrix, glm::vec3(0.5f, 5.15f, 22.4f));
+            rotateMatrix = glm::rotate(translateMatrix, glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+            scaleMatrix = glm::scale(rotateMatrix, glm::vec3(1.2f, 1.2f, 0.1f));
             model = globalTranslationMatrix * scaleMatrix;
-            cylinder_design2.drawPolygonWithTexture(lightingShaderWithTexture, model);
+            hexagon_design3.drawPolygonWithTexture(lightingShaderWithTexture, model);
 
-            translateMatrix = glm::translate(identityMatrix, glm::vec3(5.8f + 5 * i, 5.2f, 30.0f));
-            rotateMatrix = glm::rotate(translateMatrix, glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-            scaleMatrix = glm::scale(rotateMatrix, glm::vec3(0.45f, 0.45f, -0.1f));
-            model = globalTranslationMatrix * scaleMatrix;
-            cylinder_design3.drawPolygonWithTexture(lightingShaderWithTexture, model);
+            // ************************************************************************ Chair ************************************************************************
 
-            translateMatrix = glm::translate(identityMatrix, glm::vec3(5.3f + 5 * i, 4.0f, 30.0f));
-            rotateMatrix = glm::rotate(translateMatrix, glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-            scaleMatrix = glm::scale(rotateMatrix, glm::vec3(0.35f, 0.35f, -0.1f));
-            model = globalTranslationMatrix * scaleMatrix;
-            cylinder_design4.drawPolygonWithTexture(lightingShaderWithTexture, model);
+            //1st set
+        
+            //chair
+            for (int i = 0; i < 4; i++) {
+                glm::vec3 translation(1.0f, 0.0f, 13.0 + i*4.4f);  // Translation for the chair
+                glm::vec3 rotation(0.0f, 90.0f, 0.0f);  // Rotation for the chair (pitch, yaw, roll in degrees)
+                staticScene.beginCluster(furnitureImpostors.addInstance(chairPrefab, furnitureTransform(identityMatrix, translation, rotation)));
+                drawChairWithTransformations(identityMatrix, globalTranslationMatrix, translation, rotation, lightingShaderWithTexture, lightingShaderWithTexture, cube_chair, cube_chair, viewPos);
+                staticScene.endCluster();
+            }
 
-            translateMatrix = glm::translate(identityMatrix, glm::vec3(4.0f + 5 * i, 3.8f, 30.0f));
-            rotateMatrix = glm::rotate(translateMatrix, glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-            scaleMatrix = glm::scale(rotateMatrix, glm::vec3(0.25f, 0.25f, -0.1f));
-            model = globalTranslationMatrix * scaleMatrix;
-            cylinder_design5.drawPolygonWithTexture(lightingShaderWithTexture, model);
-        }
+            //table
+            for (int i = 0; i < 4; i++) {
+                glm::vec3 translation(1.5f, 0.0f, 3.1f+i*4.4f);  // Translation for the table
+                glm::vec3 rotation(0.0f, 0.0f, 0.0f);  // Rotation for the table (pitch, yaw, roll in degrees)
+                staticScene.beginCluster(furnitureImpostors.addInstance(tablePrefab, furnitureTransform(identityMatrix, translation, rotation)));
+                drawTableWithTransformations(identityMatrix, globalTranslationMatrix, translation, rotation, lightingShaderWithTexture, ourShader, cube_table);
+                staticScene.endCluster();
+            }
 
-        
+            //chair
+            for (int i = 0; i < 4; i++) {
+                glm::vec3 translation(18.0f, 0.0f, 6.0 + i * 4.4f);  // Translation for the chair
+                glm::vec3 rotation(0.0f,-90.0f, 0.0f);  // Rotation for the chair (pitch, yaw, roll in degrees)
+                staticScene.beginCluster(furnitureImpostors.addInstance(chairPrefab, furnitureTransform(identityMatrix, translation, rotation)));
+                drawChairWithTransformations(identityMatrix, globalTranslationMatrix, translation, rotation, lightingShaderWithTexture, lightingShaderWithTexture, cube_chair, cube_chair, viewPos);
+                staticScene.endCluster();
+            }
 
-        // ************************************************************************ Hexagon ************************************************************************
-        
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(0.5f, 4.0f, 25.0f));
-        rotateMatrix = glm::rotate(translateMatrix, glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        scaleMatrix = glm::scale(rotateMatrix, glm::vec3(1.8f, 1.8f, 0.1f));
-        model = globalTranslationMatrix * scaleMatrix;
-        hexagon_design1.drawPolygonWithTexture(lightingShaderWithTexture, model);
 
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(0.5f, 2.6f, 22.25f));
-        rotateMatrix = glm::rotate(translateMatrix, glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        scaleMatrix = glm::scale(rotateMatrix, glm::vec3(1.5f, 1.5f, 0.1f));
-        model = globalTranslationMatrix * scaleMatrix;
-        hexagon_design2.drawPolygonWithTexture(lightingShaderWithTexture, model);
+            //2nd set
 
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(0.5f, 5.15f, 22.4f));
-        rotateMatrix = glm::rotate(translateMatrix, glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        scaleMatrix = glm::scale(rotateMatrix, glm::vec3(1.2f, 1.2f, 0.1f));
-        model = globalTranslationMatrix * scaleMatrix;
-        hexagon_design3.drawPolygonWithTexture(lightingShaderWithTexture, model);
+            //chair
+            for (int i = 0; i < 4; i++) {
+                glm::vec3 translation(8.0f, 0.0f, 13.0 + i * 4.4f);  // Translation for the chair
+                glm::vec3 rotation(0.0f, 90.0f, 0.0f);  // Rotation for the chair (pitch, yaw, roll in degrees)
+                staticScene.beginCluster(furnitureImpostors.addInstance(chairPrefab, furnitureTransform(identityMatrix, translation, rotation)));
+                drawChairWithTransformations(identityMatrix, globalTranslationMatrix, translation, rotation, lightingShaderWithTexture, lightingShaderWithTexture, cube_chair, cube_chair, viewPos);
+                staticScene.endCluster();
+            }
 
-        // ************************************************************************ Chair ************************************************************************
+            //table
+            for (int i = 0; i < 4; i++) {
+                glm::vec3 translation(8.5f, 0.0f, 3.1f + i * 4.4f);  // Translation for the table
+                glm::vec3 rotation(0.0f, 0.0f, 0.0f);  // Rotation for the table (pitch, yaw, roll in degrees)
+                staticScene.beginCluster(furnitureImpostors.addInstance(tablePrefab, furnitureTransform(identityMatrix, translation, rotation)));
+                drawTableWithTransformations(identityMatrix, globalTranslationMatrix, translation, rotation, lightingShaderWithTexture, ourShader, cube_table);
+                staticScene.endCluster();
+            }
 
-        //1st set
-        
-        //chair
-        for (int i = 0; i < 4; i++) {
-            glm::vec3 translation(1.0f, 0.0f, 13.0 + i*4.4f);  // Translation for the chair
-            glm::vec3 rotation(0.0f, 90.0f, 0.0f);  // Rotation for the chair (pitch, yaw, roll in degrees)
-            drawChairWithTransformations(identityMatrix, globalTranslationMatrix, translation, rotation, lightingShaderWithTexture, lightingShaderWithTexture, cube_chair, cube_chair, viewPos);
-        }
+            //chair
+            for (int i = 0; i < 4; i++) {
+                glm::vec3 translation(25.0, 0.0f, 6.0 + i * 4.4f);  // Translation for the chair
+                glm::vec3 rotation(0.0f, -90.0f, 0.0f);  // Rotation for the chair (pitch, yaw, roll in degrees)
+                staticScene.beginCluster(furnitureImpostors.addInstance(chairPrefab, furnitureTransform(identityMatrix, translation, rotation)));
+                drawChairWithTransformations(identityMatrix, globalTranslationMatrix, translation, rotation, lightingShaderWithTexture, lightingShaderWithTexture, cube_chair, cube_chair, viewPos);
+                staticScene.endCluster();
+            }
 
-        //table
-        for (int i = 0; i < 4; i++) {
-            glm::vec3 translation(1.5f, 0.0f, 3.1f+i*4.4f);  // Translation for the table
-            glm::vec3 rotation(0.0f, 0.0f, 0.0f);  // Rotation for the table (pitch, yaw, roll in degrees)
-            drawTableWithTransformations(identityMatrix, globalTranslationMatrix, translation, rotation, lightingShaderWithTexture, ourShader, cube_table);
-        }
+            //sofa
+            for (int i = 0; i < 3; i++) {
+                glm::vec3 sofaTranslation(-8.0f + i*5.5f, 0.0f, 22.5f);  // Translation for the sofa
+                glm::vec3 sofaRotation(0.0f, 0.0f, 0.0f);  // Rotation for the sofa (pitch, yaw, roll in degrees)
+                staticScene.beginCluster(furnitureImpostors.addInstance(sofaPrefab, furnitureTransform(identityMatrix, sofaTranslation, sofaRotation)));
+                drawSofaWithTransformations(identityMatrix, globalTranslationMatrix, sofaTranslation, sofaRotation, lightingShaderWithTexture, ourShader, cube_floor, cube_sofa);
+                staticScene.endCluster();
+            }
 
-        //chair
-        for (int i = 0; i < 4; i++) {
-            glm::vec3 translation(18.0f, 0.0f, 6.0 + i * 4.4f);  // Translation for the chair
-            glm::vec3 rotation(0.0f,-90.0f, 0.0f);  // Rotation for the chair (pitch, yaw, roll in degrees)
-            drawChairWithTransformations(identityMatrix, globalTranslationMatrix, translation, rotation, lightingShaderWithTexture, lightingShaderWithTexture, cube_chair, cube_chair, viewPos);
-        }
+            for (int j = 0; j < 3; j++) {
+                // theater sofa
+                for (int i = 0; i < 3; i++) {
+                    glm::vec3 sofaTranslation(1.5f + 3.5f * j, 8.0f + 0.5 * j, 16.0f + i * 4.5);  // Translation for the sofa
+                    glm::vec3 sofaRotation(0.0f, 90.0f, 0.0f);  // Rotation for the sofa (pitch, yaw, roll in degrees)
+                    staticScene.beginCluster(furnitureImpostors.addInstance(sofaPrefab, furnitureTransform(identityMatrix, sofaTranslation, sofaRotation)));
+                    drawSofaWithTransformations(identityMatrix, globalTranslationMatrix, sofaTranslation, sofaRotation, lightingShaderWithTexture, ourShader, cube_floor, cube_sofa);
+                    staticScene.endCluster();
+                }
+
+                for (int i = 0; i < 2; i++) {
+                    glm::vec3 sofaTranslation(1.5f + 3.5 * j, 8.0f + 0.5 * j, 34.0f + i * 4.5);  // Translation for the sofa
+                    glm::vec3 sofaRotation(0.0f, 90.0f, 0.0f);  // Rotation for the sofa (pitch, yaw, roll in degrees)
+                    staticScene.beginCluster(furnitureImpostors.addInstance(sofaPrefab, furnitureTransform(identityMatrix, sofaTranslation, sofaRotation)));
+                    drawSofaWithTransformations(identityMatrix, globalTranslationMatrix, sofaTranslation, sofaRotation, lightingShaderWithTexture, ourShader, cube_floor, cube_sofa);
+                    staticScene.endCluster();
+                }
+            }
 
+            // ************************************************************************************************************************************************
+
+            // ************************************************************************ Star Light ************************************************************************
+
+            for (int j = 0; j < 6; j++) {
+                for (int i = 0; i < 4; i++) {
+                    int ang;
+                    if (i % 2 == 0) ang = 0;
+                    else ang = 45;
+
+                    translateMatrix = glm::translate(identityMatrix, glm::vec3(1.5f + 3 * j, 6.8f - i * 0.7, 2.0f));
+                    rotateMatrix = glm::rotate(translateMatrix, glm::radians(0.0f + ang), glm::vec3(0.0f, 0.0f, 1.0f));
+                    scaleMatrix = glm::scale(rotateMatrix, glm::vec3(0.25f, 0.25, 0.10f));
+                    model = globalTranslationMatrix * scaleMatrix;
+                    polygon_star1.drawLightPolygon(ourShader, model, glm::vec3(1.0f, 1.0f, 1.0f));
+
+                    translateMatrix = glm::translate(identityMatrix, glm::vec3(1.5f + 3 * j, 6.8f - i * 0.7, 2.0f));
+                    rotateMatrix = glm::rotate(translateMatrix, glm::radians(180.0f + ang), glm::vec3(0.0f, 0.0f, 1.0f));
+                    scaleMatrix = glm::scale(rotateMatrix, glm::vec3(0.25f, 0.25, 0.10f));
+                    model = globalTranslationMatrix * scaleMatrix;
+                    polygon_star1.drawLightPolygon(ourShader, model, glm::vec3(1.0f, 1.0f, 1.0f));
+                }
+
+                for (int i = 0; i < 3; i++) {
+                    int ang;
+                    if (i % 2 == 0) ang = 0;
+                    else ang = 45;
+
+                    translateMatrix = glm::translate(identityMatrix, glm::vec3(3.0f + 3 * j, 6.7f - i * 0.9, 2.0f));
+                    rotateMatrix = glm::rotate(translateMatrix, glm::radians(0.0f + ang), glm::vec3(0.0f, 0.0f, 1.0f));
+                    scaleMatrix = glm::scale(rotateMatrix, glm::vec3(0.30f, 0.30, 0.10f));
+                    model = globalTranslationMatrix * scaleMatrix;
+                    polygon_star2.drawLightPolygon(ourShader, model, glm::vec3(1.0f, 0.0f, 0.0f));
+
+                    translateMatrix = glm::translate(identityMatrix, glm::vec3(3.0f + 3 * j, 6.7f - i * 0.9, 2.0f));
+                    rotateMatrix = glm::rotate(translateMatrix, glm::radians(45.0f + ang), glm::vec3(0.0f, 0.0f, 1.0f));
+                    scaleMatrix = glm::scale(rotateMatrix, glm::vec3(0.30f, 0.30, 0.10f));
+                    model = globalTranslationMatrix * scaleMatrix;
+                    polygon_star2.drawLightPolygon(ourShader, model, glm::vec3(1.0f, 0.0f, 0.0f));
+                }
+            }
 
-        //2nd set
+            // ************************************************************************ Light ************************************************************************
 
-        //chair
-        for (int i = 0; i < 4; i++) {
-            glm::vec3 translation(8.0f, 0.0f, 13.0 + i * 4.4f);  // Translation for the chair
-            glm::vec3 rotation(0.0f, 90.0f, 0.0f);  // Rotation for the chair (pitch, yaw, roll in degrees)
-            drawChairWithTransformations(identityMatrix, globalTranslationMatrix, translation, rotation, lightingShaderWithTexture, lightingShaderWithTexture, cube_chair, cube_chair, viewPos);
-        }
+            // ************************************************************************ Wall Light ************************************************************************
 
-        //table
-        for (int i = 0; i < 4; i++) {
-            glm::vec3 translation(8.5f, 0.0f, 3.1f + i * 4.4f);  // Translation for the table
-            glm::vec3 rotation(0.0f, 0.0f, 0.0f);  // Rotation for the table (pitch, yaw, roll in degrees)
-            drawTableWithTransformations(identityMatrix, globalTranslationMatrix, translation, rotation, lightingShaderWithTexture, ourShader, cube_table);
-        }
+            for (int i = 0; i < 4; i++) {
+                translateMatrix = glm::translate(identityMatrix, glm::vec3(4.5f + 5*i, 4.8f, 30.0f));
+                //rotateMatrix = glm::rotate(translateMatrix, glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+                scaleMatrix = glm::scale(translateMatrix, glm::vec3(0.4f, -0.4f, -0.1f));
+                model = globalTranslationMatrix * scaleMatrix;
+                cylinder_design5.drawLightPolygon(ourShader, model, glm::vec3(1.0f, 1.0f, 1.0f));
+            }
 
-        //chair
-        for (int i = 0; i < 4; i++) {
-            glm::vec3 translation(25.0, 0.0f, 6.0 + i * 4.4f);  // Translation for the chair
-            glm::vec3 rotation(0.0f, -90.0f, 0.0f);  // Rotation for the chair (pitch, yaw, roll in degrees)
-            drawChairWithTransformations(identityMatrix, globalTranslationMatrix, translation, rotation, lightingShaderWithTexture, lightingShaderWithTexture, cube_chair, cube_chair, viewPos);
-        }
+            // ************************************************************************ Table Light ************************************************************************
 
-        //sofa
-        for (int i = 0; i < 3; i++) {
-            glm::vec3 sofaTranslation(-8.0f + i*5.5f, 0.0f, 22.5f);  // Translation for the sofa
-            glm::vec3 sofaRotation(0.0f, 0.0f, 0.0f);  // Rotation for the sofa (pitch, yaw, roll in degrees)
-            drawSofaWithTransformations(identityMatrix, globalTranslationMatrix, sofaTranslation, sofaRotation, lightingShaderWithTexture, ourShader, cube_floor, cube_sofa);
-        }
+            for (int j = 0; j < 3; j++) {
+                for (int i = 0; i < 6; i++) {
+                    translateMatrix = glm::translate(identityMatrix, glm::vec3(1.5f + i * 4.0f, 5.0f, 8.0f + 8.0f * j));
+                    rotateMatrix = glm::rotate(translateMatrix, glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+                    scaleMatrix = glm::scale(rotateMatrix, glm::vec3(0.425f, 0.425, -1.7f));
+                    model = globalTranslationMatrix * scaleMatrix;
+                    cylinder_design5.drawLightPolygon(ourShader, model, glm::vec3(1.0f, 1.0f, 1.0f));
+                }
+            }
+            for (int i = 0; i < 6; i++) {
+                translateMatrix = glm::translate(identityMatrix, glm::vec3(1.5f + i * 4.0f, 5.0f, -5.0f));
+                rotateMatrix = glm::rotate(translateMatrix, glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+                scaleMatrix = glm::scale(rotateMatrix, glm::vec3(0.425f, 0.425, -1.7f));
+                model = globalTranslationMatrix * scaleMatrix;
+                cylinder_design5.drawLightPolygon(ourShader, model, glm::vec3(1.0f, 1.0f, 0.0f));
+            }
 
-        for (int j = 0; j < 3; j++) {
-            // theater sofa
-            for (int i = 0; i < 3; i++) {
-                glm::vec3 sofaTranslation(1.5f + 3.5f * j, 8.0f + 0.5 * j, 16.0f + i * 4.5);  // Translation for the sofa
-                glm::vec3 sofaRotation(0.0f, 90.0f, 0.0f);  // Rotation for the sofa (pitch, yaw, roll in degrees)
-                drawSofaWithTransformations(identityMatrix, globalTranslationMatrix, sofaTranslation, sofaRotation, lightingShaderWithTexture, ourShader, cube_floor, cube_sofa);
+            // ************************************************************************ Light ************************************************************************
+
+            float outerRadius = 0.50f;   // Outer radius of the torus
+            float innerRadius = 0.25f;   // Inner radius of the torus
+            int numOuterSegments = 72;  // Number of segments around the outer circle
+            int numInnerSegments = 36;  // Number of segments for the "ring"
+
+            // Outer loop for the circular path
+            for (int i = 0; i < numOuterSegments; ++i) {
+                float outerAngle = glm::radians(i * (360.0f / numOuterSegments)); // Outer angle in radians
+                float centerX = outerRadius * cos(outerAngle); // x-coordinate of the current ring center
+                float centerZ = outerRadius * sin(outerAngle); // z-coordinate of the current ring center
+
+                // Inner loop for positioning the VAOs in a smaller circle at each outer point
+                for (int j = 0; j < numInnerSegments; ++j) {
+                    float innerAngle = glm::radians(j * (360.0f / numInnerSegments)); // Inner angle in radians
+                    float x = centerX + innerRadius * cos(innerAngle) * cos(outerAngle);
+                    float y = 14 + innerRadius * sin(innerAngle); // Move up/down for the inner ring
+                    float z = 4 + centerZ + innerRadius * cos(innerAngle) * sin(outerAngle);
+
+                    // Translate and scale for each VAO
+                    translateMatrix = glm::translate(identityMatrix, glm::vec3(x + 2, y + 2.89, z));
+                    scaleMatrix = glm::scale(translateMatrix, glm::vec3(0.05f, 0.05f, 0.05f)); // Adjust scale for smoothness
+                    model = globalTranslationMatrix * scaleMatrix;
+                    ourShader.setMat4("model", model);
+                    cylinder_design5.drawLightPolygon(ourShader, model, glm::vec3(1.0f, 1.0f, 1.0f));
+                }
             }
 
-            for (int i = 0; i < 2; i++) {
-                glm::vec3 sofaTranslation(1.5f + 3.5 * j, 8.0f + 0.5 * j, 34.0f + i * 4.5);  // Translation for the sofa
-                glm::vec3 sofaRotation(0.0f, 90.0f, 0.0f);  // Rotation for the sofa (pitch, yaw, roll in degrees)
-                drawSofaWithTransformations(identityMatrix, globalTranslationMatrix, sofaTranslation, sofaRotation, lightingShaderWithTexture, ourShader, cube_floor, cube_sofa);
+            // Outer loop for the circular path
+            for (int i = 0; i < numOuterSegments; ++i) {
+                float outerAngle = glm::radians(i * (360.0f / numOuterSegments)); // Outer angle in radians
+                float centerX = outerRadius * cos(outerAngle); // x-coordinate of the current ring center
+                float centerZ = outerRadius * sin(outerAngle); // z-coordinate of the current ring center
+
+                // Inner loop for positioning the VAOs in a smaller circle at each outer point
+                for (int j = 0; j < numInnerSegments; ++j) {
+                    float innerAngle = glm::radians(j * (360.0f / numInnerSegments)); // Inner angle in radians
+                    float x = centerX + innerRadius * cos(innerAngle) * cos(outerAngle);
+                    float y = 14 + innerRadius * sin(innerAngle); // Move up/down for the inner ring
+                    float z = 27 + centerZ + innerRadius * cos(innerAngle) * sin(outerAngle);
+
+                    // Translate and scale for each VAO
+                    translateMatrix = glm::translate(identityMatrix, glm::vec3(x + 2, y + 2.89, z));
+                    scaleMatrix = glm::scale(translateMatrix, glm::vec3(0.05f, 0.05f, 0.05f)); // Adjust scale for smoothness
+                    model = globalTranslationMatrix * scaleMatrix;
+                    ourShader.setMat4("model", model);
+                    cylinder_design5.drawLightPolygon(ourShader, model, glm::vec3(1.0f, 1.0f, 1.0f));
+                }
             }
-        }
 
-        // ************************************************************************************************************************************************
+            // ************************************************************************ Theater Boundary ************************************************************************
 
-        // also draw the lamp object(s)
-        ourShader.use();
-        ourShader.setMat4("projection", projection);
-        ourShader.setMat4("view", view);
+            for (int i = 0; i < 20; i++) {
+                if (i < 16 || i == 19) {
+                    // Right Wall
+                    translateMatrix = glm::translate(identityMatrix, glm::vec3(0.0f + i * 1.15, 8.0f, 0.0f));
+                    scaleMatrix = glm::scale(translateMatrix, glm::vec3(0.575f, 10.5f, 0.5f));
+                    model = globalTranslationMatrix * scaleMatrix;
+                    cube_wall.drawCubeWithTexture(lightingShaderWithTexture, model);
+                }
 
-        // ************************************************************************ Star Light ************************************************************************
+                //Left Wall
+                translateMatrix = glm::translate(identityMatrix, glm::vec3(0.0f+i*1.15, 8.0f, 30.0f));
+                scaleMatrix = glm::scale(translateMatrix, glm::vec3(0.575f, 10.5f, 0.5f));
+                model = globalTranslationMatrix * scaleMatrix;
+                cube_wall.drawCubeWithTexture(lightingShaderWithTexture, model);
+            }
 
-        for (int j = 0; j < 6; j++) {
-            for (int i = 0; i < 4; i++) {
-                int ang;
-                if (i % 2 == 0) ang = 0;
-                else ang = 45;
+            //Back Wall
+            translateMatrix = glm::translate(identityMatrix, glm::vec3(0.0f, 8.0f, 0.0f));
+            scaleMatrix = glm::scale(translateMatrix, glm::vec3(-0.5f, 9.5f, 30.0f));
+            model = globalTranslationMatrix * scaleMatrix;
+            cube_wall.drawCubeWithTexture(lightingShaderWithTexture, model);
 
-                translateMatrix = glm::translate(identityMatrix, glm::vec3(1.5f + 3 * j, 6.8f - i * 0.7, 2.0f));
-                rotateMatrix = glm::rotate(translateMatrix, glm::radians(0.0f + ang), glm::vec3(0.0f, 0.0f, 1.0f));
-                scaleMatrix = glm::scale(rotateMatrix, glm::vec3(0.25f, 0.25, 0.10f));
-                model = globalTranslationMatrix * scaleMatrix;
-                polygon_star1.drawLightPolygon(ourShader, model, glm::vec3(1.0f, 1.0f, 1.0f));
 
-                translateMatrix = glm::translate(identityMatrix, glm::vec3(1.5f + 3 * j, 6.8f - i * 0.7, 2.0f));
-                rotateMatrix = glm::rotate(translateMatrix, glm::radians(180.0f + ang), glm::vec3(0.0f, 0.0f, 1.0f));
-                scaleMatrix = glm::scale(rotateMatrix, glm::vec3(0.25f, 0.25, 0.10f));
-                model = globalTranslationMatrix * scaleMatrix;
-                polygon_star1.drawLightPolygon(ourShader, model, glm::vec3(1.0f, 1.0f, 1.0f));
-            }
 
-            for (int i = 0; i < 3; i++) {
-                int ang;
-                if (i % 2 == 0) ang = 0;
-                else ang = 45;
+            translateMatrix = glm::translate(identityMatrix, glm::vec3(0.1f, 9.5f, 7.0f));
+            scaleMatrix = glm::scale(translateMatrix, glm::vec3(0.1f, 7.0f, 16.0f));
+            model = globalTranslationMatrix * scaleMatrix;
+            cube_tv.drawLightCube(ourShader, model, glm::vec3(0.0f, 0.0f, 0.0f));
 
-                translateMatrix = glm::translate(identityMatrix, glm::vec3(3.0f + 3 * j, 6.7f - i * 0.9, 2.0f));
-                rotateMatrix = glm::rotate(translateMatrix, glm::radians(0.0f + ang), glm::vec3(0.0f, 0.0f, 1.0f));
-                scaleMatrix = glm::scale(rotateMatrix, glm::vec3(0.30f, 0.30, 0.10f));
+            for (int i = 0; i < 2; i++) {
+                // Theater floar - 1
+                translateMatrix = glm::translate(identityMatrix, glm::vec3(9.0f + 3.5f*i, 8.0f, 0.5));
+                scaleMatrix = glm::scale(translateMatrix, glm::vec3(3.5f, 0.5f + 0.5*i, 29.5f));
                 model = globalTranslationMatrix * scaleMatrix;
-                polygon_star2.drawLightPolygon(ourShader, model, glm::vec3(1.0f, 0.0f, 0.0f));
+                ourShader.setMat4("model", model);
+                cube_theater_floor.drawCubeWithTexture(lightingShaderWithTexture, model);
+            }
 
-                translateMatrix = glm::translate(identityMatrix, glm::vec3(3.0f + 3 * j, 6.7f - i * 0.9, 2.0f));
-                rotateMatrix = glm::rotate(translateMatrix, glm::radians(45.0f + ang), glm::vec3(0.0f, 0.0f, 1.0f));
-                scaleMatrix = glm::scale(rotateMatrix, glm::vec3(0.30f, 0.30, 0.10f));
+            for (int i = 0; i < 4; i++) {
+                // Theater floar - 2
+                translateMatrix = glm::translate(identityMatrix, glm::vec3(16.0f + 0.7f * i, 8.0f, 0.5));
+                scaleMatrix = glm::scale(translateMatrix, glm::vec3(0.7, 1.0f - 0.25 * i, 29.5f));
                 model = globalTranslationMatrix * scaleMatrix;
-                polygon_star2.drawLightPolygon(ourShader, model, glm::vec3(1.0f, 0.0f, 0.0f));
+                ourShader.setMat4("model", model);
+                cube_theater_floor.drawCubeWithTexture(lightingShaderWithTexture, model);
             }
+
+            // Ceiling
+            translateMatrix = glm::translate(identityMatrix, glm::vec3(-0.5f, 17.5f, 0.0f));
+            scaleMatrix = glm::scale(translateMatrix, glm::vec3(23.5f, 0.5f, 30.5f));
+            model = globalTranslationMatrix * scaleMatrix;
+            ourShader.setMat4("model", model);
+            cube_floor.drawCubeWithTexture(lightingShaderWithTexture, model);
+
+            staticScene.endRecording();
+            TextureResidency::shared().setSceneUses(staticScene.getTextureUses());
+            GeometryArena::shared().printStats();
         }
 
-        // ************************************************************************ Light ************************************************************************
+        staticScene.cull(staticSceneCullShader, projection * view, globalTranslationMatrix, camera.Position);
+        staticScene.draw(staticSceneShader, staticSceneFlatShader, globalTranslationMatrix);
+        staticScene.drawProcedural(proceduralSceneShader, proceduralSceneFlatShader, globalTranslationMatrix);
+        furnitureImpostors.draw(impostorShader, globalTranslationMatrix, camera.Position);
 
-        // ************************************************************************ Wall Light ************************************************************************
+        // ************************************************************************ Cone Chair ************************************************************************
+
+        for (int i = 0; i < 6; i++) {
+            translateMatrix = glm::translate(identityMatrix, glm::vec3(2.0f + i * 2.7f, 0.0f, 4.5f));
+            scaleMatrix = glm::scale(translateMatrix, glm::vec3(0.7f, 0.7f, 0.7f));
+            model = globalTranslationMatrix * scaleMatrix;
+            cone_chair.drawConeWithTexture(lightingShaderWithTexture, model);
 
-        for (int i = 0; i < 4; i++) {
-            translateMatrix = glm::translate(identityMatrix, glm::vec3(4.5f + 5*i, 4.8f, 30.0f));
-            //rotateMatrix = glm::rotate(translateMatrix, glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-            scaleMatrix = glm::scale(translateMatrix, glm::vec3(0.4f, -0.4f, -0.1f));
+            translateMatrix = glm::translate(identityMatrix, glm::vec3(2.0f + i * 2.7f, 1.7f, 4.5f));
+            glm::mat4 rotateMatrix = glm::rotate(translateMatrix, glm::radians(180.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+            scaleMatrix = glm::scale(rotateMatrix, glm::vec3(0.7f, 0.7f, 0.7f));
             model = globalTranslationMatrix * scaleMatrix;
-            cylinder_design5.drawLightPolygon(ourShader, model, glm::vec3(1.0f, 1.0f, 1.0f));
+            cone_chair.drawConeWithTexture(lightingShaderWithTexture, model);
         }
 
         // ************************************************************************ Room Corner Light ************************************************************************
 
         for (int i = 0; i < 2; i++) {
-            glBindVertexArray(lightCubeVAO);
             translateMatrix = glm::translate(identityMatrix, glm::vec3(0.0f, 0.0f, 29.75f - i*38.25f));
             scaleMatrix = glm::scale(translateMatrix, glm::vec3(0.5f, 15.0f, 0.5f));
             model = globalTranslationMatrix * scaleMatrix;
             ourShader.setMat4("model", model);
             ourShader.setVec3("color", glm::vec3(0.8f, 0.8f, 0.8f));
-            glDrawElements(GL_TRIANGLES, 5000, GL_UNSIGNED_INT, 0);
+            GeometryArena::shared().drawMesh(cubeMesh);
         }
 
         for (int i = 0; i < 2; i++) {
-            glBindVertexArray(lightCubeVAO);
             if (i == 1) {
                 translateMatrix = glm::translate(identityMatrix, glm::vec3(22.25f, 0.0f, 29.75f - i * 38.25f));
             }
@@ -1778,120 +1833,18 @@ int main()
             model = globalTranslationMatrix * scaleMatrix;
             ourShader.setMat4("model", model);
             ourShader.setVec3("color", glm::vec3(0.8f, 0.8f, 0.8f));
-            glDrawElements(GL_TRIANGLES, 5000, GL_UNSIGNED_INT, 0);
+            GeometryArena::shared().drawMesh(cubeMesh);
         }
 
         for (int i = 0; i < 2; i++) {
-            glBindVertexArray(lightCubeVAO);
             translateMatrix = glm::translate(identityMatrix, glm::vec3(0.0f, 7.5f, 29.75f - i * 38.25f));
             scaleMatrix = glm::scale(translateMatrix, glm::vec3(46.0f, -0.5f, 0.5f));
             model = globalTranslationMatrix * scaleMatrix;
             ourShader.setMat4("model", model);
             ourShader.setVec3("color", glm::vec3(0.8f, 0.8f, 0.8f));
-            glDrawElements(GL_TRIANGLES, 5000, GL_UNSIGNED_INT, 0);
+            GeometryArena::shared().drawMesh(cubeMesh);
         }
 
-        // ************************************************************************ Table Light ************************************************************************
-
-        for (int j = 0; j < 3; j++) {
-            for (int i = 0; i < 6; i++) {
-                translateMatrix = glm::translate(identityMatrix, glm::vec3(1.5f + i * 4.0f, 5.0f, 8.0f + 8.0f * j));
-                rotateMatrix = glm::rotate(translateMatrix, glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-                scaleMatrix = glm::scale(rotateMatrix, glm::vec3(0.425f, 0.425, -1.7f));
-                model = globalTranslationMatrix * scaleMatrix;
-                cylinder_design5.drawLightPolygon(ourShader, model, glm::vec3(1.0f, 1.0f, 1.0f));
-            }
-        }
-        for (int i = 0; i < 6; i++) {
-            translateMatrix = glm::translate(identityMatrix, glm::vec3(1.5f + i * 4.0f, 5.0f, -5.0f));
-            rotateMatrix = glm::rotate(translateMatrix, glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-            scaleMatrix = glm::scale(rotateMatrix, glm::vec3(0.425f, 0.425, -1.7f));
-            model = globalTranslationMatrix * scaleMatrix;
-            cylinder_design5.drawLightPolygon(ourShader, model, glm::vec3(1.0f, 1.0f, 0.0f));
-        }
-
-        // ************************************************************************ Light ************************************************************************
-
-        float outerRadius = 0.50f;   // Outer radius of the torus
-        float innerRadius = 0.25f;   // Inner radius of the torus
-        int numOuterSegments = 72;  // Number of segments around the outer circle
-        int numInnerSegments = 36;  // Number of segments for the "ring"
-
-        // Outer loop for the circular path
-        for (int i = 0; i < numOuterSegments; ++i) {
-            float outerAngle = glm::radians(i * (360.0f / numOuterSegments)); // Outer angle in radians
-            float centerX = outerRadius * cos(outerAngle); // x-coordinate of the current ring center
-            float centerZ = outerRadius * sin(outerAngle); // z-coordinate of the current ring center
-
-            // Inner loop for positioning the VAOs in a smaller circle at each outer point
-            for (int j = 0; j < numInnerSegments; ++j) {
-                float innerAngle = glm::radians(j * (360.0f / numInnerSegments)); // Inner angle in radians
-                float x = centerX + innerRadius * cos(innerAngle) * cos(outerAngle);
-                float y = 14 + innerRadius * sin(innerAngle); // Move up/down for the inner ring
-                float z = 4 + centerZ + innerRadius * cos(innerAngle) * sin(outerAngle);
-
-                // Translate and scale for each VAO
-                translateMatrix = glm::translate(identityMatrix, glm::vec3(x + 2, y + 2.89, z));
-                scaleMatrix = glm::scale(translateMatrix, glm::vec3(0.05f, 0.05f, 0.05f)); // Adjust scale for smoothness
-                model = globalTranslationMatrix * scaleMatrix;
-                ourShader.setMat4("model", model);
-                cylinder_design5.drawLightPolygon(ourShader, model, glm::vec3(1.0f, 1.0f, 1.0f));
-            }
-        }
-
-        // Outer loop for the circular path
-        for (int i = 0; i < numOuterSegments; ++i) {
-            float outerAngle = glm::radians(i * (360.0f / numOuterSegments)); // Outer angle in radians
-            float centerX = outerRadius * cos(outerAngle); // x-coordinate of the current ring center
-            float centerZ = outerRadius * sin(outerAngle); // z-coordinate of the current ring center
-
-            // Inner loop for positioning the VAOs in a smaller circle at each outer point
-            for (int j = 0; j < numInnerSegments; ++j) {
-                float innerAngle = glm::radians(j * (360.0f / numInnerSegments)); // Inner angle in radians
-                float x = centerX + innerRadius * cos(innerAngle) * cos(outerAngle);
-                float y = 14 + innerRadius * sin(innerAngle); // Move up/down for the inner ring
-                float z = 27 + centerZ + innerRadius * cos(innerAngle) * sin(outerAngle);
-
-                // Translate and scale for each VAO
-                translateMatrix = glm::translate(identityMatrix, glm::vec3(x + 2, y + 2.89, z));
-                scaleMatrix = glm::scale(translateMatrix, glm::vec3(0.05f, 0.05f, 0.05f)); // Adjust scale for smoothness
-                model = globalTranslationMatrix * scaleMatrix;
-                ourShader.setMat4("model", model);
-                cylinder_design5.drawLightPolygon(ourShader, model, glm::vec3(1.0f, 1.0f, 1.0f));
-            }
-        }
-
-        // ************************************************************************ Theater Boundary ************************************************************************
-
-        for (int i = 0; i < 20; i++) {
-            if (i < 16 || i == 19) {
-                // Right Wall
-                translateMatrix = glm::translate(identityMatrix, glm::vec3(0.0f + i * 1.15, 8.0f, 0.0f));
-                scaleMatrix = glm::scale(translateMatrix, glm::vec3(0.575f, 10.5f, 0.5f));
-                model = globalTranslationMatrix * scaleMatrix;
-                cube_wall.drawCubeWithTexture(lightingShaderWithTexture, model);
-            }
-
-            //Left Wall
-            translateMatrix = glm::translate(identityMatrix, glm::vec3(0.0f+i*1.15, 8.0f, 30.0f));
-            scaleMatrix = glm::scale(translateMatrix, glm::vec3(0.575f, 10.5f, 0.5f));
-            model = globalTranslationMatrix * scaleMatrix;
-            cube_wall.drawCubeWithTexture(lightingShaderWithTexture, model);
-        }
-
-        //Back Wall
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(0.0f, 8.0f, 0.0f));
-        scaleMatrix = glm::scale(translateMatrix, glm::vec3(-0.5f, 9.5f, 30.0f));
-        model = globalTranslationMatrix * scaleMatrix;
-        cube_wall.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-
-
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(0.1f, 9.5f, 7.0f));
-        scaleMatrix = glm::scale(translateMatrix, glm::vec3(0.1f, 7.0f, 16.0f));
-        model = globalTranslationMatrix * scaleMatrix;
-        cube_tv.drawLightCube(ourShader, model, glm::vec3(0.0f, 0.0f, 0.0f));
-
         if (tvOn) {
             translateMatrix = glm::translate(identityMatrix, glm::vec3(0.2f, 10.0f, 7.5f));
             scaleMatrix = glm::scale(translateMatrix, glm::vec3(0.1f, 6.0f, 15.0f));
@@ -1996,30 +1949,75 @@ int main()
             cube_wall.drawLightCube(ourShader, model, glm::vec3(1.0f, 1.0f, 1.0f));
         }
 
-        for (int i = 0; i < 2; i++) {
-            // Theater floar - 1
-            translateMatrix = glm::translate(identityMatrix, glm::vec3(9.0f + 3.5f*i, 8.0f, 0.5));
-            scaleMatrix = glm::scale(translateMatrix, glm::vec3(3.5f, 0.5f + 0.5*i, 29.5f));
-            model = globalTranslationMatrix * scaleMatrix;
-            ourShader.setMat4("model", model);
-            cube_theater_floor.drawCubeWithTexture(lightingShaderWithTexture, model);
+        // mip feedback once the opaque draws are in the depth buffer and
+        // before the translucent ones, which write depth too
+        if (recordMipFeedback) {
+            MipFeedback::shared().begin();
+            staticScene.draw(mipFeedbackShader, mipFeedbackShader, globalTranslationMatrix, true);
+            staticScene.drawProcedural(mipFeedbackProceduralShader, mipFeedbackProceduralShader, globalTranslationMatrix, true);
+            MipFeedback::shared().end();
         }
 
-        for (int i = 0; i < 4; i++) {
-            // Theater floar - 2
-            translateMatrix = glm::translate(identityMatrix, glm::vec3(16.0f + 0.7f * i, 8.0f, 0.5));
-            scaleMatrix = glm::scale(translateMatrix, glm::vec3(0.7, 1.0f - 0.25 * i, 29.5f));
-            model = globalTranslationMatrix * scaleMatrix;
-            ourShader.setMat4("model", model);
-            cube_theater_floor.drawCubeWithTexture(lightingShaderWithTexture, model);
+        // ************************************************************************ Lift ************************************************************************
+
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+        if (liftMoveStill && liftMoveOff) {
+            t_lift_move = 0.0f;
+
+            glm::vec3 translation(22.5f, 0.0f, 11.0f);
+            glm::vec3 rotation(0.0f, 90.0f, 0.0f); // Rotation in degrees
+            glm::vec3 scale(1.0f, 1.0f, 1.0f);     // Uniform scaling
+
+            drawLift(globalTranslationMatrix, lightingShaderWithTexture, ourShader, cube_floor, cube_wall, translation, rotation, scale);
         }
 
-        // Ceiling
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(-0.5f, 17.5f, 0.0f));
-        scaleMatrix = glm::scale(translateMatrix, glm::vec3(23.5f, 0.5f, 30.5f));
-        model = globalTranslationMatrix * scaleMatrix;
-        ourShader.setMat4("model", model);
-        cube_floor.drawCubeWithTexture(lightingShaderWithTexture, model);
+         if (!liftMoveStill && liftMoveOn) {
+            glm::vec3 translation(22.5f, 0.0f + t_lift_move, 11.0f);
+            glm::vec3 rotation(0.0f, 90.0f, 0.0f); // Rotation in degrees
+            glm::vec3 scale(1.0f, 1.0f, 1.0f);     // Uniform scaling
+
+            drawLift(globalTranslationMatrix, lightingShaderWithTexture, ourShader, cube_floor, cube_wall, translation, rotation, scale);
+
+            if (t_lift_move > 8.0f) {
+                liftMoveStill = true;
+            }
+            else {
+                t_lift_move += lift_move_speed;
+                liftMoveOn = true;
+                liftMoveOff = false;
+            }
+        }
+
+        else if (liftMoveStill && liftMoveOn) {
+            t_lift_move = 0.0f;
+
+            glm::vec3 translation(22.5f, 8.0f, 11.0f);
+            glm::vec3 rotation(0.0f, 90.0f, 0.0f); // Rotation in degrees
+            glm::vec3 scale(1.0f, 1.0f, 1.0f);     // Uniform scaling
+
+            drawLift(globalTranslationMatrix, lightingShaderWithTexture, ourShader, cube_floor, cube_wall, translation, rotation, scale);
+        }
+
+        else if (!liftMoveStill && liftMoveOff) {
+             glm::vec3 translation(22.5f, 8.0f - t_lift_move, 11.0f);
+             glm::vec3 rotation(0.0f, 90.0f, 0.0f); // Rotation in degrees
+             glm::vec3 scale(1.0f, 1.0f, 1.0f);     // Uniform scaling
+
+             drawLift(globalTranslationMatrix, lightingShaderWithTexture, ourShader, cube_floor, cube_wall, translation, rotation, scale);
+
+            if (t_lift_move > 8.0) {
+                liftMoveStill = true;
+            }
+            else {
+                t_lift_move += lift_move_speed;
+                liftMoveOn = false;
+                liftMoveOff = true;
+            }
+        }
+
+        glDisable(GL_BLEND);
 
         glEnable(GL_BLEND);
         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -2159,38 +2157,54 @@ int main()
 
         
 
+        // mip levels for what this frame showed
+        TextureResidency::shared().update(projection * view, globalTranslationMatrix, camera.Position,
+            (float)SCR_HEIGHT * projection[1][1] * 0.5f);
+
         // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
         // -------------------------------------------------------------------------------
         glfwSwapBuffers(window);
         glfwPollEvents();
     }
 
-    // optional: de-allocate all resources once they've outlived their purpose:
-    // ------------------------------------------------------------------------
-    glDeleteVertexArrays(1, &cubeVAO);
-    glDeleteVertexArrays(1, &lightCubeVAO);
-    glDeleteBuffers(1, &cubeVBO);
-    glDeleteBuffers(1, &cubeEBO);
+    if (recordMipFeedback)
+        MipFeedback::shared().writeReport("mip_feedback.txt");
 
-    // glfw: terminate, clearing all previously allocated GLFW resources.
-    // ------------------------------------------------------------------
-    glfwTerminate();
-    return 0;
+    // de-allocate the arena; the meshes still owned by locals here are
+    // released as they go out of scope without compacting it, and the
+    // scene, impostors and sphere batch delete their own buffers
+    // ------------------------------------------------------------------------
+    GeometryArena::shared().shutdown();
 }
 
-void drawCube(unsigned int& cubeVAO, Shader& lightingShader, glm::mat4 model = glm::mat4(1.0f), float r = 1.0f, float g = 1.0f, float b = 1.0f)
+void drawCube(unsigned int cubeMesh, Shader& lightingShader, glm::mat4 model = glm::mat4(1.0f), float r = 1.0f, float g = 1.0f, float b = 1.0f)
 {
     lightingShader.use();
 
-    lightingShader.setVec3("material.ambient", glm::vec3(r, g, b));
-    lightingShader.setVec3("material.diffuse", glm::vec3(r, g, b));
-    lightingShader.setVec3("material.specular", glm::vec3(r, g, b));
-    lightingShader.setFloat("material.shininess", 32.0f);
+    lightingShader.setInt("materialIndex", MaterialTable::shared().add(glm::vec3(r, g, b), glm::vec3(r, g, b), glm::vec3(r, g, b), 32.0f));
 
     lightingShader.setMat4("model", model);
 
-    glBindVertexArray(cubeVAO);
-    glDrawElements(GL_TRIANGLES, 5000, GL_UNSIGNED_INT, 0);
+    GeometryArena::shared().drawMesh(cubeMesh);
+}
+
+// balloons come straight from their control points when tessellated on the
+// GPU, otherwise from the CPU LOD chain
+void drawBalloon(Shader& lightingShader, Shader& bezierShader, LODChain& lod, BezierRevolution& surface, glm::mat4 model, glm::vec3 color)
+{
+    Shader& shader = tessellateBezierOnGPU ? bezierShader : lightingShader;
+    shader.use();
+
+    shader.setInt("materialIndex", MaterialTable::shared().add(color, color, color, 32.0f));
+
+    if (tessellateBezierOnGPU) {
+        surface.draw(bezierShader, model);
+    }
+    else {
+        unsigned int balloonMesh = lod.select(model);
+        lightingShader.setMat4("model", GeometryArena::shared().meshModel(balloonMesh, model));
+        GeometryArena::shared().drawMesh(balloonMesh);
+    }
 }
 
 // process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
@@ -2616,44 +2630,45 @@ glm::mat4 RotationMatricesZ(float theta) {
     );
 }
 
-unsigned int loadTexture(char const* path, GLenum textureWrappingModeS, GLenum textureWrappingModeT, GLenum textureFilteringModeMin, GLenum textureFilteringModeMax)
+// diffuse map with the specular map's intensity packed into its alpha, the
+// layout the textured shaders sample both terms from
+unsigned int loadMaterialTexture(char const* diffusePath, char const* specularPath, GLenum textureWrappingModeS, GLenum textureWrappingModeT, GLenum textureFilteringModeMin, GLenum textureFilteringModeMax, unsigned int group)
 {
     unsigned int textureID;
     glGenTextures(1, &textureID);
 
-    int width, height, nrComponents;
-    stbi_set_flip_vertically_on_load(true);
-    unsigned char* data = stbi_load(path, &width, &height, &nrComponents, 0);
-    if (data)
+    CookedTexture packed;
+    if (useCookedTextures)
+        TextureCooker::shared().loadOrCook(diffusePath, packed, specularPath);
+    else
     {
-        GLenum format;
-        if (nrComponents == 1)
-            format = GL_RED;
-        else if (nrComponents == 3)
-            format = GL_RGB;
-        else if (nrComponents == 4)
-            format = GL_RGBA;
-
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, textureWrappingModeS);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, textureWrappingModeT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, textureFilteringModeMin);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, textureFilteringModeMax);
-
+        int width, height, nrComponents, specularWidth, specularHeight, specularComponents;
+        stbi_set_flip_vertically_on_load(true);
+        unsigned char* data = stbi_load(diffusePath, &width, &height, &nrComponents, 0);
+        unsigned char* specular = stbi_load(specularPath, &specularWidth, &specularHeight, &specularComponents, 0);
+        if (data && specular)
+            packed = TextureCooker::packSpecular(data, width, height, nrComponents, specular, specularWidth, specularHeight, specularComponents);
+        TextureCooker::shared().applySizeLimit(diffusePath, packed);
         stbi_image_free(data);
+        stbi_image_free(specular);
     }
-    else
+
+    if (packed.levels.empty())
     {
-        std::cout << "Texture failed to load at path: " << path << std::endl;
-        stbi_image_free(data);
+        std::cout << "Texture failed to load at path: " << diffusePath << std::endl;
+        return textureID;
     }
 
+    TextureResidency::shared().addTexture(GL_TEXTURE_2D, textureID, packed);
+
+    glBindTexture(GL_TEXTURE_2D, textureID);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, textureWrappingModeS);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, textureWrappingModeT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, textureFilteringModeMin);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, textureFilteringModeMax);
+
+    MipFeedback::shared().addTexture(textureID, diffusePath, packed.size);
+    TextureArrays::shared().add(textureID, packed, textureWrappingModeS, textureWrappingModeT, group);
     return textureID;
-}
\ No newline at end of file
+}
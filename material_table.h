@@ -0,0 +1,124 @@
+#ifndef material_table_h
+#define material_table_h
+
+#include <glad/glad.h>
+#include <vector>
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+#include <glm/glm.hpp>
+#include "shader.h"
+
+using namespace std;
+
+// std140 image of the shaders' Material struct:
+//
+//     struct Material {
+//         vec3 ambient;
+//         vec3 diffuse;
+//         vec3 specular;
+//         vec3 emissive;
+//         float shininess;
+//     };
+struct MaterialData {
+    glm::vec3 ambient;
+    float padding0;
+    glm::vec3 diffuse;
+    float padding1;
+    glm::vec3 specular;
+    float padding2;
+    glm::vec3 emissive;
+    float shininess;
+};
+static_assert(sizeof(MaterialData) == 64, "MaterialData must match the std140 Material struct");
+
+// Every colour material in one uniform buffer at
+// Shader::MATERIAL_BLOCK_BINDING, read by the shaders as
+//
+//     layout (std140) uniform Materials {
+//         Material materials[MAX_MATERIALS];
+//     };
+//
+// A draw only sets materialIndex (or carries the index per instance), so
+// four uniform uploads become one and draws that differ only in material
+// can share a call. add() returns the index of an identical material when
+// there is one, so it can be called at every draw; a new material costs
+// one 64-byte upload, the first time it is seen.
+class MaterialTable {
+public:
+    static const unsigned int MAX_MATERIALS = 256;     // MAX_MATERIALS in the shaders, 16 KB
+
+    static MaterialTable& shared()
+    {
+        static MaterialTable table;
+        return table;
+    }
+
+    unsigned int add(const glm::vec3& ambient, const glm::vec3& diffuse, const glm::vec3& specular, float shininess,
+        const glm::vec3& emissive = glm::vec3(0.0f))
+    {
+        MaterialData material;
+        material.ambient = ambient;
+        material.diffuse = diffuse;
+        material.specular = specular;
+        material.emissive = emissive;
+        material.shininess = shininess;
+        material.padding0 = material.padding1 = material.padding2 = 0.0f;
+
+        unordered_map<MaterialData, unsigned int, MaterialHash, MaterialEqual>::const_iterator found = indices.find(material);
+        if (found != indices.end())
+            return found->second;
+
+        if (materials.size() == MAX_MATERIALS) {
+            cout << "ERROR::MATERIAL_TABLE::FULL: " << MAX_MATERIALS << " materials" << endl;
+            return 0;
+        }
+
+        if (buffer == 0) {
+            glGenBuffers(1, &buffer);
+            glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+            glBufferData(GL_UNIFORM_BUFFER, MAX_MATERIALS * sizeof(MaterialData), NULL, GL_STATIC_DRAW);
+            glBindBufferBase(GL_UNIFORM_BUFFER, Shader::MATERIAL_BLOCK_BINDING, buffer);
+        }
+
+        unsigned int index = (unsigned int)materials.size();
+        materials.push_back(material);
+        indices[material] = index;
+
+        glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+        glBufferSubData(GL_UNIFORM_BUFFER, index * sizeof(MaterialData), sizeof(MaterialData), &material);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+        return index;
+    }
+
+    const MaterialData& get(unsigned int index) const { return materials[index]; }
+    unsigned int size() const { return (unsigned int)materials.size(); }
+
+private:
+    // padding is zeroed, so materials compare and hash as bytes
+    struct MaterialHash {
+        size_t operator()(const MaterialData& material) const
+        {
+            const unsigned char* bytes = (const unsigned char*)&material;
+            size_t hash = 2166136261u;
+            for (size_t i = 0; i < sizeof(MaterialData); i++)
+                hash = (hash ^ bytes[i]) * 16777619u;
+            return hash;
+        }
+    };
+
+    struct MaterialEqual {
+        bool operator()(const MaterialData& a, const MaterialData& b) const { return memcmp(&a, &b, sizeof(MaterialData)) == 0; }
+    };
+
+    MaterialTable() {}
+    MaterialTable(const MaterialTable&) = delete;
+    MaterialTable& operator=(const MaterialTable&) = delete;
+
+    vector<MaterialData> materials;
+    unordered_map<MaterialData, unsigned int, MaterialHash, MaterialEqual> indices;
+    unsigned int buffer = 0;
+};
+
+#endif /* material_table_h */
@@ -0,0 +1,165 @@
+#ifndef mesh_batch_h
+#define mesh_batch_h
+
+#include <vector>
+#include <map>
+#include <string>
+#include <functional>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include "mesh_builder.h"
+#include "geometry_arena.h"
+#include "mesh_cache.h"
+
+using namespace std;
+
+// fills a builder; runs on a worker thread, so it must not call GL or touch
+// state another generator may be writing
+typedef function<void(MeshBuilder&)> MeshGenerator;
+// receives the arena handle on the GL thread once the mesh is uploaded
+typedef function<void(unsigned int)> MeshReady;
+
+// a mesh for uploading: mapped from the mesh cache under cacheKey when it
+// is there, otherwise generated, prepared and written to the cache. An
+// empty key bypasses the cache.
+inline PreparedMesh prepareMesh(const string& cacheKey, const MeshGenerator& generate, VertexFormat format, bool* fromCache = nullptr)
+{
+    PreparedMesh prepared;
+    bool hit = !cacheKey.empty() && MeshCache::shared().load(cacheKey, format, prepared);
+    if (!hit) {
+        MeshBuilder builder;
+        generate(builder);
+        prepared = builder.prepare(format);
+        if (!cacheKey.empty())
+            MeshCache::shared().store(cacheKey, prepared);
+    }
+    if (fromCache)
+        *fromCache = hit;
+    return prepared;
+}
+
+// Collects the meshes primitives create while it is open, generates and
+// prepares them on a pool of worker threads, then uploads them in one go on
+// the GL thread. Handles are delivered in submission order, so a LOD chain
+// built from several submissions keeps its level order. Jobs sharing a
+// cache key are prepared once. Objects that queue a mesh must stay where
+// they are until finish(); the primitives that do delete their copy and
+// move operations.
+class MeshBatch {
+public:
+    // the batch primitives queue into, or null when they build immediately
+    static MeshBatch* collecting() { return active(); }
+
+    void begin() { active() = this; }
+
+    void add(const string& cacheKey, MeshGenerator generate, VertexFormat format, MeshReady ready, bool retainGeometry = false)
+    {
+        Job job;
+        job.key = cacheKey;
+        job.sameAs = -1;
+        job.fromCache = false;
+        job.generate = generate;
+        job.format = format;
+        job.ready = ready;
+        job.retainGeometry = retainGeometry;
+        jobs.push_back(job);
+    }
+
+    // workerCount 0 uses one thread per hardware thread
+    void finish(int workerCount = 0)
+    {
+        if (active() == this)
+            active() = nullptr;
+        if (jobs.empty())
+            return;
+
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+        map<pair<string, int>, int> firstWithKey;
+        vector<size_t> distinct;
+        for (size_t i = 0; i < jobs.size(); i++) {
+            if (!jobs[i].key.empty()) {
+                pair<string, int> key(jobs[i].key, (int)jobs[i].format);
+                map<pair<string, int>, int>::iterator it = firstWithKey.find(key);
+                if (it != firstWithKey.end()) {
+                    jobs[i].sameAs = it->second;
+                    continue;
+                }
+                firstWithKey[key] = (int)i;
+            }
+            distinct.push_back(i);
+        }
+
+        if (workerCount <= 0)
+            workerCount = max((int)thread::hardware_concurrency(), 1);
+        workerCount = min(workerCount, (int)distinct.size());
+
+        atomic<size_t> next(0);
+        vector<thread> workers;
+        for (int w = 0; w < workerCount; w++) {
+            workers.push_back(thread([this, &next, &distinct]() {
+                for (size_t u = next++; u < distinct.size(); u = next++) {
+                    Job& job = jobs[distinct[u]];
+                    job.prepared = prepareMesh(job.key, job.generate, job.format, &job.fromCache);
+                }
+            }));
+        }
+        for (size_t w = 0; w < workers.size(); w++)
+            workers[w].join();
+
+        chrono::steady_clock::time_point generated = chrono::steady_clock::now();
+
+        int cached = 0;
+        for (size_t i = 0; i < jobs.size(); i++) {
+            const PreparedMesh& prepared = jobs[i].sameAs >= 0 ? jobs[jobs[i].sameAs].prepared : jobs[i].prepared;
+            if (jobs[i].sameAs < 0 && jobs[i].fromCache)
+                cached++;
+            jobs[i].ready(GeometryArena::shared().upload(prepared, jobs[i].key, jobs[i].retainGeometry));
+        }
+
+        chrono::steady_clock::time_point uploaded = chrono::steady_clock::now();
+        cout << "mesh batch: " << jobs.size() << " meshes (" << distinct.size() << " distinct, " << cached
+            << " mapped from the cache) prepared on " << workerCount << " threads in "
+            << chrono::duration<double, milli>(generated - start).count() << " ms, uploaded in "
+            << chrono::duration<double, milli>(uploaded - generated).count() << " ms" << endl;
+
+        jobs.clear();
+    }
+
+private:
+    struct Job {
+        string key;
+        int sameAs;             // earlier job with the same key, whose mesh is reused
+        bool fromCache;
+        MeshGenerator generate;
+        VertexFormat format;
+        MeshReady ready;
+        bool retainGeometry;    // keep positions and indices on the CPU after upload
+        PreparedMesh prepared;  // dropped with the job once uploaded
+    };
+    vector<Job> jobs;
+
+    static MeshBatch*& active()
+    {
+        static MeshBatch* batch = nullptr;
+        return batch;
+    }
+};
+
+// builds a mesh now, or queues it when a batch is collecting; cacheKey
+// names the generator and every parameter that shapes its output, and
+// labels the mesh in the arena's memory report. Only meshes submitted with
+// retainGeometry keep a CPU copy once they are on the GPU.
+inline void submitMesh(const string& cacheKey, MeshGenerator generate, VertexFormat format, MeshReady ready, bool retainGeometry = false)
+{
+    if (MeshBatch* batch = MeshBatch::collecting()) {
+        batch->add(cacheKey, generate, format, ready, retainGeometry);
+        return;
+    }
+
+    ready(GeometryArena::shared().upload(prepareMesh(cacheKey, generate, format), cacheKey, retainGeometry));
+}
+
+#endif /* mesh_batch_h */
@@ -0,0 +1,112 @@
+#ifndef mesh_builder_h
+#define mesh_builder_h
+
+#include <vector>
+#include <cmath>
+#include <glm/glm.hpp>
+#include "vertex_format.h"
+#include "geometry_arena.h"
+
+using namespace std;
+
+// Builds one indexed mesh in the 8-float source layout. The exact vertex
+// and index counts are given up front so each array is allocated once, and
+// vertices are written interleaved as they are produced. prepare() hands the
+// buffers to the arena's optimiser and encoder.
+class MeshBuilder {
+public:
+    MeshBuilder() {}
+
+    MeshBuilder(int vertexCount, int indexCount)
+    {
+        reserve(vertexCount, indexCount);
+    }
+
+    void reserve(int vertexCount, int indexCount)
+    {
+        vertices.reserve((size_t)vertexCount * SOURCE_VERTEX_FLOATS);
+        indices.reserve((size_t)indexCount);
+    }
+
+    unsigned int addVertex(const glm::vec3& position, const glm::vec3& normal, const glm::vec2& texCoord)
+    {
+        unsigned int index = (unsigned int)(vertices.size() / SOURCE_VERTEX_FLOATS);
+        const float v[SOURCE_VERTEX_FLOATS] = { position.x, position.y, position.z, normal.x, normal.y, normal.z, texCoord.x, texCoord.y };
+        vertices.insert(vertices.end(), v, v + SOURCE_VERTEX_FLOATS);
+        return index;
+    }
+
+    // copies a table of 8-float vertices, returning the index of the first
+    unsigned int addVertices(const float* source, int count)
+    {
+        unsigned int first = (unsigned int)(vertices.size() / SOURCE_VERTEX_FLOATS);
+        vertices.insert(vertices.end(), source, source + (size_t)count * SOURCE_VERTEX_FLOATS);
+        return first;
+    }
+
+    // as above, mapping texture coordinates by uvTransform (xy = scale,
+    // zw = offset) on the way in
+    unsigned int addVertices(const float* source, int count, const glm::vec4& uvTransform)
+    {
+        unsigned int first = addVertices(source, count);
+        float* v = vertices.data() + (size_t)first * SOURCE_VERTEX_FLOATS;
+        for (int i = 0; i < count; i++, v += SOURCE_VERTEX_FLOATS) {
+            v[6] = v[6] * uvTransform.x + uvTransform.z;
+            v[7] = v[7] * uvTransform.y + uvTransform.w;
+        }
+        return first;
+    }
+
+    void addIndices(const unsigned int* source, int count, unsigned int first = 0)
+    {
+        for (int i = 0; i < count; i++)
+            indices.push_back(first + source[i]);
+    }
+
+    void addTriangle(unsigned int a, unsigned int b, unsigned int c)
+    {
+        indices.push_back(a);
+        indices.push_back(b);
+        indices.push_back(c);
+    }
+
+    // triangles over a (rows + 1) x (columns + 1) lattice of vertices laid
+    // out row by row from first, as surfaces of revolution produce them
+    // k1--k1+1
+    // |  / |
+    // | /  |
+    // k2--k2+1
+    void addGrid(int rows, int columns, unsigned int first = 0)
+    {
+        for (int i = 0; i < rows; ++i)
+        {
+            unsigned int k1 = first + i * (columns + 1);     // beginning of current row
+            unsigned int k2 = k1 + columns + 1;              // beginning of next row
+
+            for (int j = 0; j < columns; ++j, ++k1, ++k2)
+            {
+                addTriangle(k1, k2, k1 + 1);
+                addTriangle(k1 + 1, k2, k2 + 1);
+            }
+        }
+    }
+
+    static int gridVertexCount(int rows, int columns) { return (rows + 1) * (columns + 1); }
+    static int gridIndexCount(int rows, int columns) { return rows * columns * 6; }
+
+    int getVertexCount() const { return (int)(vertices.size() / SOURCE_VERTEX_FLOATS); }
+    int getIndexCount() const { return (int)indices.size(); }
+
+    // safe on any thread; the builder's buffers are consumed by the
+    // optimiser. Upload the result with GeometryArena::upload on the GL thread.
+    PreparedMesh prepare(VertexFormat format = VERTEX_FORMAT_FLOAT)
+    {
+        return GeometryArena::prepare(vertices, indices, format);
+    }
+
+private:
+    vector<float> vertices;
+    vector<unsigned int> indices;
+};
+
+#endif /* mesh_builder_h */
@@ -0,0 +1,309 @@
+#ifndef mesh_cache_h
+#define mesh_cache_h
+
+#include <glad/glad.h>
+#include <string>
+#include <sstream>
+#include <iomanip>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <memory>
+#include <atomic>
+#include <iostream>
+#include "geometry_arena.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#include <direct.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// bump whenever a generator, the optimiser or a vertex format changes what
+// a key produces, so stale files are rebuilt
+const unsigned int MESH_CACHE_VERSION = 2;
+const size_t MESH_CACHE_ALIGNMENT = 64;     // blob offsets, so mapped data is ready for upload
+
+// a read-only view of a whole file
+class MappedFile {
+public:
+    MappedFile() {}
+    ~MappedFile()
+    {
+#ifdef _WIN32
+        if (bytes)
+            UnmapViewOfFile(bytes);
+        if (mapping)
+            CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE)
+            CloseHandle(file);
+#else
+        if (bytes)
+            munmap((void*)bytes, length);
+#endif
+    }
+
+    bool open(const string& path)
+    {
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+            return false;
+        length = (size_t)fileSize.QuadPart;
+        mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (!mapping)
+            return false;
+        bytes = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size == 0) {
+            close(fd);
+            return false;
+        }
+        length = (size_t)info.st_size;
+        void* view = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        bytes = view == MAP_FAILED ? nullptr : (const unsigned char*)view;
+#endif
+        return bytes != nullptr;
+    }
+
+    const unsigned char* data() const { return bytes; }
+    size_t size() const { return length; }
+
+private:
+    const unsigned char* bytes = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = NULL;
+#endif
+
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+};
+
+// Generator parameters joined into a cache key, e.g.
+// MeshKey("sphere") << radius << sectors << stacks
+class MeshKey {
+public:
+    explicit MeshKey(const char* generator)
+    {
+        stream << setprecision(9) << generator;
+    }
+
+    template <typename T>
+    MeshKey& operator<<(const T& value)
+    {
+        stream << ' ' << value;
+        return *this;
+    }
+
+    string str() const { return stream.str(); }
+
+private:
+    ostringstream stream;
+};
+
+// File layout: this header, the key, then the encoded vertex and index
+// blobs, each at a MESH_CACHE_ALIGNMENT offset.
+struct MeshCacheHeader {
+    char magic[4];                  // "MSHC"
+    uint32_t version;
+    uint32_t format;
+    uint32_t indexType;
+    int32_t vertexCount;
+    int32_t indexCount;
+    float dequantization[16];
+    float center[3];
+    float radius;
+    int32_t weldedVertices;
+    int32_t clusters;
+    float acmrBefore;
+    float acmrAfter;
+    uint64_t keyOffset, keyBytes;
+    uint64_t vertexOffset, vertexBytes;
+    uint64_t indexOffset, indexBytes;
+};
+
+// Prepared meshes on disk, one file per key and vertex format. A hit maps
+// the file and uploads straight from the mapping, skipping both the
+// generator and the optimiser; a miss is written after it is built. Safe
+// to use from mesh batch workers.
+class MeshCache {
+public:
+    static MeshCache& shared()
+    {
+        static MeshCache cache;
+        return cache;
+    }
+
+    bool load(const string& key, VertexFormat format, PreparedMesh& prepared)
+    {
+        shared_ptr<MappedFile> file(new MappedFile());
+        if (!file->open(pathFor(key, format))) {
+            return false;
+        }
+
+        MeshCacheHeader header;
+        const unsigned char* bytes = file->data();
+        size_t size = file->size();
+        if (size < sizeof(header)) {
+            return false;
+        }
+        memcpy(&header, bytes, sizeof(header));
+
+        bool valid = memcmp(header.magic, "MSHC", 4) == 0 && header.version == MESH_CACHE_VERSION
+            && header.format == (uint32_t)format && header.keyBytes == key.size()
+            && header.keyOffset + header.keyBytes <= size && header.vertexOffset + header.vertexBytes <= size
+            && header.indexOffset + header.indexBytes <= size
+            && memcmp(bytes + header.keyOffset, key.data(), key.size()) == 0;
+        if (!valid) {
+            return false;
+        }
+
+        ArenaMesh& mesh = prepared.mesh;
+        mesh.format = format;
+        mesh.vertexCount = header.vertexCount;
+        mesh.indexCount = header.indexCount;
+        mesh.indexType = header.indexType;
+        memcpy(&mesh.dequantization[0][0], header.dequantization, sizeof(header.dequantization));
+        mesh.center = glm::vec3(header.center[0], header.center[1], header.center[2]);
+        mesh.radius = header.radius;
+        mesh.optimization.weldedVertices = header.weldedVertices;
+        mesh.optimization.clusters = header.clusters;
+        mesh.optimization.acmrBefore = header.acmrBefore;
+        mesh.optimization.acmrAfter = header.acmrAfter;
+        mesh.baseVertex = 0;
+        mesh.firstIndex = 0;
+        mesh.live = false;
+
+        if (prepared.vertexBytes() != header.vertexBytes || prepared.indexBytes() != header.indexBytes) {
+            return false;
+        }
+
+        prepared.mappedVertices = bytes + header.vertexOffset;
+        prepared.mappedIndices = bytes + header.indexOffset;
+        prepared.storage = file;
+        return true;
+    }
+
+    void store(const string& key, const PreparedMesh& prepared)
+    {
+        const ArenaMesh& mesh = prepared.mesh;
+        MeshCacheHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, "MSHC", 4);
+        header.version = MESH_CACHE_VERSION;
+        header.format = (uint32_t)mesh.format;
+        header.indexType = mesh.indexType;
+        header.vertexCount = mesh.vertexCount;
+        header.indexCount = mesh.indexCount;
+        memcpy(header.dequantization, &mesh.dequantization[0][0], sizeof(header.dequantization));
+        header.center[0] = mesh.center.x;
+        header.center[1] = mesh.center.y;
+        header.center[2] = mesh.center.z;
+        header.radius = mesh.radius;
+        header.weldedVertices = mesh.optimization.weldedVertices;
+        header.clusters = mesh.optimization.clusters;
+        header.acmrBefore = mesh.optimization.acmrBefore;
+        header.acmrAfter = mesh.optimization.acmrAfter;
+        header.keyOffset = sizeof(header);
+        header.keyBytes = key.size();
+        header.vertexOffset = align(header.keyOffset + header.keyBytes);
+        header.vertexBytes = prepared.vertexBytes();
+        header.indexOffset = align(header.vertexOffset + header.vertexBytes);
+        header.indexBytes = prepared.indexBytes();
+
+        ensureDirectory();
+
+        // written aside and renamed, so a reader never maps a partial file
+        string path = pathFor(key, mesh.format);
+        ostringstream temporary;
+        temporary << path << "." << writes++ << ".tmp";
+        FILE* out = fopen(temporary.str().c_str(), "wb");
+        if (!out) {
+            cout << "mesh cache: cannot write " << temporary.str() << endl;
+            return;
+        }
+
+        bool ok = fwrite(&header, sizeof(header), 1, out) == 1;
+        ok = ok && writeAt(out, header.keyOffset, key.data(), key.size());
+        ok = ok && writeAt(out, header.vertexOffset, prepared.vertexData(), (size_t)header.vertexBytes);
+        ok = ok && writeAt(out, header.indexOffset, prepared.indexData(), (size_t)header.indexBytes);
+        ok = fclose(out) == 0 && ok;
+
+        if (ok) {
+            remove(path.c_str());
+            ok = rename(temporary.str().c_str(), path.c_str()) == 0;
+        }
+        if (!ok)
+            remove(temporary.str().c_str());
+    }
+
+private:
+    string directory = "mesh_cache";
+    atomic<unsigned int> writes{ 0 };
+
+    MeshCache() {}
+
+    static uint64_t align(uint64_t offset)
+    {
+        return (offset + MESH_CACHE_ALIGNMENT - 1) / MESH_CACHE_ALIGNMENT * MESH_CACHE_ALIGNMENT;
+    }
+
+    // FNV-1a of the key names the file; the key itself is checked on load
+    string pathFor(const string& key, VertexFormat format) const
+    {
+        uint64_t hash = 14695981039346656037ull;
+        for (size_t i = 0; i < key.size(); i++) {
+            hash ^= (unsigned char)key[i];
+            hash *= 1099511628211ull;
+        }
+
+        ostringstream path;
+        path << directory << "/" << hex << setw(16) << setfill('0') << hash << "." << vertexFormatName(format) << ".mesh";
+        return path.str();
+    }
+
+    void ensureDirectory() const
+    {
+#ifdef _WIN32
+        _mkdir(directory.c_str());
+#else
+        mkdir(directory.c_str(), 0755);
+#endif
+    }
+
+    static bool writeAt(FILE* out, uint64_t offset, const void* data, size_t bytes)
+    {
+        static const unsigned char zeros[MESH_CACHE_ALIGNMENT] = {};
+        long position = ftell(out);
+        if (position < 0 || (uint64_t)position > offset)
+            return false;
+        size_t padding = (size_t)(offset - (uint64_t)position);
+        if (padding > 0 && fwrite(zeros, 1, padding, out) != padding)
+            return false;
+        return bytes == 0 || fwrite(data, 1, bytes, out) == bytes;
+    }
+};
+
+#endif /* mesh_cache_h */
@@ -0,0 +1,51 @@
+#ifndef mesh_handle_h
+#define mesh_handle_h
+
+#include "geometry_arena.h"
+
+// Owns one arena mesh and releases it when destroyed or reset. Move-only,
+// so a mesh has exactly one owner; converts to the raw handle for drawMesh,
+// addDraw and the LOD chains, which only borrow it.
+class MeshHandle {
+public:
+    MeshHandle() {}
+    explicit MeshHandle(unsigned int handle) : handle(handle) {}
+    ~MeshHandle() { reset(); }
+
+    MeshHandle(MeshHandle&& other) : handle(other.release()) {}
+
+    MeshHandle& operator=(MeshHandle&& other)
+    {
+        if (this != &other)
+            reset(other.release());
+        return *this;
+    }
+
+    MeshHandle(const MeshHandle&) = delete;
+    MeshHandle& operator=(const MeshHandle&) = delete;
+
+    unsigned int get() const { return handle; }
+    operator unsigned int() const { return handle; }
+    bool valid() const { return handle != GeometryArena::NO_MESH; }
+
+    // gives up ownership without releasing the mesh
+    unsigned int release()
+    {
+        unsigned int owned = handle;
+        handle = GeometryArena::NO_MESH;
+        return owned;
+    }
+
+    // releases the owned mesh, then takes ownership of another
+    void reset(unsigned int other = GeometryArena::NO_MESH)
+    {
+        if (valid() && other != handle)
+            GeometryArena::shared().release(handle);
+        handle = other;
+    }
+
+private:
+    unsigned int handle = GeometryArena::NO_MESH;
+};
+
+#endif /* mesh_handle_h */
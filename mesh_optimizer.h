@@ -0,0 +1,289 @@
+#ifndef mesh_optimizer_h
+#define mesh_optimizer_h
+
+#include <vector>
+#include <map>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <glm/glm.hpp>
+
+using namespace std;
+
+// Build-time optimisation of indexed triangle meshes in the 8-float source
+// layout: welding, post-transform cache ordering (Forsyth), overdraw-aware
+// cluster ordering and vertex fetch ordering.
+
+const int OPTIMIZER_CACHE_SIZE = 32;     // LRU size the ordering is tuned for
+const int ACMR_FIFO_SIZE = 16;           // FIFO size ACMR is measured with
+
+struct MeshOptimizationReport {
+    int weldedVertices;
+    int clusters;
+    float acmrBefore;
+    float acmrAfter;
+};
+
+// average cache misses per triangle for a FIFO post-transform cache
+inline float computeACMR(const vector<unsigned int>& indices, int vertexCount, int cacheSize = ACMR_FIFO_SIZE)
+{
+    if (indices.size() < 3)
+        return 0.0f;
+
+    vector<int> insertedAt(vertexCount, -1);
+    int misses = 0;
+    for (size_t i = 0; i < indices.size(); i++) {
+        unsigned int v = indices[i];
+        if (insertedAt[v] < 0 || misses - insertedAt[v] >= cacheSize) {
+            insertedAt[v] = misses;
+            misses++;
+        }
+    }
+    return (float)misses / (float)(indices.size() / 3);
+}
+
+// merges vertices whose 8 floats are bit-identical
+inline int weldVertices(vector<float>& vertices, vector<unsigned int>& indices, int floatsPerVertex)
+{
+    int vertexCount = (int)vertices.size() / floatsPerVertex;
+    map<vector<float>, unsigned int> unique;
+    vector<unsigned int> remap(vertexCount);
+    vector<float> welded;
+    welded.reserve(vertices.size());
+
+    for (int v = 0; v < vertexCount; v++) {
+        vector<float> key(vertices.begin() + v * floatsPerVertex, vertices.begin() + (v + 1) * floatsPerVertex);
+        map<vector<float>, unsigned int>::iterator it = unique.find(key);
+        if (it != unique.end()) {
+            remap[v] = it->second;
+            continue;
+        }
+        unsigned int id = (unsigned int)(welded.size() / floatsPerVertex);
+        unique[key] = id;
+        remap[v] = id;
+        welded.insert(welded.end(), key.begin(), key.end());
+    }
+
+    for (size_t i = 0; i < indices.size(); i++)
+        indices[i] = remap[indices[i]];
+
+    int removed = vertexCount - (int)(welded.size() / floatsPerVertex);
+    vertices.swap(welded);
+    return removed;
+}
+
+inline float forsythVertexScore(int cachePosition, int remainingTriangles)
+{
+    if (remainingTriangles == 0)
+        return -1.0f;
+
+    float score = 0.0f;
+    if (cachePosition >= 0) {
+        if (cachePosition < 3)
+            score = 0.75f;
+        else
+            score = powf(1.0f - (float)(cachePosition - 3) / (OPTIMIZER_CACHE_SIZE - 3), 1.5f);
+    }
+    return score + 2.0f * powf((float)remainingTriangles, -0.5f);
+}
+
+// Tom Forsyth's linear-speed vertex cache optimisation
+inline void optimizeVertexCache(vector<unsigned int>& indices, int vertexCount)
+{
+    int triangleCount = (int)indices.size() / 3;
+    if (triangleCount == 0)
+        return;
+
+    vector<int> remaining(vertexCount, 0);
+    for (size_t i = 0; i < indices.size(); i++)
+        remaining[indices[i]]++;
+
+    vector<int> firstTriangle(vertexCount + 1, 0);
+    for (int v = 0; v < vertexCount; v++)
+        firstTriangle[v + 1] = firstTriangle[v] + remaining[v];
+    vector<int> vertexTriangles(indices.size());
+    vector<int> fill(firstTriangle.begin(), firstTriangle.end() - 1);
+    for (int t = 0; t < triangleCount; t++) {
+        for (int k = 0; k < 3; k++)
+            vertexTriangles[fill[indices[t * 3 + k]]++] = t;
+    }
+
+    vector<int> cachePosition(vertexCount, -1);
+    vector<float> vertexScore(vertexCount);
+    for (int v = 0; v < vertexCount; v++)
+        vertexScore[v] = forsythVertexScore(-1, remaining[v]);
+
+    vector<float> triangleScore(triangleCount);
+    vector<bool> emitted(triangleCount, false);
+    for (int t = 0; t < triangleCount; t++)
+        triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+
+    vector<unsigned int> ordered;
+    ordered.reserve(indices.size());
+    vector<int> cache;
+    int best = (int)(max_element(triangleScore.begin(), triangleScore.end()) - triangleScore.begin());
+    int scanFrom = 0;
+
+    while (best >= 0) {
+        emitted[best] = true;
+        vector<int> newCache;
+        for (int k = 0; k < 3; k++) {
+            unsigned int v = indices[best * 3 + k];
+            ordered.push_back(v);
+            newCache.push_back((int)v);
+
+            // drop the triangle from the vertex's list of unemitted triangles
+            int begin = firstTriangle[v], end = begin + remaining[v];
+            for (int i = begin; i < end; i++) {
+                if (vertexTriangles[i] == best) {
+                    vertexTriangles[i] = vertexTriangles[end - 1];
+                    break;
+                }
+            }
+            remaining[v]--;
+        }
+        for (size_t i = 0; i < cache.size(); i++) {
+            if (cache[i] != (int)indices[best * 3] && cache[i] != (int)indices[best * 3 + 1] && cache[i] != (int)indices[best * 3 + 2])
+                newCache.push_back(cache[i]);
+        }
+
+        for (size_t i = 0; i < newCache.size(); i++) {
+            int v = newCache[i];
+            cachePosition[v] = i < (size_t)OPTIMIZER_CACHE_SIZE ? (int)i : -1;
+            vertexScore[v] = forsythVertexScore(cachePosition[v], remaining[v]);
+        }
+        if (newCache.size() > (size_t)OPTIMIZER_CACHE_SIZE)
+            newCache.resize(OPTIMIZER_CACHE_SIZE);
+        cache.swap(newCache);
+
+        // the next triangle is the best one touching the cache
+        best = -1;
+        float bestScore = -1e30f;
+        for (size_t i = 0; i < cache.size(); i++) {
+            int v = cache[i];
+            for (int j = firstTriangle[v]; j < firstTriangle[v] + remaining[v]; j++) {
+                int t = vertexTriangles[j];
+                float score = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+                if (score > bestScore) {
+                    bestScore = score;
+                    best = t;
+                }
+            }
+        }
+
+        // nothing cached is left, continue with the first unemitted triangle
+        if (best < 0) {
+            while (scanFrom < triangleCount && emitted[scanFrom])
+                scanFrom++;
+            if (scanFrom < triangleCount)
+                best = scanFrom;
+        }
+    }
+
+    indices.swap(ordered);
+}
+
+// Splits the cache-ordered list into clusters where the FIFO cache runs cold
+// (all three vertices of a triangle miss), then draws outward-facing
+// clusters first so they occlude the rest. Cache behaviour inside each
+// cluster is untouched.
+inline int optimizeOverdraw(vector<unsigned int>& indices, const vector<float>& vertices, int floatsPerVertex)
+{
+    int triangleCount = (int)indices.size() / 3;
+    int vertexCount = (int)vertices.size() / floatsPerVertex;
+    if (triangleCount == 0)
+        return 0;
+
+    vector<int> clusterStart;
+    vector<int> insertedAt(vertexCount, -1);
+    int misses = 0;
+    for (int t = 0; t < triangleCount; t++) {
+        int triangleMisses = 0;
+        for (int k = 0; k < 3; k++) {
+            unsigned int v = indices[t * 3 + k];
+            if (insertedAt[v] < 0 || misses - insertedAt[v] >= ACMR_FIFO_SIZE) {
+                insertedAt[v] = misses;
+                misses++;
+                triangleMisses++;
+            }
+        }
+        if (t == 0 || triangleMisses == 3)
+            clusterStart.push_back(t);
+    }
+    clusterStart.push_back(triangleCount);
+
+    glm::vec3 meshCenter(0.0f);
+    for (int v = 0; v < vertexCount; v++)
+        meshCenter += glm::vec3(vertices[v * floatsPerVertex], vertices[v * floatsPerVertex + 1], vertices[v * floatsPerVertex + 2]);
+    meshCenter /= (float)max(vertexCount, 1);
+
+    int clusterCount = (int)clusterStart.size() - 1;
+    vector<pair<float, int> > order(clusterCount);
+    for (int c = 0; c < clusterCount; c++) {
+        glm::vec3 centroid(0.0f), normal(0.0f);
+        float areaSum = 0.0f;
+        for (int t = clusterStart[c]; t < clusterStart[c + 1]; t++) {
+            glm::vec3 p[3];
+            for (int k = 0; k < 3; k++) {
+                const float* v = &vertices[indices[t * 3 + k] * floatsPerVertex];
+                p[k] = glm::vec3(v[0], v[1], v[2]);
+            }
+            glm::vec3 areaNormal = glm::cross(p[1] - p[0], p[2] - p[0]);
+            float area = glm::length(areaNormal);
+            centroid += (p[0] + p[1] + p[2]) * (area / 3.0f);
+            normal += areaNormal;
+            areaSum += area;
+        }
+        float normalLength = glm::length(normal);
+        float key = 0.0f;
+        if (areaSum > 0.0f && normalLength > 0.0f)
+            key = glm::dot(centroid / areaSum - meshCenter, normal / normalLength);
+        order[c] = make_pair(-key, c);
+    }
+    stable_sort(order.begin(), order.end());
+
+    vector<unsigned int> sorted;
+    sorted.reserve(indices.size());
+    for (int i = 0; i < clusterCount; i++) {
+        int c = order[i].second;
+        sorted.insert(sorted.end(), indices.begin() + clusterStart[c] * 3, indices.begin() + clusterStart[c + 1] * 3);
+    }
+    indices.swap(sorted);
+    return clusterCount;
+}
+
+// renumbers vertices in first-use order so fetches walk the VBO forwards
+inline void optimizeVertexFetch(vector<float>& vertices, vector<unsigned int>& indices, int floatsPerVertex)
+{
+    int vertexCount = (int)vertices.size() / floatsPerVertex;
+    vector<int> remap(vertexCount, -1);
+    vector<float> ordered;
+    ordered.reserve(vertices.size());
+
+    for (size_t i = 0; i < indices.size(); i++) {
+        unsigned int v = indices[i];
+        if (remap[v] < 0) {
+            remap[v] = (int)(ordered.size() / floatsPerVertex);
+            ordered.insert(ordered.end(), vertices.begin() + v * floatsPerVertex, vertices.begin() + (v + 1) * floatsPerVertex);
+        }
+        indices[i] = (unsigned int)remap[v];
+    }
+
+    vertices.swap(ordered);
+}
+
+inline MeshOptimizationReport optimizeMesh(vector<float>& vertices, vector<unsigned int>& indices, int floatsPerVertex)
+{
+    MeshOptimizationReport report;
+    report.acmrBefore = computeACMR(indices, (int)vertices.size() / floatsPerVertex);
+
+    report.weldedVertices = weldVertices(vertices, indices, floatsPerVertex);
+    optimizeVertexCache(indices, (int)vertices.size() / floatsPerVertex);
+    report.clusters = optimizeOverdraw(indices, vertices, floatsPerVertex);
+    optimizeVertexFetch(vertices, indices, floatsPerVertex);
+
+    report.acmrAfter = computeACMR(indices, (int)vertices.size() / floatsPerVertex);
+    return report;
+}
+
+#endif /* mesh_optimizer_h */
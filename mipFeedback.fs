@@ -0,0 +1,43 @@
+#version 430 core
+// Mip feedback pass over the static scene, see mip_feedback.h: drawn after
+// the opaque draws with colour and depth writes off and the depth test at
+// GL_LEQUAL, so only the visible fragments count. Each adds one to the
+// histogram of its texture at the mip level its lookup selects; bucket 0
+// is magnification, bucket n + 1 is level n.
+layout (early_fragment_tests) in;
+
+in vec2 TexCoords;
+flat in uint DiffuseLayer;
+flat in float Fade;
+
+struct Material {
+    sampler2DArray diffuse;
+};
+
+#define MIP_BUCKETS 16
+
+layout (std430, binding = 8) buffer MipFeedbackBuffer {
+    uint bucketCounts[];    // MIP_BUCKETS per texture
+};
+
+uniform Material material;
+uniform int firstLayer;     // of the bound array, counted across every array
+
+// the dither of fragmentShaderForTextureArrays.fs, whose discarded
+// fragments are not seen
+const float bayer[16] = float[](
+     0.0,  8.0,  2.0, 10.0,
+    12.0,  4.0, 14.0,  6.0,
+     3.0, 11.0,  1.0,  9.0,
+    15.0,  7.0, 13.0,  5.0);
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy) & 3;
+    if (Fade >= (bayer[pixel.y * 4 + pixel.x] + 0.5) / 16.0)
+        discard;
+
+    float lod = textureQueryLod(material.diffuse, TexCoords).y;
+    int bucket = clamp(int(floor(lod)) + 1, 0, MIP_BUCKETS - 1);
+    atomicAdd(bucketCounts[(uint(firstLayer) + DiffuseLayer) * MIP_BUCKETS + uint(bucket)], 1u);
+}
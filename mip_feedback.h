@@ -0,0 +1,186 @@
+#ifndef mip_feedback_h
+#define mip_feedback_h
+
+#include <glad/glad.h>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <cstdint>
+#include <unordered_map>
+#include "texture_array.h"
+#include "texture_cooker.h"
+
+using namespace std;
+
+// Finds textures stored larger than they are ever seen. While recording,
+// the static scene's textured batches are drawn a second time each frame,
+// after every opaque draw, with mipFeedback.fs, which counts the visible
+// fragments of every texture by the mip level their lookup selects. The
+// counts are summed over the whole run, so a benchmark walk through the
+// scene gives a histogram per texture.
+//
+// The report recommends the smallest size at which a coverage share of
+// those fragments still samples level 0 or coarser; the rest are the few
+// that want more, such as grazing angles right at the camera. A size
+// above the cooked one is recommended when too many fragments magnify.
+// writeReport saves "<source> <size>" lines that TextureCooker applies as
+// size limits on the next run.
+//
+// Only the static scene's textured draws are measured, and texture
+// streaming must be off while recording: the lookup's level is relative
+// to GL_TEXTURE_BASE_LEVEL.
+class MipFeedback {
+public:
+    static const unsigned int BUFFER_BINDING = 8;   // mipFeedback.fs
+    static const int BUCKETS = 16;                  // MIP_BUCKETS in mipFeedback.fs
+
+    static MipFeedback& shared()
+    {
+        static MipFeedback feedback;
+        return feedback;
+    }
+
+    // share of the fragments the recommended size must serve without magnifying
+    void setCoverage(float share) { coverage = share; }
+
+    // names a texture for the report; size is its cooked level 0
+    void addTexture(unsigned int texture, const string& sourcePath, int size)
+    {
+        TextureName name;
+        name.sourcePath = sourcePath;
+        name.size = size;
+        names[texture] = name;
+    }
+
+    // state for the feedback draws, once the opaque draws have filled the
+    // depth buffer; the texture arrays must be built
+    void begin()
+    {
+        if (buffer == 0) {
+            bufferCount = TextureArrays::shared().getLayerCount() * BUCKETS;
+            totals.assign(bufferCount, 0);
+            vector<unsigned int> zeros(bufferCount, 0);
+            glGenBuffers(1, &buffer);
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+            glBufferData(GL_SHADER_STORAGE_BUFFER, bufferCount * sizeof(unsigned int), zeros.data(), GL_DYNAMIC_READ);
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        }
+
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, BUFFER_BINDING, buffer);
+        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        glDepthMask(GL_FALSE);
+        glDepthFunc(GL_LEQUAL);
+    }
+
+    void end()
+    {
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+        glDepthMask(GL_TRUE);
+        glDepthFunc(GL_LESS);
+
+        // 32 bit counters fill up in a minute of full screen textures
+        if (++frames % FOLD_FRAMES == 0)
+            fold();
+    }
+
+    // prints the recommendations and writes them to path
+    void writeReport(const char* path)
+    {
+        if (buffer == 0) {
+            cout << "Mip feedback: nothing recorded" << endl;
+            return;
+        }
+        fold();
+
+        // the console report is still printed when the file cannot be written
+        ofstream file(path);
+        bool writeFile = (bool)file;
+        if (!writeFile)
+            cout << "ERROR::MIP_FEEDBACK::WRITE_FAILED: " << path << endl;
+        else
+            file << "# texture sizes from mip feedback over " << frames << " frames, " << coverage * 100.0f
+                 << "% of fragments served" << endl;
+
+        cout << "Mip feedback: " << frames << " frames, sizes serving " << coverage * 100.0f << "% of fragments" << endl;
+        for (unordered_map<unsigned int, TextureName>::const_iterator it = names.begin(); it != names.end(); ++it) {
+            TextureLayer layer = TextureArrays::shared().locate(it->first);
+            if (layer.array < 0)
+                continue;
+            const uint64_t* counts = &totals[(TextureArrays::shared().getFirstLayer(layer.array) + layer.layer) * BUCKETS];
+            const TextureName& name = it->second;
+
+            uint64_t samples = 0;
+            int finest = BUCKETS;
+            for (int b = 0; b < BUCKETS; b++) {
+                samples += counts[b];
+                if (counts[b] > 0 && finest == BUCKETS)
+                    finest = b;
+            }
+            cout << "  " << setw(28) << left << name.sourcePath << right << setw(5) << name.size;
+            if (samples == 0) {
+                cout << "  never seen" << endl;
+                continue;
+            }
+
+            int level = recommendedLevel(counts, samples);
+            int size = level < 0 ? name.size * 2 : name.size >> level;
+            size = min(max(size, TextureCooker::MIN_SIZE), TextureCooker::MAX_SIZE);
+            cout << "  finest " << (finest == 0 ? string("magnified") : "level " + to_string(finest - 1))
+                 << ", " << samples << " fragments -> " << size << (size < name.size ? " smaller" : "") << endl;
+            if (writeFile)
+                file << name.sourcePath << " " << size << endl;
+        }
+    }
+
+private:
+    static const unsigned int FOLD_FRAMES = 240;
+
+    struct TextureName {
+        string sourcePath;
+        int size;
+    };
+
+    unordered_map<unsigned int, TextureName> names;
+    vector<uint64_t> totals;
+    unsigned int buffer = 0;
+    unsigned int bufferCount = 0;
+    unsigned int frames = 0;
+    float coverage = 0.99f;
+
+    MipFeedback() {}
+    MipFeedback(const MipFeedback&) = delete;
+    MipFeedback& operator=(const MipFeedback&) = delete;
+
+    // adds the GPU counts to the totals and clears them
+    void fold()
+    {
+        vector<unsigned int> counts(bufferCount);
+        glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+        glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, bufferCount * sizeof(unsigned int), counts.data());
+        glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, NULL);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        for (size_t i = 0; i < counts.size(); i++)
+            totals[i] += counts[i];
+    }
+
+    // the coarsest level that leaves at most 1 - coverage of the fragments
+    // wanting a finer one; -1 when more than that magnify level 0
+    int recommendedLevel(const uint64_t* counts, uint64_t samples) const
+    {
+        uint64_t allowed = (uint64_t)((1.0 - coverage) * samples);
+        uint64_t finer = 0;
+        int level = -1;
+        for (int b = 0; b < BUCKETS; b++) {
+            finer += counts[b];
+            if (finer > allowed)
+                break;
+            level = b;
+        }
+        return level;
+    }
+};
+
+#endif /* mip_feedback_h */
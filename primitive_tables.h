@@ -0,0 +1,352 @@
+#ifndef primitive_tables_h
+#define primitive_tables_h
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "vertex_format.h"
+#include "procedural_primitives.h"
+#include "mesh_builder.h"
+
+using namespace std;
+
+// Vertex and index tables of the unit primitives, generated by constexpr
+// code so each one sits in read-only memory, built by the compiler. Tables
+// use unit texture coordinates; the owner's texture range is applied while
+// they are copied into a MeshBuilder. Segment counts without a compiled
+// table run the same generators at run time.
+
+// sin for constant expressions, to well beyond float precision
+constexpr double constexprSin(double x)
+{
+    const double pi = 3.14159265358979323846;
+    while (x > pi)
+        x -= 2.0 * pi;
+    while (x < -pi)
+        x += 2.0 * pi;
+
+    double term = x, sum = x;
+    for (int n = 1; n < 12; n++) {
+        term *= -x * x / ((2.0 * n) * (2.0 * n + 1.0));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr double constexprCos(double x)
+{
+    return constexprSin(x + 1.57079632679489661923);
+}
+
+constexpr void writeSourceVertex(float* vertices, int index, float px, float py, float pz, float nx, float ny, float nz, float u, float v)
+{
+    float* out = vertices + index * SOURCE_VERTEX_FLOATS;
+    out[0] = px; out[1] = py; out[2] = pz;
+    out[3] = nx; out[4] = ny; out[5] = nz;
+    out[6] = u; out[7] = v;
+}
+
+// ---------------------------------------------------------------- cube
+
+struct CubeTable {
+    static const int VERTEX_COUNT = 24;
+    static const int INDEX_COUNT = 36;
+    float vertices[VERTEX_COUNT * SOURCE_VERTEX_FLOATS];
+    unsigned int indices[INDEX_COUNT];
+};
+
+// the Cube mesh: four corners per face, unit cube from the origin
+constexpr CubeTable makeCubeTable()
+{
+    return CubeTable{
+        {
+            // positions      // normals         // texture
+            0.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f,
+            1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f,
+            1.0f, 1.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f,
+            0.0f, 1.0f, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 1.0f,
+
+            1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f,
+            1.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f,
+            1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f,
+            1.0f, 1.0f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f,
+
+            0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f,
+            1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f,
+            1.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f,
+            0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f,
+
+            0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f,
+            0.0f, 1.0f, 1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f,
+            0.0f, 1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f,
+            0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f,
+
+            1.0f, 1.0f, 1.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f,
+            1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f,
+            0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f,
+            0.0f, 1.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f,
+
+            0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f,
+            1.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f,
+            1.0f, 0.0f, 1.0f, 0.0f, -1.0f, 0.0f, 1.0f, 1.0f,
+            0.0f, 0.0f, 1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f
+        },
+        {
+            0, 3, 2, 2, 1, 0,
+            4, 5, 7, 7, 6, 4,
+            8, 9, 10, 10, 11, 8,
+            12, 13, 14, 14, 15, 12,
+            16, 17, 18, 18, 19, 16,
+            20, 21, 22, 22, 23, 20
+        }
+    };
+}
+
+inline const CubeTable& cubeTable()
+{
+    static constexpr CubeTable table = makeCubeTable();
+    return table;
+}
+
+// ---------------------------------------------------------------- prism
+
+constexpr int prismVertexCount(int segment) { return prismSides(segment) * 4 + 2; }
+constexpr int prismIndexCount(int segment) { return prismSides(segment) * 12; }
+
+// The Polygon mesh: bottom centre and ring, top centre and ring, then the
+// side band alternating bottom and top ring vertices with radial normals.
+// The ring steps by whole degrees, as Polygon always has.
+constexpr void writePrism(float* vertices, unsigned int* indices, int segment)
+{
+    int sides = prismSides(segment);
+    int step = 360 / segment;
+
+    for (int cap = 0; cap < 2; cap++) {
+        float z = (float)cap;
+        float nz = cap == 0 ? -1.0f : 1.0f;
+        int centre = cap * (sides + 1);
+        writeSourceVertex(vertices, centre, 0.0f, 0.0f, z, 0.0f, 0.0f, nz, 0.5f, 0.5f);
+        for (int k = 0; k < sides; k++) {
+            double angle = (float)(k * step * (3.1416 / 180.0));
+            float x = (float)constexprCos(angle), y = (float)constexprSin(angle);
+            writeSourceVertex(vertices, centre + 1 + k, x, y, z, 0.0f, 0.0f, nz, (x + 1.0f) * 0.5f, (y + 1.0f) * 0.5f);
+        }
+    }
+
+    int band = 2 * sides + 2;
+    for (int k = 0; k < sides; k++) {
+        double angle = (float)(k * step * (3.1416 / 180.0));
+        float x = (float)constexprCos(angle), y = (float)constexprSin(angle);
+        float u = (float)(k % 2);
+        writeSourceVertex(vertices, band + 2 * k, x, y, 0.0f, x, y, 0.0f, u, 0.0f);
+        writeSourceVertex(vertices, band + 2 * k + 1, x, y, 1.0f, x, y, 0.0f, u, 1.0f);
+    }
+
+    int count = 0;
+    for (int cap = 0; cap < 2; cap++) {
+        unsigned int centre = cap * (sides + 1);
+        for (int k = 0; k < sides; k++) {
+            indices[count++] = centre;
+            indices[count++] = centre + 1 + k;
+            indices[count++] = centre + 1 + (k + 1) % sides;
+        }
+    }
+    for (int t = 0; t < 2 * sides; t++) {
+        for (int corner = 0; corner < 3; corner++)
+            indices[count++] = band + (t + corner) % (2 * sides);
+    }
+}
+
+template <int Segments>
+struct PrismTable {
+    static const int VERTEX_COUNT = prismVertexCount(Segments);
+    static const int INDEX_COUNT = prismIndexCount(Segments);
+    float vertices[VERTEX_COUNT * SOURCE_VERTEX_FLOATS];
+    unsigned int indices[INDEX_COUNT];
+
+    constexpr PrismTable() : vertices(), indices()
+    {
+        writePrism(vertices, indices, Segments);
+    }
+};
+
+template <int Segments>
+const PrismTable<Segments>& prismTable()
+{
+    static constexpr PrismTable<Segments> table;
+    return table;
+}
+
+// ---------------------------------------------------------- hollow prism
+
+constexpr int hollowPrismVertexCount(int segment) { return segment * 4; }
+constexpr int hollowPrismIndexCount(int segment) { return segment * 24; }
+
+// The parts of the HollowPolygon mesh that do not depend on its radii: the
+// (cos, sin) of each ring vertex and the index list. Vertices run outer,
+// inner around the bottom ring, then the same around the top.
+constexpr void writeHollowPrism(float* directions, unsigned int* indices, int segment)
+{
+    const double pi = 3.14159265358979323846;
+    for (int i = 0; i < segment; i++) {
+        double angle = (float)(i * (2.0f * (float)pi / segment));
+        directions[i * 2] = (float)constexprCos(angle);
+        directions[i * 2 + 1] = (float)constexprSin(angle);
+    }
+
+    int count = 0;
+    unsigned int top = segment * 2;
+    for (int s = 0; s < segment; s++) {
+        unsigned int i = s, next = (s + 1) % segment;
+        unsigned int quad[24] = {
+            // bottom face (outer to inner)
+            i * 2, i * 2 + 1, next * 2,
+            next * 2, i * 2 + 1, next * 2 + 1,
+            // top face (outer to inner)
+            top + i * 2, top + next * 2, top + i * 2 + 1,
+            top + next * 2, top + next * 2 + 1, top + i * 2 + 1,
+            // outer wall
+            i * 2, top + i * 2, next * 2,
+            next * 2, top + i * 2, top + next * 2,
+            // inner wall
+            i * 2 + 1, next * 2 + 1, top + i * 2 + 1,
+            next * 2 + 1, top + next * 2 + 1, top + i * 2 + 1
+        };
+        for (int k = 0; k < 24; k++)
+            indices[count++] = quad[k];
+    }
+}
+
+template <int Segments>
+struct HollowPrismTable {
+    static const int VERTEX_COUNT = hollowPrismVertexCount(Segments);
+    static const int INDEX_COUNT = hollowPrismIndexCount(Segments);
+    float directions[Segments * 2];
+    unsigned int indices[INDEX_COUNT];
+
+    constexpr HollowPrismTable() : directions(), indices()
+    {
+        writeHollowPrism(directions, indices, Segments);
+    }
+};
+
+template <int Segments>
+const HollowPrismTable<Segments>& hollowPrismTable()
+{
+    static constexpr HollowPrismTable<Segments> table;
+    return table;
+}
+
+// ------------------------------------------------------- into a builder
+
+// copies a table, mapping its unit texture coordinates by uvTransform
+// (xy = scale, zw = offset)
+inline void addPrimitiveTable(MeshBuilder& builder, const float* vertices, int vertexCount,
+    const unsigned int* indices, int indexCount, const glm::vec4& uvTransform)
+{
+    builder.reserve(vertexCount, indexCount);
+    unsigned int first = builder.addVertices(vertices, vertexCount, uvTransform);
+    builder.addIndices(indices, indexCount, first);
+}
+
+template <typename Table>
+void addPrimitiveTable(MeshBuilder& builder, const Table& table, const glm::vec4& uvTransform)
+{
+    addPrimitiveTable(builder, table.vertices, Table::VERTEX_COUNT, table.indices, Table::INDEX_COUNT, uvTransform);
+}
+
+inline void addCube(MeshBuilder& builder, const glm::vec4& uvTransform)
+{
+    addPrimitiveTable(builder, cubeTable(), uvTransform);
+}
+
+// segment counts the scene uses come from compiled tables
+inline void addPrism(MeshBuilder& builder, int segment, const glm::vec4& uvTransform)
+{
+    switch (segment) {
+    case 3: addPrimitiveTable(builder, prismTable<3>(), uvTransform); return;
+    case 4: addPrimitiveTable(builder, prismTable<4>(), uvTransform); return;
+    case 5: addPrimitiveTable(builder, prismTable<5>(), uvTransform); return;
+    case 6: addPrimitiveTable(builder, prismTable<6>(), uvTransform); return;
+    case 8: addPrimitiveTable(builder, prismTable<8>(), uvTransform); return;
+    case 12: addPrimitiveTable(builder, prismTable<12>(), uvTransform); return;
+    case 30: addPrimitiveTable(builder, prismTable<30>(), uvTransform); return;
+    }
+
+    vector<float> vertices((size_t)prismVertexCount(segment) * SOURCE_VERTEX_FLOATS);
+    vector<unsigned int> indices(prismIndexCount(segment));
+    writePrism(vertices.data(), indices.data(), segment);
+    addPrimitiveTable(builder, vertices.data(), prismVertexCount(segment), indices.data(), prismIndexCount(segment), uvTransform);
+}
+
+// Texture coordinates are planar over the bottom outer radius, as
+// HollowPolygon has always mapped them.
+inline void addHollowPrism(MeshBuilder& builder, int segment, float innerRadius, float outerRadius,
+    float topInnerRadius, float topOuterRadius)
+{
+    vector<float> computed;
+    vector<unsigned int> computedIndices;
+    const float* directions = nullptr;
+    const unsigned int* indices = nullptr;
+    switch (segment) {
+    case 4: directions = hollowPrismTable<4>().directions; indices = hollowPrismTable<4>().indices; break;
+    case 6: directions = hollowPrismTable<6>().directions; indices = hollowPrismTable<6>().indices; break;
+    case 8: directions = hollowPrismTable<8>().directions; indices = hollowPrismTable<8>().indices; break;
+    default:
+        computed.resize((size_t)segment * 2);
+        computedIndices.resize(hollowPrismIndexCount(segment));
+        writeHollowPrism(computed.data(), computedIndices.data(), segment);
+        directions = computed.data();
+        indices = computedIndices.data();
+    }
+
+    builder.reserve(hollowPrismVertexCount(segment), hollowPrismIndexCount(segment));
+    for (int ring = 0; ring < 2; ring++) {
+        float z = (float)ring;
+        float inner = ring == 0 ? innerRadius : topInnerRadius;
+        float outer = ring == 0 ? outerRadius : topOuterRadius;
+        for (int i = 0; i < segment; i++) {
+            glm::vec2 d(directions[i * 2], directions[i * 2 + 1]);
+            builder.addVertex(glm::vec3(d * outer, z), glm::vec3(d, 0.0f), (d * outer + outer) / (2.0f * outer));
+            builder.addVertex(glm::vec3(d * inner, z), glm::vec3(-d, 0.0f), (d * inner + outer) / (2.0f * outer));
+        }
+    }
+    builder.addIndices(indices, hollowPrismIndexCount(segment));
+}
+
+// ------------------------------------------------ compile-time checks
+
+template <typename Table>
+constexpr bool indicesInRange(const Table& table)
+{
+    for (int i = 0; i < Table::INDEX_COUNT; i++) {
+        if (table.indices[i] >= (unsigned int)Table::VERTEX_COUNT)
+            return false;
+    }
+    return true;
+}
+
+// every ring vertex of a prism lies on the unit circle
+template <int Segments>
+constexpr bool prismRingIsUnit(const PrismTable<Segments>& table)
+{
+    for (int k = 0; k < prismSides(Segments); k++) {
+        const float* v = table.vertices + (1 + k) * SOURCE_VERTEX_FLOATS;
+        double r = (double)v[0] * v[0] + (double)v[1] * v[1];
+        if (r < 0.99999 || r > 1.00001)
+            return false;
+    }
+    return true;
+}
+
+constexpr bool nearly(double a, double b) { return a - b < 1e-9 && b - a < 1e-9; }
+
+static_assert(nearly(constexprSin(0.0), 0.0) && nearly(constexprCos(0.0), 1.0), "constexpr trig at 0");
+static_assert(nearly(constexprSin(3.14159265358979323846 / 6.0), 0.5), "constexpr sin at 30 degrees");
+static_assert(nearly(constexprCos(-7.0), 0.75390225434330471), "constexpr cos after range reduction");
+static_assert(indicesInRange(makeCubeTable()), "cube indices out of range");
+static_assert(PrismTable<6>::VERTEX_COUNT == 26 && PrismTable<7>::VERTEX_COUNT == 34, "prism vertex counts");
+static_assert(indicesInRange(PrismTable<6>()) && indicesInRange(PrismTable<7>()), "prism indices out of range");
+static_assert(prismRingIsUnit(PrismTable<30>()), "prism ring off the unit circle");
+static_assert(indicesInRange(HollowPrismTable<6>()), "hollow prism indices out of range");
+
+#endif /* primitive_tables_h */
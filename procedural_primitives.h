@@ -0,0 +1,54 @@
+#ifndef procedural_primitives_h
+#define procedural_primitives_h
+
+#include <glad/glad.h>
+#include <cmath>
+#include <glm/glm.hpp>
+
+// Primitives vertexShaderForProceduralScene.vs rebuilds from gl_VertexID,
+// so drawing them needs no vertex or index buffers. The shapes match the
+// meshes Cube and Polygon build with unit texture coordinates; the
+// texture range goes in the draw's uvTransform.
+enum ProceduralShape {
+    PROCEDURAL_CUBE = 0,        // unit cube from the origin, 36 vertices
+    PROCEDURAL_PRISM,           // unit-radius N-gon prism along z from 0 to 1
+    PROCEDURAL_SHAPE_COUNT
+};
+
+// Polygon steps its ring by a whole number of degrees, so a segment count
+// that does not divide 360 gets one extra, shorter side
+constexpr int prismSides(int segment)
+{
+    int step = 360 / segment;
+    return (360 + step - 1) / step;
+}
+
+constexpr float prismAngleStep(int segment)
+{
+    return (360 / segment) * (3.1416f / 180.0f);
+}
+
+// non-indexed triangle list: two fans and a band of 2 triangles per side
+inline int proceduralVertexCount(ProceduralShape shape, int segment)
+{
+    return shape == PROCEDURAL_CUBE ? 36 : prismSides(segment) * 12;
+}
+
+// bounding sphere in shape space, (center, radius)
+inline glm::vec4 proceduralBounds(ProceduralShape shape)
+{
+    if (shape == PROCEDURAL_CUBE)
+        return glm::vec4(0.5f, 0.5f, 0.5f, 0.8660254f);
+    return glm::vec4(0.0f, 0.0f, 0.5f, 1.118034f);
+}
+
+// core profile wants a vertex array bound even when no attribute is read
+inline unsigned int proceduralVAO()
+{
+    static unsigned int vao = 0;
+    if (vao == 0)
+        glGenVertexArrays(1, &vao);
+    return vao;
+}
+
+#endif /* procedural_primitives_h */
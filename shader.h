@@ -12,6 +12,11 @@
 class Shader
 {
 public:
+    // uniform buffer binding of the Camera block, see camera_uniforms.h
+    static const unsigned int CAMERA_BLOCK_BINDING = 0;
+    // uniform buffer binding of the Materials block, see material_table.h
+    static const unsigned int MATERIAL_BLOCK_BINDING = 1;
+
     unsigned int ID;
     // constructor generates the shader on the fly
     // ------------------------------------------------------------------------
@@ -89,6 +94,7 @@ public:
             glAttachShader(ID, geometry);
         glLinkProgram(ID);
         checkCompileErrors(ID, "PROGRAM");
+        bindUniformBlocks();
         // delete the shaders as they're linked into our program now and no longer necessary
         glDeleteShader(vertex);
         glDeleteShader(fragment);
@@ -96,6 +102,51 @@ public:
             glDeleteShader(geometry);
 
     }
+    // tessellation pipeline: vertex, tessellation control, tessellation
+    // evaluation and fragment stages
+    // ------------------------------------------------------------------------
+    Shader(const char* vertexPath, const char* tessControlPath, const char* tessEvaluationPath, const char* fragmentPath)
+    {
+        const char* paths[4] = { vertexPath, tessControlPath, tessEvaluationPath, fragmentPath };
+        const GLenum types[4] = { GL_VERTEX_SHADER, GL_TESS_CONTROL_SHADER, GL_TESS_EVALUATION_SHADER, GL_FRAGMENT_SHADER };
+        const char* names[4] = { "VERTEX", "TESS_CONTROL", "TESS_EVALUATION", "FRAGMENT" };
+        unsigned int stages[4];
+
+        ID = glCreateProgram();
+        for (int i = 0; i < 4; i++)
+        {
+            std::string code = readShaderFile(paths[i]);
+            const char* shaderCode = code.c_str();
+            stages[i] = glCreateShader(types[i]);
+            glShaderSource(stages[i], 1, &shaderCode, NULL);
+            glCompileShader(stages[i]);
+            checkCompileErrors(stages[i], names[i]);
+            glAttachShader(ID, stages[i]);
+        }
+        glLinkProgram(ID);
+        checkCompileErrors(ID, "PROGRAM");
+        bindUniformBlocks();
+        for (int i = 0; i < 4; i++)
+            glDeleteShader(stages[i]);
+    }
+    // compute program from a single compute stage
+    // ------------------------------------------------------------------------
+    explicit Shader(const char* computePath)
+    {
+        std::string code = readShaderFile(computePath);
+        const char* shaderCode = code.c_str();
+        unsigned int compute = glCreateShader(GL_COMPUTE_SHADER);
+        glShaderSource(compute, 1, &shaderCode, NULL);
+        glCompileShader(compute);
+        checkCompileErrors(compute, "COMPUTE");
+
+        ID = glCreateProgram();
+        glAttachShader(ID, compute);
+        glLinkProgram(ID);
+        checkCompileErrors(ID, "PROGRAM");
+        bindUniformBlocks();
+        glDeleteShader(compute);
+    }
     // activate the shader
     // ------------------------------------------------------------------------
     void use()
@@ -162,6 +213,37 @@ public:
     }
 
 private:
+    // points the shared uniform blocks the program declares at their buffers
+    // ------------------------------------------------------------------------
+    void bindUniformBlocks()
+    {
+        GLuint camera = glGetUniformBlockIndex(ID, "Camera");
+        if (camera != GL_INVALID_INDEX)
+            glUniformBlockBinding(ID, camera, CAMERA_BLOCK_BINDING);
+        GLuint materials = glGetUniformBlockIndex(ID, "Materials");
+        if (materials != GL_INVALID_INDEX)
+            glUniformBlockBinding(ID, materials, MATERIAL_BLOCK_BINDING);
+    }
+    // utility function for reading one shader stage from a file
+    // ------------------------------------------------------------------------
+    std::string readShaderFile(const char* path)
+    {
+        std::ifstream shaderFile;
+        shaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+        try
+        {
+            shaderFile.open(path);
+            std::stringstream shaderStream;
+            shaderStream << shaderFile.rdbuf();
+            shaderFile.close();
+            return shaderStream.str();
+        }
+        catch (std::ifstream::failure& e)
+        {
+            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << path << " " << e.what() << std::endl;
+        }
+        return std::string();
+    }
     // utility function for checking shader compilation/linking errors.
     // ------------------------------------------------------------------------
     void checkCompileErrors(GLuint shader, std::string type)
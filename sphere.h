@@ -14,6 +14,12 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include "shader.h"
+#include "geometry_arena.h"
+#include "mesh_handle.h"
+#include "lod.h"
+#include "mesh_batch.h"
+#include "sphere_impostor.h"
+#include "material_table.h"
 
 # define PI 3.1416
 
@@ -21,6 +27,7 @@ using namespace std;
 
 const int MIN_SECTOR_COUNT = 3;
 const int MIN_STACK_COUNT = 2;
+const int SPHERE_LOD_LEVELS = 3;    // each level halves the sectors and stacks
 
 class Sphere
 {
@@ -36,48 +43,32 @@ public:
         glm::vec3 diff = glm::vec3(0.34615f, 0.3143f, 0.0903f),
         glm::vec3 spec = glm::vec3(0.797357f, 0.723991f, 0.208006f),
         float shiny = 32.0f)
-        : verticesStride(24)
     {
         set(radius, sectorCount, stackCount, amb, diff, spec, shiny);
-        buildCoordinatesAndIndices();
-        buildVertices();
-
-        glGenVertexArrays(1, &sphereVAO);
-        glBindVertexArray(sphereVAO);
-
-        // Create VBO to copy vertex data
-        unsigned int sphereVBO;
-        glGenBuffers(1, &sphereVBO);
-        glBindBuffer(GL_ARRAY_BUFFER, sphereVBO);
-        glBufferData(GL_ARRAY_BUFFER,
-            this->getVertexSize(),
-            this->getVertices(),
-            GL_STATIC_DRAW);
-
-        // Create EBO to copy index data
-        unsigned int sphereEBO;
-        glGenBuffers(1, &sphereEBO);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, sphereEBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-            this->getIndexSize(),
-            this->getIndices(),
-            GL_STATIC_DRAW);
-
-        // Activate attribute arrays
-        glEnableVertexAttribArray(0); // Position
-        glEnableVertexAttribArray(1); // Normal
-
-        // Set attribute arrays with stride and offset
-        int stride = this->getVerticesStride();
-        glVertexAttribPointer(0, 3, GL_FLOAT, false, stride, (void*)0);
-        glVertexAttribPointer(1, 3, GL_FLOAT, false, stride, (void*)(sizeof(float) * 3));
-
-        // Unbind VAO and buffers
-        glBindVertexArray(0);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+        // levels are generated independently, on worker threads when a mesh
+        // batch is open, and join the LOD chain in level order
+        for (int level = 0; level < SPHERE_LOD_LEVELS; level++) {
+            float r = this->radius;
+            int sectors = max(this->sectorCount >> level, MIN_SECTOR_COUNT);
+            int stacks = max(this->stackCount >> level, MIN_STACK_COUNT);
+
+            submitMesh((MeshKey("sphere") << r << sectors << stacks).str(),
+                [r, sectors, stacks](MeshBuilder& builder) { buildLevel(builder, r, sectors, stacks); },
+                VERTEX_FORMAT_QUANTIZED,
+                [this, level](unsigned int mesh) {
+                    levelMeshes[level].reset(mesh);
+                    lod.addLevel(mesh);
+                });
+        }
+        lod.setThresholds({ 48.0f, 16.0f });
     }
-    ~Sphere() {}
+
+    // the mesh batch delivers the LOD levels to this object, so it cannot move
+    Sphere(const Sphere&) = delete;
+    Sphere& operator=(const Sphere&) = delete;
+    Sphere(Sphere&&) = delete;
+    Sphere& operator=(Sphere&&) = delete;
 
     // Setters
     void set(float radius, int sectors, int stacks, glm::vec3 amb, glm::vec3 diff, glm::vec3 spec, float shiny)
@@ -91,123 +82,96 @@ public:
         this->shininess = shiny;
     }
 
-    // Getters for interleaved vertices
-    unsigned int getVertexCount() const { return (unsigned int)coordinates.size() / 3; }
-    unsigned int getVertexSize() const { return (unsigned int)vertices.size() * sizeof(float); }
-    int getVerticesStride() const { return verticesStride; }
-    const float* getVertices() const { return vertices.data(); }
-    unsigned int getIndexSize() const { return (unsigned int)indices.size() * sizeof(unsigned int); }
-    const unsigned int* getIndices() const { return indices.data(); }
-    unsigned int getIndexCount() const { return (unsigned int)indices.size(); }
+    // Getters
+    unsigned int getMesh() const { return levelMeshes[0]; }
+
+    // projected radii in pixels below which the next coarser level is drawn
+    void setLODThresholds(const vector<float>& pixels, float hysteresis = 0.15f) { lod.setThresholds(pixels, hysteresis); }
+
+    // draw as ray-cast quads: drawSphere only queues the sphere and
+    // drawImpostors draws the queue
+    void setImpostorMode(bool enabled) { impostorMode = enabled; }
+    bool usesImpostors() const { return impostorMode; }
 
     // Draw function
-    void drawSphere(Shader& lightingShader, glm::mat4 model, glm::vec3 color) const
+    void drawSphere(Shader& lightingShader, glm::mat4 model, glm::vec3 color)
     {
+        if (impostorMode) {
+            impostors.add(glm::scale(model, glm::vec3(radius)), color, material());
+            return;
+        }
+
+        unsigned int sphereMesh = lod.select(model);
+
         lightingShader.use();
 
         // Set material properties
-        lightingShader.setVec3("material.ambient", this->ambient);
-        lightingShader.setVec3("material.diffuse", this->diffuse);
-        lightingShader.setVec3("material.specular", this->specular);
-        lightingShader.setFloat("material.shininess", this->shininess);
+        lightingShader.setInt("materialIndex", material());
 
         // Pass color to the shader
         lightingShader.setVec3("color", color); // Assumes the shader has a uniform named "objectColor"
 
         // Set transformation matrix
-        lightingShader.setMat4("model", model);
+        lightingShader.setMat4("model", GeometryArena::shared().meshModel(sphereMesh, model));
 
         // Draw the sphere
-        glBindVertexArray(sphereVAO);
-        glDrawElements(GL_TRIANGLES,
-            this->getIndexCount(),
-            GL_UNSIGNED_INT,
-            (void*)0);
-        glBindVertexArray(0);
+        GeometryArena::shared().drawMesh(sphereMesh);
+    }
+
+    // the spheres queued this frame, with a shader built from
+    // sphereImpostor.vs and sphereImpostor.fs; lit shading uses the
+    // scene's lights and this sphere's specular material
+    void drawImpostors(Shader& impostorShader, bool lit = false)
+    {
+        impostors.draw(impostorShader, lit);
     }
 
 private:
+    unsigned int material() const
+    {
+        return MaterialTable::shared().add(this->ambient, this->diffuse, this->specular, this->shininess);
+    }
+
     // Helper functions
-    void buildCoordinatesAndIndices()
+    static void buildLevel(MeshBuilder& builder, float radius, int sectors, int stacks)
     {
+        builder.reserve(MeshBuilder::gridVertexCount(stacks, sectors), MeshBuilder::gridIndexCount(stacks, sectors));
+
         float x, y, z, xz;
-        float nx, ny, nz, lengthInv = 1.0f / radius;
-        float sectorStep = 2 * PI / sectorCount;
-        float stackStep = PI / stackCount;
+        float lengthInv = 1.0f / radius;
+        float sectorStep = 2 * PI / sectors;
+        float stackStep = PI / stacks;
         float sectorAngle, stackAngle;
 
-        for (int i = 0; i <= stackCount; ++i)
+        for (int i = 0; i <= stacks; ++i)
         {
             stackAngle = PI / 2 - i * stackStep;
             xz = radius * cosf(stackAngle);
             y = radius * sinf(stackAngle);
 
-            for (int j = 0; j <= sectorCount; ++j)
+            for (int j = 0; j <= sectors; ++j)
             {
                 sectorAngle = j * sectorStep;
 
                 x = xz * cosf(sectorAngle);
                 z = xz * sinf(sectorAngle);
 
-                coordinates.push_back(x);
-                coordinates.push_back(y);
-                coordinates.push_back(z);
-
-                nx = x * lengthInv;
-                ny = y * lengthInv;
-                nz = z * lengthInv;
-
-                normals.push_back(nx);
-                normals.push_back(ny);
-                normals.push_back(nz);
-            }
-        }
-
-        int k1, k2;
-        for (int i = 0; i < stackCount; ++i)
-        {
-            k1 = i * (sectorCount + 1);
-            k2 = k1 + sectorCount + 1;
-
-            for (int j = 0; j < sectorCount; ++j, ++k1, ++k2)
-            {
-                indices.push_back(k1);
-                indices.push_back(k2);
-                indices.push_back(k1 + 1);
-
-                indices.push_back(k1 + 1);
-                indices.push_back(k2);
-                indices.push_back(k2 + 1);
+                builder.addVertex(glm::vec3(x, y, z), glm::vec3(x, y, z) * lengthInv,
+                    glm::vec2((float)j / sectors, (float)i / stacks));
             }
         }
-    }
 
-    void buildVertices()
-    {
-        size_t i, j;
-        size_t count = coordinates.size();
-        for (i = 0, j = 0; i < count; i += 3, j += 2)
-        {
-            vertices.push_back(coordinates[i]);
-            vertices.push_back(coordinates[i + 1]);
-            vertices.push_back(coordinates[i + 2]);
-
-            vertices.push_back(normals[i]);
-            vertices.push_back(normals[i + 1]);
-            vertices.push_back(normals[i + 2]);
-        }
+        builder.addGrid(stacks, sectors);
     }
 
     // Member variables
-    unsigned int sphereVAO;
+    MeshHandle levelMeshes[SPHERE_LOD_LEVELS];
+    LODChain lod;
+    SphereImpostorBatch impostors;
+    bool impostorMode = false;
     float radius;
     int sectorCount;
     int stackCount;
-    vector<float> vertices;
-    vector<float> normals;
-    vector<unsigned int> indices;
-    vector<float> coordinates;
-    int verticesStride;
 };
 
 #endif /* sphere_h */
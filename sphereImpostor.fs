@@ -0,0 +1,114 @@
+#version 430 core
+// Exact sphere (or ellipsoid) under an impostor quad: the view ray is taken
+// into unit-sphere space and intersected there, which gives the silhouette,
+// gl_FragDepth and the normal. Unlit it matches fragmentShader.fs; lit it
+// uses the instance colour as ambient and diffuse reflectance and the
+// instance's material for the highlight.
+in vec3 FragPos;
+flat in vec3 Eye;
+flat in mat4 ToSphere;
+flat in vec4 Color;
+flat in uint MaterialIndex;
+
+out vec4 FragColor;
+
+struct Material {
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+    vec3 emissive;
+    float shininess;
+};
+
+struct PointLight {
+    vec3 position;
+    float k_c;
+    float k_l;
+    float k_q;
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
+
+struct DiectionalLight {
+    vec3 direction;
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
+
+#define NR_POINT_LIGHTS 2
+
+layout (std140) uniform Camera {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec3 viewPos;
+    float time;
+    vec2 viewportSize;
+};
+#define MAX_MATERIALS 256
+
+layout (std140) uniform Materials {
+    Material materials[MAX_MATERIALS];
+};
+
+uniform bool lit;
+uniform PointLight pointLights[NR_POINT_LIGHTS];
+uniform DiectionalLight diectionalLight;
+uniform bool dlighton;
+
+vec3 lightSurface(Material material, vec3 L, vec3 N, vec3 V, vec3 ambient, vec3 diffuse, vec3 specular)
+{
+    vec3 R = reflect(-L, N);
+    return Color.rgb * ambient
+        + Color.rgb * max(dot(N, L), 0.0) * diffuse
+        + material.specular * pow(max(dot(V, R), 0.0), material.shininess) * specular;
+}
+
+void main()
+{
+    // |origin + t * direction| = 1, with direction left unnormalised so t
+    // is the same in both spaces
+    vec3 origin = vec3(ToSphere * vec4(Eye, 1.0));
+    vec3 direction = vec3(ToSphere * vec4(FragPos - Eye, 0.0));
+    float a = dot(direction, direction);
+    float b = dot(origin, direction);
+    float c = dot(origin, origin) - 1.0;
+    float discriminant = b * b - a * c;
+    if (discriminant < 0.0)
+        discard;
+    float root = sqrt(discriminant);
+    float t = (-b - root) / a;
+    if (t < 0.0)
+        t = (-b + root) / a;    // eye inside: the far side
+    if (t < 0.0)
+        discard;
+
+    vec3 fragPos = Eye + (FragPos - Eye) * t;
+    vec3 localHit = origin + direction * t;
+    vec3 N = normalize(transpose(mat3(ToSphere)) * localHit);
+
+    vec4 clip = viewProjection * vec4(fragPos, 1.0);
+    gl_FragDepth = clip.z / clip.w * 0.5 + 0.5;
+
+    if (!lit) {
+        FragColor = vec4(Color.rgb, 0.15);
+        return;
+    }
+
+    Material material = materials[MaterialIndex];
+    vec3 V = normalize(Eye - fragPos);
+    vec3 result = vec3(0.0);
+    for (int i = 0; i < NR_POINT_LIGHTS; i++) {
+        PointLight light = pointLights[i];
+        float d = length(light.position - fragPos);
+        float attenuation = 1.0 / (light.k_c + light.k_l * d + light.k_q * (d * d));
+        result += attenuation * lightSurface(material, normalize(light.position - fragPos), N, V, light.ambient, light.diffuse, light.specular);
+    }
+    if (dlighton)
+        result += lightSurface(material, normalize(-diectionalLight.direction), N, V,
+            diectionalLight.ambient, diectionalLight.diffuse, diectionalLight.specular);
+
+    FragColor = vec4(result, 1.0);
+}
@@ -0,0 +1,53 @@
+#version 430 core
+// A camera-facing quad over each sphere impostor's bounding sphere, drawn
+// as a 4-vertex strip; sphereImpostor.fs ray-casts the sphere inside it.
+
+struct SphereInstance {
+    mat4 model;         // unit sphere to world
+    vec4 color;
+    uint material;      // MaterialTable index
+};
+
+layout (std430, binding = 0) readonly buffer SphereInstanceBuffer {
+    SphereInstance spheres[];
+};
+
+out vec3 FragPos;               // on the quad, world space
+flat out vec3 Eye;
+flat out mat4 ToSphere;         // world to unit-sphere space
+flat out vec4 Color;
+flat out uint MaterialIndex;
+
+layout (std140) uniform Camera {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec3 viewPos;
+    float time;
+    vec2 viewportSize;
+};
+
+void main()
+{
+    SphereInstance sphere = spheres[gl_InstanceID];
+    vec3 center = vec3(sphere.model[3]);
+    float radius = max(length(sphere.model[0].xyz), max(length(sphere.model[1].xyz), length(sphere.model[2].xyz)));
+
+    Eye = viewPos;
+    ToSphere = inverse(sphere.model);
+    Color = sphere.color;
+    MaterialIndex = sphere.material;
+
+    // a sphere seen from close by is wider than its radius
+    vec3 toEye = Eye - center;
+    float d = length(toEye);
+    vec3 direction = toEye / d;
+    vec3 worldUp = abs(direction.y) > 0.999 ? vec3(0.0, 0.0, 1.0) : vec3(0.0, 1.0, 0.0);
+    vec3 right = normalize(cross(worldUp, direction));
+    vec3 up = cross(direction, right);
+    float extent = radius * d / sqrt(max(d * d - radius * radius, 1e-4));
+
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 2.0 - 1.0;
+    FragPos = center + (right * corner.x + up * corner.y) * extent;
+    gl_Position = viewProjection * vec4(FragPos, 1.0);
+}
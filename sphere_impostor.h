@@ -0,0 +1,82 @@
+#ifndef sphere_impostor_h
+#define sphere_impostor_h
+
+#include <glad/glad.h>
+#include <vector>
+#include <glm/glm.hpp>
+#include "shader.h"
+#include "geometry_arena.h"
+#include "procedural_primitives.h"
+
+using namespace std;
+
+// per-instance record read by sphereImpostor.vs (std430, 96 bytes)
+struct SphereImpostorInstance {
+    glm::mat4 model;            // unit sphere to world, may scale unevenly
+    glm::vec4 color;
+    unsigned int material;      // MaterialTable index
+    unsigned int padding[3];
+};
+
+// Spheres and ellipsoids drawn as one camera-facing quad each. The quad
+// covers the bounding sphere, and sphereImpostor.fs intersects the view ray
+// with the unit sphere in instance space for the exact silhouette, depth
+// and normal, so the shape is round at any distance for two triangles.
+// Instances are queued during the frame and drawn in one instanced call.
+class SphereImpostorBatch {
+public:
+    SphereImpostorBatch() {}
+
+    ~SphereImpostorBatch()
+    {
+        glDeleteBuffers(1, &instanceSSBO);
+    }
+
+    // owns its GL buffer
+    SphereImpostorBatch(const SphereImpostorBatch&) = delete;
+    SphereImpostorBatch& operator=(const SphereImpostorBatch&) = delete;
+
+    void add(const glm::mat4& model, glm::vec3 color, unsigned int material)
+    {
+        SphereImpostorInstance instance;
+        instance.model = model;
+        instance.color = glm::vec4(color, 1.0f);
+        instance.material = material;
+        instance.padding[0] = instance.padding[1] = instance.padding[2] = 0;
+        instances.push_back(instance);
+    }
+
+    bool empty() const { return instances.empty(); }
+
+    // draws and clears the queue; shader is built from sphereImpostor.vs
+    // and sphereImpostor.fs, with lighting set when lit
+    void draw(Shader& shader, bool lit)
+    {
+        if (instances.empty())
+            return;
+
+        if (instanceSSBO == 0)
+            glGenBuffers(1, &instanceSSBO);
+
+        // orphaned every frame, the spheres move
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, instanceSSBO);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, instances.size() * sizeof(SphereImpostorInstance), NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, instances.size() * sizeof(SphereImpostorInstance), instances.data());
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+        shader.use();
+        shader.setBool("lit", lit);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, instanceSSBO);
+        glBindVertexArray(proceduralVAO());
+        GeometryArena::shared().forgetBinding();
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (int)instances.size());
+
+        instances.clear();
+    }
+
+private:
+    vector<SphereImpostorInstance> instances;
+    unsigned int instanceSSBO = 0;
+};
+
+#endif /* sphere_impostor_h */
@@ -0,0 +1,112 @@
+#version 430 core
+// Frustum culling of the static scene: one invocation per draw appends the
+// draw to its batch's slots when its bounding sphere is inside all six
+// planes. Mesh draws become DrawElementsIndirectCommands, procedural draws
+// an entry in the instance list plus one more instance on their command.
+// Draws of an impostor cluster get the handover share of the fade band in
+// their draw data, which the fragment shaders dither them out by, and are
+// dropped as a whole once the camera is past the band.
+
+layout (local_size_x = 64) in;
+
+struct CullData {
+    vec4 bounds;        // scene-space bounding sphere
+    uint batch;
+    uint count;
+    uint firstIndex;
+    int baseVertex;
+    uint cluster;       // 1-based, 0 = none
+    uint padding0;
+    uint padding1;
+    uint padding2;
+};
+
+struct CullBatch {
+    uint procedural;
+    uint first;
+    uint counter;
+    uint padding;
+};
+
+struct DrawData {
+    mat4 model;
+    vec4 uvTransform;
+    vec4 color;
+    uint materialIndex;
+    uint diffuseLayer;
+    float shininess;
+    float fade;
+};
+
+layout (std430, binding = 0) buffer DrawDataBuffer {
+    DrawData draws[];
+};
+
+layout (std430, binding = 1) writeonly buffer InstanceBuffer {
+    uint instances[];
+};
+
+layout (std430, binding = 2) readonly buffer CullDataBuffer {
+    CullData cullData[];
+};
+
+layout (std430, binding = 3) readonly buffer CullBatchBuffer {
+    CullBatch cullBatches[];
+};
+
+layout (std430, binding = 4) writeonly buffer CommandBuffer {
+    uint commands[];            // DrawElementsIndirectCommand, 5 words each
+};
+
+layout (std430, binding = 5) buffer ProceduralCommandBuffer {
+    uint proceduralCommands[];  // DrawArraysIndirectCommand, 4 words each
+};
+
+layout (std430, binding = 6) buffer CounterBuffer {
+    uint counters[];            // commands appended per mesh batch
+};
+
+layout (std430, binding = 7) readonly buffer ClusterBuffer {
+    vec4 clusters[];            // scene-space bounding spheres
+};
+
+uniform vec4 planes[6];
+uniform int drawCount;
+uniform vec3 camera;            // scene space
+uniform float clusterFadeStart;
+uniform float clusterFadeWidth;
+
+void main()
+{
+    uint i = gl_GlobalInvocationID.x;
+    if (i >= uint(drawCount))
+        return;
+
+    CullData draw = cullData[i];
+    if (draw.cluster != 0u) {
+        // the same share impostor.vs fades the impostor in by
+        float fade = clamp((distance(camera, clusters[draw.cluster - 1u].xyz) - clusterFadeStart) / clusterFadeWidth, 0.0, 1.0);
+        if (fade >= 1.0)
+            return;
+        draws[i].fade = fade;
+    }
+
+    for (int p = 0; p < 6; p++) {
+        if (dot(planes[p].xyz, draw.bounds.xyz) + planes[p].w < -draw.bounds.w)
+            return;
+    }
+
+    CullBatch batch = cullBatches[draw.batch];
+    if (batch.procedural != 0u) {
+        uint slot = batch.first + atomicAdd(proceduralCommands[batch.counter * 4u + 1u], 1u);
+        instances[slot] = i;
+        return;
+    }
+
+    uint slot = (batch.first + atomicAdd(counters[batch.counter], 1u)) * 5u;
+    commands[slot] = draw.count;
+    commands[slot + 1u] = 1u;
+    commands[slot + 2u] = draw.firstIndex;
+    commands[slot + 3u] = uint(draw.baseVertex);
+    commands[slot + 4u] = i;   // baseInstance selects the draw's data
+}
@@ -0,0 +1,644 @@
+#ifndef static_scene_h
+#define static_scene_h
+
+#include <glad/glad.h>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include "shader.h"
+#include "geometry_arena.h"
+#include "procedural_primitives.h"
+#include "texture_array.h"
+
+using namespace std;
+
+// layout expected by glMultiDrawElementsIndirect
+struct DrawElementsIndirectCommand {
+    unsigned int count;
+    unsigned int instanceCount;
+    unsigned int firstIndex;
+    int baseVertex;
+    unsigned int baseInstance;
+};
+
+// layout expected by glDrawArraysIndirect
+struct DrawArraysIndirectCommand {
+    unsigned int count;
+    unsigned int instanceCount;
+    unsigned int first;
+    unsigned int baseInstance;
+};
+
+// per-draw record read by staticSceneCull.cs (std430, 48 bytes): the
+// bounds to test and, for mesh draws, the command to emit
+struct StaticCullData {
+    glm::vec4 bounds;           // scene-space bounding sphere
+    unsigned int batch;         // mesh batches first, then procedural ones
+    unsigned int count;
+    unsigned int firstIndex;
+    int baseVertex;
+    unsigned int cluster;       // 1-based impostor cluster, 0 = none
+    unsigned int padding[3];
+};
+
+// per-batch record read by staticSceneCull.cs (std430, 16 bytes)
+struct StaticCullBatch {
+    unsigned int procedural;    // 0 = appends commands, 1 = appends instances
+    unsigned int first;         // first command or instance slot of the batch
+    unsigned int counter;       // mesh batch or procedural command index
+    unsigned int padding;
+};
+
+// per-draw record read by vertexShaderForStaticScene.vs (std430, 112 bytes)
+struct StaticDrawData {
+    glm::mat4 model;
+    glm::vec4 uvTransform;      // xy = scale, zw = offset
+    glm::vec4 color;            // colour of unlit draws
+    unsigned int materialIndex;
+    unsigned int diffuseLayer;  // layer of the batch's texture array
+    float shininess;
+    float fade;                 // impostor handover, written by staticSceneCull.cs
+};
+
+enum StaticScenePass {
+    STATIC_PASS_TEXTURED = 0,   // lit, diffuse + specular map
+    STATIC_PASS_FLAT,           // unlit, per-draw colour
+    STATIC_PASS_COUNT
+};
+
+// Everything in the cafeteria that never moves is recorded once into this
+// scene: draws reference meshes in the geometry arena, per-draw data goes
+// into an SSBO and the frame becomes one glMultiDrawElementsIndirect per
+// shader and texture set. Cubes and prisms can instead be recorded as
+// procedural draws, which pull their vertices from gl_VertexID: one
+// glDrawArraysIndirect per shape and texture set, reading the same
+// per-draw data.
+//
+// Textured draws sample the TextureArrays built at startup, so a texture
+// set is an array rather than a texture: every material whose map shares
+// a size class, format and wrap mode lands in one batch, and the draw
+// picks its layer and shininess from its per-draw data. Specular
+// intensity rides in the diffuse alpha.
+//
+// Culling runs on the GPU. Each batch owns a fixed range of command (or
+// instance) slots sized for all of its draws; every frame the ranges are
+// cleared and staticSceneCull.cs appends the draws whose bounds pass the
+// frustum test. Slots left empty draw nothing, so the CPU never reads
+// results back and its per-frame work does not grow with the draw count.
+// The cull records are only re-uploaded when the scene is recorded or
+// the arena layout changes.
+//
+// Draws recorded between beginCluster and endCluster belong to a piece of
+// furniture an impostor can stand in for. Over the cluster fade band the
+// cull pass writes how far the handover has gone into their draw data and
+// the fragment shaders dither them out with the complement of the
+// impostor's dither; past the band it drops them.
+class StaticScene {
+public:
+    StaticScene() {}
+
+    ~StaticScene()
+    {
+        glDeleteBuffers(1, &drawDataSSBO);
+        glDeleteBuffers(1, &indirectBuffer);
+        glDeleteBuffers(1, &proceduralInstanceSSBO);
+        glDeleteBuffers(1, &proceduralIndirectBuffer);
+        glDeleteBuffers(1, &cullDataSSBO);
+        glDeleteBuffers(1, &cullBatchSSBO);
+        glDeleteBuffers(1, &batchCounterBuffer);
+        glDeleteBuffers(1, &clusterSSBO);
+    }
+
+    // the scene currently capturing primitive draw calls, if any
+    static StaticScene*& recording()
+    {
+        static StaticScene* active = nullptr;
+        return active;
+    }
+
+    bool needsRebuild() const { return sceneDirty; }
+    void invalidate() { sceneDirty = true; }
+
+    // whether Cube and Polygon record procedural draws instead of meshes;
+    // takes effect at the next recording
+    void setProceduralPrimitives(bool enabled)
+    {
+        if (enabled != proceduralPrimitives)
+            sceneDirty = true;
+        proceduralPrimitives = enabled;
+    }
+    bool usesProceduralPrimitives() const { return proceduralPrimitives; }
+
+    void beginRecording()
+    {
+        draws.clear();
+        drawMeshes.clear();
+        drawBounds.clear();
+        drawPasses.clear();
+        drawShapes.clear();
+        drawClusters.clear();
+        clusters.clear();
+        currentCluster = 0;
+        recording() = this;
+    }
+
+    void endRecording()
+    {
+        recording() = nullptr;
+
+        uploadDrawData();
+        uploadCullData();
+
+        sceneDirty = false;
+    }
+
+    // diffuseMap carries the specular intensity in alpha, see loadMaterialTexture
+    unsigned int addMaterial(unsigned int diffuseMap, float shininess)
+    {
+        for (size_t i = 0; i < materials.size(); i++) {
+            if (materials[i].diffuseMap == diffuseMap && materials[i].shininess == shininess)
+                return (unsigned int)i;
+        }
+
+        StaticMaterial material;
+        material.diffuseMap = diffuseMap;
+        material.shininess = shininess;
+        material.diffuse = TextureArrays::shared().locate(diffuseMap);
+        if (material.diffuse.array < 0)
+            cout << "ERROR::STATIC_SCENE::TEXTURE_NOT_IN_ARRAYS: " << diffuseMap << endl;
+        material.textureSet = findTextureSet(material.diffuse.array);
+        materials.push_back(material);
+
+        return (unsigned int)materials.size() - 1;
+    }
+
+    // meshId is a geometry arena handle
+    void addDraw(StaticScenePass pass, unsigned int meshId, const glm::mat4& model, unsigned int materialIndex,
+        glm::vec3 color = glm::vec3(1.0f), glm::vec4 uvTransform = glm::vec4(1.0f, 1.0f, 0.0f, 0.0f))
+    {
+        const ArenaMesh& mesh = GeometryArena::shared().getMesh(meshId);
+        addDrawData(pass, GeometryArena::shared().meshModel(meshId, model), materialIndex, color, uvTransform);
+        drawMeshes.push_back(meshId);
+        drawShapes.push_back(ProceduralKey());
+        drawBounds.push_back(sceneBounds(model, glm::vec4(mesh.center, mesh.radius)));
+    }
+
+    // a cube or prism drawn without vertex buffers; segment is the
+    // Polygon segment count of a prism
+    void addProceduralDraw(StaticScenePass pass, ProceduralShape shape, int segment, const glm::mat4& model,
+        unsigned int materialIndex, glm::vec3 color = glm::vec3(1.0f), glm::vec4 uvTransform = glm::vec4(1.0f, 1.0f, 0.0f, 0.0f))
+    {
+        ProceduralKey key;
+        key.shape = shape;
+        key.segment = shape == PROCEDURAL_PRISM ? segment : 0;
+
+        addDrawData(pass, model, materialIndex, color, uvTransform);
+        drawMeshes.push_back(GeometryArena::NO_MESH);
+        drawShapes.push_back(key);
+        drawBounds.push_back(sceneBounds(model, proceduralBounds(shape)));
+    }
+
+    // draws recorded until endCluster fade out together over the cluster
+    // fade band; bounds is the scene-space sphere measured from
+    void beginCluster(const glm::vec4& bounds)
+    {
+        clusters.push_back(bounds);
+        currentCluster = (unsigned int)clusters.size();
+    }
+    void endCluster() { currentCluster = 0; }
+
+    // camera distances over which clustered draws hand over to their
+    // impostors, the fade band of ImpostorAtlas
+    void setClusterFade(float start, float width)
+    {
+        clusterFadeStart = start;
+        clusterFadeWidth = width;
+    }
+
+    // bounding sphere of everything recorded
+    glm::vec4 getBounds() const
+    {
+        if (drawBounds.empty())
+            return glm::vec4(0.0f);
+        glm::vec3 low(drawBounds[0]), high(drawBounds[0]);
+        for (size_t i = 0; i < drawBounds.size(); i++) {
+            low = glm::min(low, glm::vec3(drawBounds[i]) - drawBounds[i].w);
+            high = glm::max(high, glm::vec3(drawBounds[i]) + drawBounds[i].w);
+        }
+        glm::vec3 center = (low + high) * 0.5f;
+        float radius = 0.0f;
+        for (size_t i = 0; i < drawBounds.size(); i++)
+            radius = max(radius, glm::length(glm::vec3(drawBounds[i]) - center) + drawBounds[i].w);
+        return glm::vec4(center, radius);
+    }
+
+    // frustum test of every draw on the GPU, filling this frame's indirect
+    // commands; cullShader is built from staticSceneCull.cs and
+    // cameraPosition is in world space
+    void cull(Shader& cullShader, const glm::mat4& viewProjection, const glm::mat4& world, const glm::vec3& cameraPosition)
+    {
+        if (draws.empty())
+            return;
+        if (arenaGeneration != GeometryArena::shared().getGeneration())
+            uploadCullData();
+
+        glm::mat4 m = viewProjection * world;
+        glm::vec4 planes[6];
+        for (int i = 0; i < 3; i++) {
+            planes[i * 2] = glm::vec4(m[0][3] + m[0][i], m[1][3] + m[1][i], m[2][3] + m[2][i], m[3][3] + m[3][i]);
+            planes[i * 2 + 1] = glm::vec4(m[0][3] - m[0][i], m[1][3] - m[1][i], m[2][3] - m[2][i], m[3][3] - m[3][i]);
+        }
+        for (int i = 0; i < 6; i++)
+            planes[i] = planes[i] / glm::length(glm::vec3(planes[i]));
+
+        // cleared on the GPU: empty command slots have a zero count
+        glBindBuffer(GL_COPY_WRITE_BUFFER, indirectBuffer);
+        glClearBufferData(GL_COPY_WRITE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, NULL);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, batchCounterBuffer);
+        glClearBufferData(GL_COPY_WRITE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, NULL);
+        if (!proceduralCommands.empty()) {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, proceduralIndirectBuffer);
+            glBufferSubData(GL_COPY_WRITE_BUFFER, 0, proceduralCommands.size() * sizeof(DrawArraysIndirectCommand), proceduralCommands.data());
+        }
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        cullShader.use();
+        glUniform4fv(glGetUniformLocation(cullShader.ID, "planes"), 6, &planes[0][0]);
+        cullShader.setInt("drawCount", (int)draws.size());
+        cullShader.setVec3("camera", glm::vec3(glm::inverse(world) * glm::vec4(cameraPosition, 1.0f)));
+        cullShader.setFloat("clusterFadeStart", clusterFadeStart);
+        cullShader.setFloat("clusterFadeWidth", clusterFadeWidth);
+
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, drawDataSSBO);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, proceduralInstanceSSBO);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, cullDataSSBO);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, cullBatchSSBO);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, indirectBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, proceduralIndirectBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, batchCounterBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 7, clusterSSBO);
+
+        glDispatchCompute(((unsigned int)draws.size() + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1, 1);
+        glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+    }
+
+    // texturedOnly skips the flat batches, for passes that only need the
+    // textured ones
+    void draw(Shader& texturedShader, Shader& flatShader, const glm::mat4& world, bool texturedOnly = false)
+    {
+        if (batches.empty())
+            return;
+        GeometryArena& arena = GeometryArena::shared();
+
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, drawDataSSBO);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+
+        for (size_t i = 0; i < batches.size(); i++) {
+            const StaticBatch& batch = batches[i];
+            if (batch.commandCount == 0 || (texturedOnly && batch.pass != STATIC_PASS_TEXTURED))
+                continue;
+
+            arena.bind(batch.format);
+            usePass(batch.pass == STATIC_PASS_TEXTURED ? texturedShader : flatShader, batch.pass, batch.textureSet, world);
+
+            glMultiDrawElementsIndirect(GL_TRIANGLES, batch.indexType,
+                (void*)(batch.firstCommand * sizeof(DrawElementsIndirectCommand)),
+                batch.commandCount, 0);
+        }
+
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+
+    // the procedural draws, with shaders built on
+    // vertexShaderForProceduralScene.vs; view and projection must be set
+    void drawProcedural(Shader& texturedShader, Shader& flatShader, const glm::mat4& world, bool texturedOnly = false)
+    {
+        if (proceduralBatches.empty())
+            return;
+
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, drawDataSSBO);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, proceduralInstanceSSBO);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, proceduralIndirectBuffer);
+        glBindVertexArray(proceduralVAO());
+        GeometryArena::shared().forgetBinding();
+
+        for (size_t i = 0; i < proceduralBatches.size(); i++) {
+            const ProceduralBatch& batch = proceduralBatches[i];
+            if (batch.instanceCount == 0 || (texturedOnly && batch.pass != STATIC_PASS_TEXTURED))
+                continue;
+
+            Shader& shader = batch.pass == STATIC_PASS_TEXTURED ? texturedShader : flatShader;
+            usePass(shader, batch.pass, batch.textureSet, world);
+            shader.setInt("shape", batch.key.shape);
+            if (batch.key.shape == PROCEDURAL_PRISM) {
+                shader.setInt("sides", prismSides(batch.key.segment));
+                shader.setFloat("angleStep", prismAngleStep(batch.key.segment));
+            }
+            shader.setInt("firstInstance", (int)batch.firstInstance);
+
+            glDrawArraysIndirect(GL_TRIANGLES, (void*)(i * sizeof(DrawArraysIndirectCommand)));
+        }
+
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+
+    // where each textured draw samples its texture array, for TextureResidency
+    vector<TextureUse> getTextureUses() const
+    {
+        vector<TextureUse> uses;
+        for (size_t i = 0; i < draws.size(); i++) {
+            if (drawPasses[i] != STATIC_PASS_TEXTURED)
+                continue;
+            TextureUse use;
+            use.texture = TextureArrays::shared().getArray(materials[draws[i].materialIndex].diffuse.array);
+            use.bounds = drawBounds[i];
+            use.texelScale = max(draws[i].uvTransform.x, draws[i].uvTransform.y);
+            uses.push_back(use);
+        }
+        return uses;
+    }
+
+    unsigned int getDrawCount() const { return (unsigned int)draws.size(); }
+    unsigned int getBatchCount() const { return (unsigned int)(batches.size() + proceduralBatches.size()); }
+
+private:
+    struct StaticMaterial {
+        unsigned int diffuseMap;
+        float shininess;
+        TextureLayer diffuse;
+        unsigned int textureSet;
+    };
+
+    // shape of a procedural draw; meshes have shape -1
+    struct ProceduralKey {
+        int shape = -1;
+        int segment = 0;
+
+        bool operator==(const ProceduralKey& other) const { return shape == other.shape && segment == other.segment; }
+    };
+
+    struct ProceduralBatch {
+        StaticScenePass pass;
+        ProceduralKey key;
+        unsigned int textureSet;
+        unsigned int firstInstance;     // into the instance list
+        int instanceCount;              // slots, one per draw of the batch
+    };
+
+    struct StaticBatch {
+        StaticScenePass pass;
+        VertexFormat format;
+        GLenum indexType;
+        unsigned int textureSet;
+        unsigned int firstCommand;
+        int commandCount;               // slots, one per draw of the batch
+    };
+
+    static const unsigned int CULL_GROUP_SIZE = 64;     // local_size_x of staticSceneCull.cs
+
+    unsigned int drawDataSSBO = 0;
+    unsigned int indirectBuffer = 0;
+    unsigned int proceduralInstanceSSBO = 0;   // procedural draws that passed culling, batch by batch
+    unsigned int proceduralIndirectBuffer = 0;
+    unsigned int cullDataSSBO = 0;
+    unsigned int cullBatchSSBO = 0;
+    unsigned int batchCounterBuffer = 0;       // commands appended per mesh batch
+    unsigned int clusterSSBO = 0;
+    bool proceduralPrimitives = false;
+
+    bool sceneDirty = true;
+    unsigned int arenaGeneration = 0;
+
+    vector<StaticMaterial> materials;
+    vector<int> textureSets;                    // the TextureArrays array each set binds
+
+    vector<StaticDrawData> draws;
+    vector<unsigned int> drawMeshes;
+    vector<StaticScenePass> drawPasses;
+    vector<ProceduralKey> drawShapes;
+    vector<glm::vec4> drawBounds;
+    vector<unsigned int> drawClusters;
+    vector<glm::vec4> clusters;                 // scene-space spheres
+    unsigned int currentCluster = 0;
+    float clusterFadeStart = 1e30f;
+    float clusterFadeWidth = 1.0f;
+    vector<StaticBatch> batches;
+    vector<ProceduralBatch> proceduralBatches;
+    vector<DrawArraysIndirectCommand> proceduralCommands;  // with no instances, copied in before each cull
+
+    void addDrawData(StaticScenePass pass, const glm::mat4& model, unsigned int materialIndex, glm::vec3 color, glm::vec4 uvTransform)
+    {
+        StaticDrawData draw;
+        draw.model = model;
+        draw.uvTransform = uvTransform;
+        draw.color = glm::vec4(color, 1.0f);
+        draw.materialIndex = materialIndex;
+        draw.diffuseLayer = 0;
+        draw.shininess = 0.0f;
+        draw.fade = 0.0f;
+        if (pass == STATIC_PASS_TEXTURED) {
+            const StaticMaterial& material = materials[materialIndex];
+            draw.diffuseLayer = material.diffuse.layer;
+            draw.shininess = material.shininess;
+        }
+        draws.push_back(draw);
+        drawPasses.push_back(pass);
+        drawClusters.push_back(currentCluster);
+    }
+
+    // bounding sphere in scene space
+    static glm::vec4 sceneBounds(const glm::mat4& model, const glm::vec4& bounds)
+    {
+        float scale = max(glm::length(glm::vec3(model[0])), max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+        return glm::vec4(glm::vec3(model * glm::vec4(glm::vec3(bounds), 1.0f)), bounds.w * scale);
+    }
+
+    void usePass(Shader& shader, StaticScenePass pass, unsigned int textureSet, const glm::mat4& world)
+    {
+        shader.use();
+        shader.setMat4("world", world);
+
+        if (pass == STATIC_PASS_TEXTURED) {
+            shader.setInt("material.diffuse", 0);
+
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D_ARRAY, TextureArrays::shared().getArray(textureSets[textureSet]));
+            // for mipFeedback.fs, which records per texture
+            shader.setInt("firstLayer", (int)TextureArrays::shared().getFirstLayer(textureSets[textureSet]));
+        }
+    }
+
+    unsigned int findTextureSet(int diffuseArray)
+    {
+        for (size_t i = 0; i < textureSets.size(); i++) {
+            if (textureSets[i] == diffuseArray)
+                return (unsigned int)i;
+        }
+        textureSets.push_back(diffuseArray);
+        return (unsigned int)textureSets.size() - 1;
+    }
+
+    // flat draws share one set, they bind no textures
+    unsigned int drawTextureSet(size_t i) const
+    {
+        return drawPasses[i] == STATIC_PASS_TEXTURED ? materials[draws[i].materialIndex].textureSet : 0;
+    }
+
+    void uploadDrawData()
+    {
+        if (drawDataSSBO == 0) {
+            glGenBuffers(1, &drawDataSSBO);
+            glGenBuffers(1, &indirectBuffer);
+            glGenBuffers(1, &proceduralInstanceSSBO);
+            glGenBuffers(1, &proceduralIndirectBuffer);
+            glGenBuffers(1, &cullDataSSBO);
+            glGenBuffers(1, &cullBatchSSBO);
+            glGenBuffers(1, &batchCounterBuffer);
+            glGenBuffers(1, &clusterSSBO);
+        }
+
+        GeometryArena::shared().reserveDrawIDs((int)draws.size());
+
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, drawDataSSBO);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, draws.size() * sizeof(StaticDrawData), draws.data(), GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+        // one batch per vertex format, index type and texture set for textured
+        // draws, one per vertex format and index type for flat draws
+        const GeometryArena& arena = GeometryArena::shared();
+        batches.clear();
+        proceduralBatches.clear();
+        for (size_t i = 0; i < draws.size(); i++) {
+            unsigned int textureSet = drawTextureSet(i);
+            if (drawShapes[i].shape >= 0) {
+                int found = findProceduralBatch(drawPasses[i], drawShapes[i], textureSet);
+                if (found < 0) {
+                    ProceduralBatch batch;
+                    batch.pass = drawPasses[i];
+                    batch.key = drawShapes[i];
+                    batch.textureSet = textureSet;
+                    batch.firstInstance = 0;
+                    batch.instanceCount = 0;
+                    proceduralBatches.push_back(batch);
+                    found = (int)proceduralBatches.size() - 1;
+                }
+                proceduralBatches[found].instanceCount++;
+                continue;
+            }
+
+            const ArenaMesh& mesh = arena.getMesh(drawMeshes[i]);
+            int found = findBatch(drawPasses[i], mesh.format, mesh.indexType, textureSet);
+            if (found < 0) {
+                StaticBatch batch;
+                batch.pass = drawPasses[i];
+                batch.format = mesh.format;
+                batch.indexType = mesh.indexType;
+                batch.textureSet = textureSet;
+                batch.firstCommand = 0;
+                batch.commandCount = 0;
+                batches.push_back(batch);
+                found = (int)batches.size() - 1;
+            }
+            batches[found].commandCount++;
+        }
+    }
+
+    int findBatch(StaticScenePass pass, VertexFormat format, GLenum indexType, unsigned int textureSet) const
+    {
+        for (size_t i = 0; i < batches.size(); i++) {
+            if (batches[i].pass == pass && batches[i].format == format && batches[i].indexType == indexType
+                && batches[i].textureSet == textureSet)
+                return (int)i;
+        }
+        return -1;
+    }
+
+    int findProceduralBatch(StaticScenePass pass, const ProceduralKey& key, unsigned int textureSet) const
+    {
+        for (size_t i = 0; i < proceduralBatches.size(); i++) {
+            if (proceduralBatches[i].pass == pass && proceduralBatches[i].key == key
+                && proceduralBatches[i].textureSet == textureSet)
+                return (int)i;
+        }
+        return -1;
+    }
+
+    // slot ranges for every batch and the cull record of every draw; mesh
+    // commands carry arena offsets, so this follows the arena generation
+    void uploadCullData()
+    {
+        const GeometryArena& arena = GeometryArena::shared();
+
+        unsigned int commandSlots = 0;
+        for (size_t b = 0; b < batches.size(); b++) {
+            batches[b].firstCommand = commandSlots;
+            commandSlots += batches[b].commandCount;
+        }
+        unsigned int instanceSlots = 0;
+        proceduralCommands.clear();
+        for (size_t b = 0; b < proceduralBatches.size(); b++) {
+            ProceduralBatch& batch = proceduralBatches[b];
+            batch.firstInstance = instanceSlots;
+            instanceSlots += batch.instanceCount;
+
+            DrawArraysIndirectCommand command;
+            command.count = proceduralVertexCount((ProceduralShape)batch.key.shape, batch.key.segment);
+            command.instanceCount = 0;
+            command.first = 0;
+            command.baseInstance = 0;
+            proceduralCommands.push_back(command);
+        }
+
+        vector<StaticCullBatch> cullBatches;
+        for (size_t b = 0; b < batches.size(); b++) {
+            StaticCullBatch batch = { 0, batches[b].firstCommand, (unsigned int)b, 0 };
+            cullBatches.push_back(batch);
+        }
+        for (size_t b = 0; b < proceduralBatches.size(); b++) {
+            StaticCullBatch batch = { 1, proceduralBatches[b].firstInstance, (unsigned int)b, 0 };
+            cullBatches.push_back(batch);
+        }
+
+        vector<StaticCullData> cullData(draws.size());
+        for (size_t i = 0; i < draws.size(); i++) {
+            unsigned int textureSet = drawTextureSet(i);
+            StaticCullData& data = cullData[i];
+            data.bounds = drawBounds[i];
+            data.cluster = drawClusters[i];
+            data.padding[0] = data.padding[1] = data.padding[2] = 0;
+            if (drawShapes[i].shape >= 0) {
+                data.batch = (unsigned int)(batches.size() + findProceduralBatch(drawPasses[i], drawShapes[i], textureSet));
+                data.count = data.firstIndex = 0;
+                data.baseVertex = 0;
+                continue;
+            }
+
+            const ArenaMesh& mesh = arena.getMesh(drawMeshes[i]);
+            data.batch = (unsigned int)findBatch(drawPasses[i], mesh.format, mesh.indexType, textureSet);
+            data.count = mesh.indexCount;
+            data.firstIndex = mesh.firstIndex;
+            data.baseVertex = mesh.baseVertex;
+        }
+
+        // never empty, so every buffer can be bound
+        uploadBuffer(cullDataSSBO, cullData.size() * sizeof(StaticCullData), cullData.data(), GL_STATIC_DRAW);
+        uploadBuffer(cullBatchSSBO, cullBatches.size() * sizeof(StaticCullBatch), cullBatches.data(), GL_STATIC_DRAW);
+        uploadBuffer(clusterSSBO, clusters.size() * sizeof(glm::vec4), clusters.data(), GL_STATIC_DRAW);
+        uploadBuffer(indirectBuffer, commandSlots * sizeof(DrawElementsIndirectCommand), NULL, GL_DYNAMIC_DRAW);
+        uploadBuffer(batchCounterBuffer, batches.size() * sizeof(unsigned int), NULL, GL_DYNAMIC_DRAW);
+        uploadBuffer(proceduralInstanceSSBO, instanceSlots * sizeof(unsigned int), NULL, GL_DYNAMIC_DRAW);
+        uploadBuffer(proceduralIndirectBuffer, proceduralCommands.size() * sizeof(DrawArraysIndirectCommand), NULL, GL_DYNAMIC_DRAW);
+
+        arenaGeneration = arena.getGeneration();
+    }
+
+    static void uploadBuffer(unsigned int buffer, size_t bytes, const void* data, GLenum usage)
+    {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glBufferData(GL_COPY_WRITE_BUFFER, max(bytes, (size_t)16), bytes > 0 ? data : NULL, usage);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+};
+
+#endif /* static_scene_h */
@@ -0,0 +1,183 @@
+#ifndef texture_array_h
+#define texture_array_h
+
+#include <glad/glad.h>
+#include <vector>
+#include <iostream>
+#include <algorithm>
+#include <unordered_map>
+#include "texture_cooker.h"
+#include "texture_residency.h"
+
+using namespace std;
+
+// where a texture ended up: layer of one of the arrays, array < 0 when it
+// was never added
+struct TextureLayer {
+    int array = -1;
+    unsigned int layer = 0;
+};
+
+// Gathers the scene's textures into GL_TEXTURE_2D_ARRAYs so draws that
+// differ only in texture can share one batch and pick their layer per
+// draw. Every image comes in cooked, at its square size class with the
+// mip chain made (see texture_cooker.h); one array holds all layers of a
+// size class, format and wrap mode, since the sampler state belongs to
+// the array. Textures keep their GL_TEXTURE_2D for direct draws.
+//
+// Arrays are also split by residency group, so textures only one part of
+// the scene shows (a room) share arrays whose fine mip levels
+// TextureResidency can release while that part is out of sight; a level
+// of an array spans all of its layers.
+//
+// add() takes a copy of each image as it is loaded and build() hands the
+// arrays to TextureResidency once.
+class TextureArrays {
+public:
+    static TextureArrays& shared()
+    {
+        static TextureArrays arrays;
+        return arrays;
+    }
+
+    // texture is the GL_TEXTURE_2D the image was uploaded to
+    void add(unsigned int texture, const CookedTexture& image, GLenum wrapS, GLenum wrapT, unsigned int group = 0)
+    {
+        if (built) {
+            cout << "ERROR::TEXTURE_ARRAYS::ADD_AFTER_BUILD: texture " << texture << endl;
+            return;
+        }
+
+        int array = findArray(image.size, image.format, wrapS, wrapT, group);
+        if (array < 0) {
+            ArrayInfo info;
+            info.size = image.size;
+            info.format = image.format;
+            info.levels = (int)image.levels.size();
+            info.wrapS = wrapS;
+            info.wrapT = wrapT;
+            info.group = group;
+            arrays.push_back(info);
+            array = (int)arrays.size() - 1;
+        }
+
+        TextureLayer layer;
+        layer.array = array;
+        layer.layer = arrays[array].layers++;
+        layers[texture] = layer;
+
+        PendingImage pendingImage;
+        pendingImage.texture = texture;
+        pendingImage.image = image;
+        pending.push_back(move(pendingImage));
+    }
+
+    // makes every array and passes it to TextureResidency, which uploads
+    // the levels it wants
+    void build()
+    {
+        // each level of an array holds its layers back to back
+        vector<CookedTexture> images(arrays.size());
+        for (size_t a = 0; a < arrays.size(); a++) {
+            images[a].format = arrays[a].format;
+            images[a].size = arrays[a].size;
+            images[a].levels.resize(arrays[a].levels);
+        }
+        size_t bytes = 0;
+        for (size_t i = 0; i < pending.size(); i++) {
+            const CookedTexture& image = pending[i].image;
+            CookedTexture& array = images[layers[pending[i].texture].array];
+            for (size_t level = 0; level < image.levels.size(); level++) {
+                CookedLevel& data = array.levels[level];
+                data.width = image.levels[level].width;
+                data.height = image.levels[level].height;
+                data.data.insert(data.data.end(), image.levels[level].data.begin(), image.levels[level].data.end());
+            }
+            bytes += image.bytes();
+        }
+        pending.clear();
+        pending.shrink_to_fit();
+
+        for (size_t a = 0; a < arrays.size(); a++) {
+            ArrayInfo& info = arrays[a];
+            glGenTextures(1, &info.texture);
+            glBindTexture(GL_TEXTURE_2D_ARRAY, info.texture);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, info.wrapS);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, info.wrapT);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            // single channel layers read as grey, like the RGBA8 expansion
+            if (info.format == GL_COMPRESSED_RED_RGTC1) {
+                GLint swizzle[4] = { GL_RED, GL_RED, GL_RED, GL_ONE };
+                glTexParameteriv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+            }
+            TextureResidency::shared().addTexture(GL_TEXTURE_2D_ARRAY, info.texture, images[a], (int)info.layers);
+            images[a].levels.clear();
+        }
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+        cout << "Texture arrays: " << layers.size() << " textures in " << arrays.size() << " arrays, "
+             << bytes / 1024 << " KB with mipmaps" << endl;
+
+        built = true;
+    }
+
+    TextureLayer locate(unsigned int texture) const
+    {
+        unordered_map<unsigned int, TextureLayer>::const_iterator found = layers.find(texture);
+        if (found == layers.end())
+            return TextureLayer();
+        return found->second;
+    }
+
+    unsigned int getArray(int array) const { return array >= 0 ? arrays[array].texture : 0; }
+    // layers numbered across every array, array by array; firstLayer of the
+    // array plus the layer gives one index per texture
+    unsigned int getFirstLayer(int array) const
+    {
+        unsigned int first = 0;
+        for (int a = 0; a < array; a++)
+            first += arrays[a].layers;
+        return first;
+    }
+    unsigned int getLayerCount() const { return (unsigned int)layers.size(); }
+    bool isBuilt() const { return built; }
+
+private:
+    struct ArrayInfo {
+        int size;
+        GLenum format;
+        int levels;
+        GLenum wrapS;
+        GLenum wrapT;
+        unsigned int group;
+        unsigned int layers = 0;
+        unsigned int texture = 0;
+    };
+
+    struct PendingImage {
+        unsigned int texture;
+        CookedTexture image;
+    };
+
+    vector<ArrayInfo> arrays;
+    vector<PendingImage> pending;
+    unordered_map<unsigned int, TextureLayer> layers;
+    bool built = false;
+
+    TextureArrays() {}
+    TextureArrays(const TextureArrays&) = delete;
+    TextureArrays& operator=(const TextureArrays&) = delete;
+
+    int findArray(int size, GLenum format, GLenum wrapS, GLenum wrapT, unsigned int group) const
+    {
+        for (size_t a = 0; a < arrays.size(); a++) {
+            if (arrays[a].size == size && arrays[a].format == format && arrays[a].wrapS == wrapS && arrays[a].wrapT == wrapT
+                && arrays[a].group == group)
+                return (int)a;
+        }
+        return -1;
+    }
+};
+
+#endif /* texture_array_h */
@@ -0,0 +1,637 @@
+#ifndef texture_cooker_h
+#define texture_cooker_h
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include <map>
+#include <cstdlib>
+#include "stb_image.h"
+
+using namespace std;
+
+// S3TC is not core, glad may be generated without the extension
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+struct CookedLevel {
+    int width;
+    int height;
+    vector<unsigned char> data;
+};
+
+// a texture ready for upload: every mip level down to 1x1, either block
+// compressed or RGBA8
+struct CookedTexture {
+    GLenum format = 0;          // internal format, GL_RGBA8 when uncompressed
+    int size = 0;               // level 0 is size x size
+    vector<CookedLevel> levels;
+
+    bool compressed() const { return format != GL_RGBA8; }
+
+    size_t bytes() const
+    {
+        size_t total = 0;
+        for (size_t i = 0; i < levels.size(); i++)
+            total += levels[i].data.size();
+        return total;
+    }
+};
+
+// Converts source images into block-compressed textures with their whole
+// mip chain and caches the result next to the source as <image>.ctex, so
+// later runs upload the blocks with glCompressedTexImage2D instead of
+// decoding the JPEG or PNG and generating mipmaps.
+//
+// Images are resampled to the square power-of-two size class the texture
+// arrays use, then encoded per channel count: BC4 for one channel, BC3
+// when there is any alpha and BC1 otherwise. Cached files carry a hash
+// of the source file and are re-cooked when it changes. Cooking needs no
+// GL context; "Lighting --cook image..." cooks ahead of time.
+//
+// Material textures carry their specular intensity in the alpha channel:
+// loadOrCook with a specular map packs its luminance into the diffuse
+// image, cached as <image>.spec.ctex, so the shaders fetch one texel for
+// both terms.
+//
+// Size limits, such as the ones MipFeedback recommends, cap a texture
+// below its size class by dropping the finest levels after loading; the
+// cached file keeps the whole chain so a limit can be raised again.
+//
+// The .ctex container is a KTX2-style layout without the data format
+// descriptor: header, level index, then the levels from largest to
+// smallest.
+class TextureCooker {
+public:
+    static const int MIN_SIZE = 64;
+    static const int MAX_SIZE = 1024;
+
+    static TextureCooker& shared()
+    {
+        static TextureCooker cooker;
+        return cooker;
+    }
+
+    // nearest power of two in log scale, so a 600 pixel image is not
+    // blown up to 1024
+    static int sizeClass(int side)
+    {
+        int size = MIN_SIZE;
+        while (size < MAX_SIZE && side > size + size / 2)
+            size *= 2;
+        return size;
+    }
+
+    // the cooked form of the image at sourcePath, with the specular map's
+    // intensity in alpha when one is given; from the cache when it is up to
+    // date, otherwise cooked and written back. False when a source cannot
+    // be read
+    bool loadOrCook(const char* sourcePath, CookedTexture& texture, const char* specularPath = nullptr)
+    {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+        vector<unsigned char> source, specular;
+        if (!readFile(sourcePath, source))
+            return false;
+        if (specularPath && !readFile(specularPath, specular))
+            return false;
+        uint64_t sourceHash = hashBytes(source);
+        string cookedPath = string(sourcePath) + ".ctex";
+        if (specularPath) {
+            sourceHash = (sourceHash ^ hashBytes(specular)) * 1099511628211ull;
+            cookedPath = string(sourcePath) + ".spec.ctex";
+        }
+
+        CookedInfo info;
+        info.name = string(sourcePath) + (specularPath ? " +spec" : "");
+        if (!load(cookedPath, sourceHash, texture, info)) {
+            if (!cookSource(source, specular, texture, info)) {
+                cout << "ERROR::TEXTURE_COOKER::DECODE_FAILED: " << sourcePath << endl;
+                return false;
+            }
+            info.cooked = true;
+            if (!save(cookedPath, sourceHash, texture, info))
+                cout << "ERROR::TEXTURE_COOKER::WRITE_FAILED: " << cookedPath << endl;
+        }
+
+        info.limited = applySizeLimit(sourcePath, texture);
+        info.size = texture.size;
+        info.cookedBytes = texture.bytes();
+        info.milliseconds = chrono::duration<float, milli>(chrono::steady_clock::now() - start).count();
+        report.push_back(info);
+        return true;
+    }
+
+    // "<source> <size>" lines, # for comments; false when there is no file
+    bool loadSizeLimits(const char* path)
+    {
+        ifstream file(path);
+        if (!file)
+            return false;
+        string line;
+        while (getline(file, line)) {
+            if (line.empty() || line[0] == '#')
+                continue;
+            size_t space = line.find_last_of(' ');
+            if (space == string::npos || atoi(line.c_str() + space + 1) <= 0) {
+                cout << "ERROR::TEXTURE_COOKER::BAD_SIZE_LIMIT: " << line << endl;
+                continue;
+            }
+            sizeLimits[line.substr(0, space)] = atoi(line.c_str() + space + 1);
+        }
+        return true;
+    }
+
+    // drops levels above the limit set for sourcePath; true when any went
+    bool applySizeLimit(const char* sourcePath, CookedTexture& texture) const
+    {
+        map<string, int>::const_iterator found = sizeLimits.find(sourcePath);
+        if (found == sizeLimits.end())
+            return false;
+        int limit = max(found->second, MIN_SIZE);
+        bool dropped = false;
+        while (texture.size > limit && texture.levels.size() > 1) {
+            texture.levels.erase(texture.levels.begin());
+            texture.size = texture.levels[0].width;
+            dropped = true;
+        }
+        return dropped;
+    }
+
+    // offline cooking of every path given, diffuse+specular for a packed
+    // material texture; true when all of them cooked
+    bool cookFiles(int count, char** paths)
+    {
+        bool ok = true;
+        for (int i = 0; i < count; i++) {
+            CookedTexture texture;
+            string path = paths[i];
+            size_t plus = path.find('+');
+            if (plus == string::npos)
+                ok = loadOrCook(path.c_str(), texture) && ok;
+            else
+                ok = loadOrCook(path.substr(0, plus).c_str(), texture, path.substr(plus + 1).c_str()) && ok;
+        }
+        printReport();
+        return ok;
+    }
+
+    // uncompressed RGBA8 texture with its mip chain, at the size class
+    static CookedTexture uncompressed(const unsigned char* pixels, int width, int height, int components)
+    {
+        int size = sizeClass(max(width, height));
+        return mipChain(resample(pixels, width, height, components, size), size);
+    }
+
+    // uncompressed RGBA8 diffuse texture at its size class with the
+    // luminance of the specular map, resampled to match, in alpha
+    static CookedTexture packSpecular(const unsigned char* pixels, int width, int height, int components,
+        const unsigned char* specular, int specularWidth, int specularHeight, int specularComponents)
+    {
+        int size = sizeClass(max(width, height));
+        vector<unsigned char> level = resample(pixels, width, height, components, size);
+        vector<unsigned char> intensity = resample(specular, specularWidth, specularHeight, specularComponents, size);
+        for (size_t i = 0; i < level.size(); i += 4)
+            level[i + 3] = (unsigned char)((intensity[i] * 77 + intensity[i + 1] * 150 + intensity[i + 2] * 29 + 128) >> 8);
+        return mipChain(level, size);
+    }
+
+    // block-compressed copy of an uncompressed texture; components of the
+    // source pick the format
+    static CookedTexture compress(CookedTexture texture, int components)
+    {
+        texture.format = compressedFormat(texture.levels[0].data, components);
+        for (size_t i = 0; i < texture.levels.size(); i++) {
+            CookedLevel& level = texture.levels[i];
+            level.data = encode(level.data, level.width, level.height, texture.format);
+        }
+        return texture;
+    }
+
+    // cooked and uncompressed bytes of every texture loaded so far
+    void printReport() const
+    {
+        size_t sourceTotal = 0, cookedTotal = 0;
+        streamsize precision = cout.precision();
+        cout << "Texture cooker:" << endl;
+        for (size_t i = 0; i < report.size(); i++) {
+            const CookedInfo& info = report[i];
+            sourceTotal += info.sourceBytes;
+            cookedTotal += info.cookedBytes;
+            cout << "  " << setw(28) << left << info.name << right
+                 << setw(5) << info.width << "x" << setw(4) << left << info.height << right
+                 << " -> " << setw(4) << info.size << " " << setw(5) << left << formatName(info.format) << right
+                 << setw(7) << info.sourceBytes / 1024 << " KB -> " << setw(5) << info.cookedBytes / 1024 << " KB ("
+                 << fixed << setprecision(1) << (float)info.sourceBytes / max(info.cookedBytes, (size_t)1) << "x), "
+                 << info.milliseconds << " ms" << (info.cooked ? " cooked" : "") << (info.limited ? " limited" : "")
+                 << defaultfloat << endl;
+        }
+        cout << "  total " << sourceTotal / 1024 << " KB -> " << cookedTotal / 1024 << " KB" << endl;
+        cout.precision(precision);
+    }
+
+private:
+    struct CookedInfo {
+        string name;
+        int width = 0;              // of the source
+        int height = 0;
+        int size = 0;
+        GLenum format = 0;
+        size_t sourceBytes = 0;     // RGBA8 at the source size with mipmaps, as uploaded before cooking
+        size_t cookedBytes = 0;
+        float milliseconds = 0.0f;  // reading, decoding and cooking if needed
+        bool cooked = false;
+        bool limited = false;       // size cut by a size limit
+    };
+
+    // the header of a .ctex file, followed by levelCount (offset, bytes)
+    // pairs and the level data
+    struct CookedHeader {
+        char identifier[8];
+        uint64_t sourceHash;
+        uint32_t format;
+        uint32_t size;
+        uint32_t levelCount;
+        uint32_t sourceWidth;
+        uint32_t sourceHeight;
+        uint32_t padding;
+    };
+
+    static const char* identifier() { return "CTEX01\r\n"; }
+
+    vector<CookedInfo> report;
+    map<string, int> sizeLimits;
+
+    TextureCooker() {}
+    TextureCooker(const TextureCooker&) = delete;
+    TextureCooker& operator=(const TextureCooker&) = delete;
+
+    static size_t sourceBytes(int width, int height)
+    {
+        return (size_t)width * height * 4 * 4 / 3;
+    }
+
+    static bool readFile(const string& path, vector<unsigned char>& bytes)
+    {
+        ifstream file(path.c_str(), ios::binary | ios::ate);
+        if (!file)
+            return false;
+        bytes.resize((size_t)file.tellg());
+        file.seekg(0);
+        file.read((char*)bytes.data(), bytes.size());
+        return (bool)file;
+    }
+
+    // FNV-1a
+    static uint64_t hashBytes(const vector<unsigned char>& bytes)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        for (size_t i = 0; i < bytes.size(); i++) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    static CookedTexture mipChain(vector<unsigned char> level, int size)
+    {
+        CookedTexture texture;
+        texture.format = GL_RGBA8;
+        texture.size = size;
+        for (int levelSize = size; levelSize > 0; levelSize /= 2) {
+            if (levelSize != size)
+                level = halve(level, levelSize * 2);
+            CookedLevel cooked = { levelSize, levelSize, level };
+            texture.levels.push_back(cooked);
+        }
+        return texture;
+    }
+
+    // decoded bottom row first, as loadMaterialTexture uploads; specular is
+    // empty unless it is packed into alpha
+    static bool cookSource(const vector<unsigned char>& source, const vector<unsigned char>& specular, CookedTexture& texture, CookedInfo& info)
+    {
+        int width, height, components;
+        stbi_set_flip_vertically_on_load(true);
+        unsigned char* pixels = stbi_load_from_memory(source.data(), (int)source.size(), &width, &height, &components, 0);
+        if (!pixels)
+            return false;
+
+        if (specular.empty())
+            texture = compress(uncompressed(pixels, width, height, components), components);
+        else {
+            int specularWidth, specularHeight, specularComponents;
+            unsigned char* specularPixels = stbi_load_from_memory(specular.data(), (int)specular.size(),
+                &specularWidth, &specularHeight, &specularComponents, 0);
+            if (!specularPixels) {
+                stbi_image_free(pixels);
+                return false;
+            }
+            texture = compress(packSpecular(pixels, width, height, components,
+                specularPixels, specularWidth, specularHeight, specularComponents), 4);
+            stbi_image_free(specularPixels);
+        }
+        stbi_image_free(pixels);
+
+        info.width = width;
+        info.height = height;
+        info.size = texture.size;
+        info.format = texture.format;
+        info.sourceBytes = sourceBytes(width, height);
+        return true;
+    }
+
+    static bool load(const string& path, uint64_t sourceHash, CookedTexture& texture, CookedInfo& info)
+    {
+        vector<unsigned char> bytes;
+        if (!readFile(path, bytes) || bytes.size() < sizeof(CookedHeader))
+            return false;
+
+        CookedHeader header;
+        memcpy(&header, bytes.data(), sizeof(header));
+        if (memcmp(header.identifier, identifier(), sizeof(header.identifier)) != 0 || header.sourceHash != sourceHash)
+            return false;
+        size_t indexEnd = sizeof(header) + (size_t)header.levelCount * 2 * sizeof(uint64_t);
+        if (header.levelCount == 0 || bytes.size() < indexEnd)
+            return false;
+
+        texture.format = header.format;
+        texture.size = (int)header.size;
+        texture.levels.clear();
+        for (uint32_t i = 0; i < header.levelCount; i++) {
+            uint64_t range[2];
+            memcpy(range, bytes.data() + sizeof(header) + i * sizeof(range), sizeof(range));
+            if (range[0] + range[1] > bytes.size())
+                return false;
+
+            CookedLevel level;
+            level.width = level.height = max(1, texture.size >> i);
+            level.data.assign(bytes.begin() + (size_t)range[0], bytes.begin() + (size_t)(range[0] + range[1]));
+            texture.levels.push_back(move(level));
+        }
+
+        info.width = (int)header.sourceWidth;
+        info.height = (int)header.sourceHeight;
+        info.size = texture.size;
+        info.format = texture.format;
+        info.sourceBytes = sourceBytes(info.width, info.height);
+        return true;
+    }
+
+    static bool save(const string& path, uint64_t sourceHash, const CookedTexture& texture, const CookedInfo& info)
+    {
+        CookedHeader header;
+        memcpy(header.identifier, identifier(), sizeof(header.identifier));
+        header.sourceHash = sourceHash;
+        header.format = texture.format;
+        header.size = (uint32_t)texture.size;
+        header.levelCount = (uint32_t)texture.levels.size();
+        header.sourceWidth = (uint32_t)info.width;
+        header.sourceHeight = (uint32_t)info.height;
+        header.padding = 0;
+
+        ofstream file(path.c_str(), ios::binary);
+        if (!file)
+            return false;
+        file.write((const char*)&header, sizeof(header));
+        uint64_t offset = sizeof(header) + texture.levels.size() * 2 * sizeof(uint64_t);
+        for (size_t i = 0; i < texture.levels.size(); i++) {
+            uint64_t range[2] = { offset, texture.levels[i].data.size() };
+            file.write((const char*)range, sizeof(range));
+            offset += range[1];
+        }
+        for (size_t i = 0; i < texture.levels.size(); i++)
+            file.write((const char*)texture.levels[i].data.data(), texture.levels[i].data.size());
+        return (bool)file;
+    }
+
+    static const char* formatName(GLenum format)
+    {
+        switch (format) {
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT: return "BC1";
+        case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT: return "BC3";
+        case GL_COMPRESSED_RED_RGTC1: return "BC4";
+        default: return "RGBA8";
+        }
+    }
+
+    static GLenum compressedFormat(const vector<unsigned char>& rgba, int components)
+    {
+        if (components == 1)
+            return GL_COMPRESSED_RED_RGTC1;
+        if (components == 2 || components == 4) {
+            for (size_t i = 3; i < rgba.size(); i += 4) {
+                if (rgba[i] != 255)
+                    return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+            }
+        }
+        return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    }
+
+    static glm::vec4 texel(const unsigned char* pixels, int width, int components, int x, int y)
+    {
+        const unsigned char* p = pixels + ((size_t)y * width + x) * components;
+        if (components == 1)
+            return glm::vec4(p[0], p[0], p[0], 255.0f);
+        if (components == 2)
+            return glm::vec4(p[0], p[0], p[0], p[1]);
+        return glm::vec4(p[0], p[1], p[2], components == 4 ? p[3] : 255.0f);
+    }
+
+    // RGBA8, box filter over each target texel's footprint when shrinking,
+    // bilinear when growing
+    static vector<unsigned char> resample(const unsigned char* pixels, int width, int height, int components, int size)
+    {
+        vector<unsigned char> result((size_t)size * size * 4);
+        float scaleX = (float)width / size;
+        float scaleY = (float)height / size;
+
+        for (int y = 0; y < size; y++) {
+            for (int x = 0; x < size; x++) {
+                glm::vec4 color(0.0f);
+                if (scaleX > 1.0f || scaleY > 1.0f) {
+                    int x0 = (int)(x * scaleX), x1 = max(x0 + 1, min(width, (int)((x + 1) * scaleX)));
+                    int y0 = (int)(y * scaleY), y1 = max(y0 + 1, min(height, (int)((y + 1) * scaleY)));
+                    for (int sy = y0; sy < y1; sy++)
+                        for (int sx = x0; sx < x1; sx++)
+                            color += texel(pixels, width, components, sx, sy);
+                    color /= (float)((x1 - x0) * (y1 - y0));
+                }
+                else {
+                    float sx = max((x + 0.5f) * scaleX - 0.5f, 0.0f);
+                    float sy = max((y + 0.5f) * scaleY - 0.5f, 0.0f);
+                    int x0 = min((int)sx, width - 1), x1 = min(x0 + 1, width - 1);
+                    int y0 = min((int)sy, height - 1), y1 = min(y0 + 1, height - 1);
+                    float fx = sx - x0, fy = sy - y0;
+                    glm::vec4 top = texel(pixels, width, components, x0, y0) * (1.0f - fx) + texel(pixels, width, components, x1, y0) * fx;
+                    glm::vec4 bottom = texel(pixels, width, components, x0, y1) * (1.0f - fx) + texel(pixels, width, components, x1, y1) * fx;
+                    color = top * (1.0f - fy) + bottom * fy;
+                }
+
+                unsigned char* out = result.data() + ((size_t)y * size + x) * 4;
+                for (int c = 0; c < 4; c++)
+                    out[c] = (unsigned char)min(255.0f, color[c] + 0.5f);
+            }
+        }
+        return result;
+    }
+
+    // next mip level of a square RGBA8 level, 2x2 box filter
+    static vector<unsigned char> halve(const vector<unsigned char>& level, int size)
+    {
+        int half = size / 2;
+        vector<unsigned char> result((size_t)half * half * 4);
+        for (int y = 0; y < half; y++) {
+            for (int x = 0; x < half; x++) {
+                for (int c = 0; c < 4; c++) {
+                    int sum = level[((size_t)(2 * y) * size + 2 * x) * 4 + c] + level[((size_t)(2 * y) * size + 2 * x + 1) * 4 + c]
+                        + level[((size_t)(2 * y + 1) * size + 2 * x) * 4 + c] + level[((size_t)(2 * y + 1) * size + 2 * x + 1) * 4 + c];
+                    result[((size_t)y * half + x) * 4 + c] = (unsigned char)((sum + 2) / 4);
+                }
+            }
+        }
+        return result;
+    }
+
+    static vector<unsigned char> encode(const vector<unsigned char>& rgba, int width, int height, GLenum format)
+    {
+        int blockBytes = format == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT ? 16 : 8;
+        int blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+        vector<unsigned char> result((size_t)blocksX * blocksY * blockBytes);
+
+        unsigned char block[16 * 4];
+        for (int by = 0; by < blocksY; by++) {
+            for (int bx = 0; bx < blocksX; bx++) {
+                // levels smaller than a block repeat their edge texels
+                for (int i = 0; i < 16; i++) {
+                    int x = min(bx * 4 + i % 4, width - 1);
+                    int y = min(by * 4 + i / 4, height - 1);
+                    memcpy(block + i * 4, rgba.data() + ((size_t)y * width + x) * 4, 4);
+                }
+
+                unsigned char* out = result.data() + ((size_t)by * blocksX + bx) * blockBytes;
+                if (format == GL_COMPRESSED_RED_RGTC1)
+                    encodeChannel(block, 0, out);
+                else if (format == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT) {
+                    encodeChannel(block, 3, out);
+                    encodeColor(block, out + 8);
+                }
+                else
+                    encodeColor(block, out);
+            }
+        }
+        return result;
+    }
+
+    static unsigned short pack565(const glm::vec3& color)
+    {
+        int r = (int)(color.x * 31.0f / 255.0f + 0.5f);
+        int g = (int)(color.y * 63.0f / 255.0f + 0.5f);
+        int b = (int)(color.z * 31.0f / 255.0f + 0.5f);
+        return (unsigned short)((r << 11) | (g << 5) | b);
+    }
+
+    static glm::vec3 unpack565(unsigned short color)
+    {
+        return glm::vec3(((color >> 11) & 31) * 255.0f / 31.0f, ((color >> 5) & 63) * 255.0f / 63.0f, (color & 31) * 255.0f / 31.0f);
+    }
+
+    // BC1 colour block: endpoints from the bounding box of the block,
+    // inset by a sixteenth and flipped per channel to follow the colour
+    // correlation, then each texel projected onto the line between them
+    static void encodeColor(const unsigned char* block, unsigned char* out)
+    {
+        glm::vec3 low(255.0f), high(0.0f), mean(0.0f);
+        for (int i = 0; i < 16; i++) {
+            glm::vec3 color(block[i * 4], block[i * 4 + 1], block[i * 4 + 2]);
+            low = glm::min(low, color);
+            high = glm::max(high, color);
+            mean += color;
+        }
+        mean /= 16.0f;
+
+        glm::vec3 inset = (high - low) / 16.0f;
+        low += inset;
+        high -= inset;
+
+        // each channel against the widest one
+        int reference = 0;
+        for (int c = 1; c < 3; c++) {
+            if (high[c] - low[c] > high[reference] - low[reference])
+                reference = c;
+        }
+        glm::vec3 covariance(0.0f);
+        for (int i = 0; i < 16; i++) {
+            float d = block[i * 4 + reference] - mean[reference];
+            for (int c = 0; c < 3; c++)
+                covariance[c] += d * (block[i * 4 + c] - mean[c]);
+        }
+        for (int c = 0; c < 3; c++) {
+            if (covariance[c] < 0.0f)
+                swap(low[c], high[c]);
+        }
+
+        unsigned short color0 = pack565(high), color1 = pack565(low);
+        unsigned int indices = 0;
+        if (color0 != color1) {
+            // four colour mode needs color0 > color1
+            if (color0 < color1)
+                swap(color0, color1);
+            glm::vec3 end0 = unpack565(color0), end1 = unpack565(color1);
+            glm::vec3 axis = end0 - end1;
+            float scale = 3.0f / glm::dot(axis, axis);
+            static const unsigned int remap[4] = { 1, 3, 2, 0 };   // steps from color1 to palette index
+            for (int i = 0; i < 16; i++) {
+                glm::vec3 color(block[i * 4], block[i * 4 + 1], block[i * 4 + 2]);
+                int step = (int)(glm::dot(color - end1, axis) * scale + 0.5f);
+                indices |= remap[min(3, max(0, step))] << (i * 2);
+            }
+        }
+
+        out[0] = (unsigned char)(color0 & 0xff);
+        out[1] = (unsigned char)(color0 >> 8);
+        out[2] = (unsigned char)(color1 & 0xff);
+        out[3] = (unsigned char)(color1 >> 8);
+        for (int i = 0; i < 4; i++)
+            out[4 + i] = (unsigned char)(indices >> (i * 8));
+    }
+
+    // BC4 block of one channel, also the alpha block of BC3: the block's
+    // range split in seven steps
+    static void encodeChannel(const unsigned char* block, int channel, unsigned char* out)
+    {
+        int low = 255, high = 0;
+        for (int i = 0; i < 16; i++) {
+            low = min(low, (int)block[i * 4 + channel]);
+            high = max(high, (int)block[i * 4 + channel]);
+        }
+
+        uint64_t indices = 0;
+        if (high != low) {
+            static const uint64_t remap[8] = { 1, 7, 6, 5, 4, 3, 2, 0 };   // steps from low to palette index
+            for (int i = 0; i < 16; i++) {
+                int step = ((block[i * 4 + channel] - low) * 14 + (high - low)) / (2 * (high - low));
+                indices |= remap[step] << (i * 3);
+            }
+        }
+
+        out[0] = (unsigned char)high;
+        out[1] = (unsigned char)low;
+        for (int i = 0; i < 6; i++)
+            out[2 + i] = (unsigned char)(indices >> (i * 8));
+    }
+};
+
+#endif /* texture_cooker_h */
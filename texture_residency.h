@@ -0,0 +1,343 @@
+#ifndef texture_residency_h
+#define texture_residency_h
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <unordered_map>
+#include "texture_cooker.h"
+
+using namespace std;
+
+// where a texture is drawn: a scene-space bounding sphere and how often
+// the texture repeats across it
+struct TextureUse {
+    unsigned int texture;       // the GL_TEXTURE_2D or GL_TEXTURE_2D_ARRAY sampled
+    glm::vec4 bounds;
+    float texelScale;           // uv repeats over the surface
+};
+
+// Keeps the textures within a VRAM budget by streaming their mip levels.
+// A texture starts with only its mip tail, the levels of TAIL_SIZE texels
+// and below, uploaded; the finer levels stay in system memory. Every
+// frame the uses drawn are tested against the frustum and, from the
+// distance and the bounds, the finest level a use can show on screen is
+// what its texture wants. Wanted levels are uploaded one at a time, finest
+// last, within a per-frame upload allowance; until a level arrives the
+// texture samples the coarser ones through GL_TEXTURE_BASE_LEVEL.
+//
+// Levels no longer wanted stay resident while there is room and are
+// released least recently used first when a wanted level needs it, or
+// once their texture has gone unused for keepFrames. Uses come from the
+// static scene, recorded once, and from direct draws, each frame.
+class TextureResidency {
+public:
+    static const int TAIL_SIZE = 64;
+
+    static TextureResidency& shared()
+    {
+        static TextureResidency residency;
+        return residency;
+    }
+
+    // when off every level is uploaded at once and nothing is released
+    void setStreaming(bool enabled) { streaming = enabled; }
+    void setBudget(size_t bytes) { budget = bytes; }
+    void setUploadBytesPerFrame(size_t bytes) { uploadBytesPerFrame = bytes; }
+    void setKeepFrames(unsigned int frames) { keepFrames = frames; }
+
+    // takes over the levels of a GL_TEXTURE_2D, or of a GL_TEXTURE_2D_ARRAY
+    // with every layer of a level stored back to back; the texture must
+    // have no storage yet
+    void addTexture(GLenum target, unsigned int texture, const CookedTexture& image, int layers = 1)
+    {
+        Resource resource;
+        resource.target = target;
+        resource.texture = texture;
+        resource.format = image.format;
+        resource.compressed = image.compressed();
+        resource.size = image.size;
+        resource.layers = layers;
+        resource.levels = image.levels;
+        resource.tailLevel = 0;
+        while (resource.tailLevel + 1 < (int)resource.levels.size() && resource.levels[resource.tailLevel].width > TAIL_SIZE)
+            resource.tailLevel++;
+        resource.residentBase = (int)resource.levels.size();
+        resource.wantedLevel = resource.tailLevel;
+
+        glBindTexture(target, texture);
+        glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, (int)resource.levels.size() - 1);
+        int firstLevel = streaming ? resource.tailLevel : 0;
+        for (int level = (int)resource.levels.size() - 1; level >= firstLevel; level--)
+            uploadLevel(resource, level);
+        glTexParameteri(target, GL_TEXTURE_BASE_LEVEL, resource.residentBase);
+        glBindTexture(target, 0);
+
+        resources[texture] = move(resource);
+    }
+
+    // uploads every level of every texture, for renders that must not see
+    // the streamed-out levels, such as impostor bakes; levels nobody wants
+    // are released again once keepFrames pass
+    void uploadAllLevels()
+    {
+        for (unordered_map<unsigned int, Resource>::iterator it = resources.begin(); it != resources.end(); ++it) {
+            Resource& resource = it->second;
+            if (resource.residentBase == 0)
+                continue;
+            glBindTexture(resource.target, resource.texture);
+            while (resource.residentBase > 0) {
+                uploadLevel(resource, resource.residentBase - 1);
+                levelsIn++;
+            }
+            glTexParameteri(resource.target, GL_TEXTURE_BASE_LEVEL, 0);
+            glBindTexture(resource.target, 0);
+        }
+    }
+
+    // the static scene's uses, replaced whenever it is recorded
+    void setSceneUses(const vector<TextureUse>& uses) { sceneUses = uses; }
+
+    // a direct draw this frame; bounds is the mesh-space sphere
+    void use(unsigned int texture, const glm::mat4& model, const glm::vec4& bounds, float texelScale = 1.0f)
+    {
+        float scale = max(glm::length(glm::vec3(model[0])), max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+        TextureUse use;
+        use.texture = texture;
+        use.bounds = glm::vec4(glm::vec3(model * glm::vec4(glm::vec3(bounds), 1.0f)), bounds.w * scale);
+        use.texelScale = texelScale;
+        frameUses.push_back(use);
+    }
+
+    // after the frame is drawn: works out the wanted levels and streams;
+    // world places the scene uses, pixelsPerUnit is the screen size of one
+    // unit at distance one (viewport height * projection[1][1] / 2)
+    void update(const glm::mat4& viewProjection, const glm::mat4& world, const glm::vec3& cameraPosition, float pixelsPerUnit)
+    {
+        frame++;
+        if (!streaming) {
+            frameUses.clear();
+            return;
+        }
+
+        for (unordered_map<unsigned int, Resource>::iterator it = resources.begin(); it != resources.end(); ++it)
+            it->second.wantedLevel = it->second.tailLevel;
+
+        glm::vec4 planes[6];
+        frustumPlanes(viewProjection, planes);
+        for (size_t i = 0; i < sceneUses.size(); i++) {
+            TextureUse use = sceneUses[i];
+            use.bounds = glm::vec4(glm::vec3(world * glm::vec4(glm::vec3(use.bounds), 1.0f)), use.bounds.w);
+            want(use, planes, cameraPosition, pixelsPerUnit);
+        }
+        for (size_t i = 0; i < frameUses.size(); i++)
+            want(frameUses[i], planes, cameraPosition, pixelsPerUnit);
+        frameUses.clear();
+
+        release();
+        stream();
+
+        if (frame - lastReport >= REPORT_FRAMES && (levelsIn != reportedIn || levelsOut != reportedOut)) {
+            printReport();
+            lastReport = frame;
+            reportedIn = levelsIn;
+            reportedOut = levelsOut;
+        }
+    }
+
+    size_t getResidentBytes() const { return residentBytes; }
+    size_t getBudget() const { return budget; }
+
+    void printReport() const
+    {
+        size_t total = 0;
+        for (unordered_map<unsigned int, Resource>::const_iterator it = resources.begin(); it != resources.end(); ++it) {
+            for (size_t level = 0; level < it->second.levels.size(); level++)
+                total += it->second.levels[level].data.size();
+        }
+        cout << "Texture residency: " << fixed << setprecision(1) << residentBytes / 1048576.0f << " MB resident of "
+             << budget / 1048576.0f << " MB budget (" << total / 1048576.0f << " MB with every level), "
+             << levelsIn << " levels streamed in, " << levelsOut << " released" << defaultfloat << setprecision(6) << endl;
+    }
+
+private:
+    static const unsigned int REPORT_FRAMES = 300;
+
+    struct Resource {
+        GLenum target;
+        unsigned int texture;
+        GLenum format;
+        bool compressed;
+        int size;
+        int layers;
+        vector<CookedLevel> levels;     // system memory copy of every level
+        int tailLevel;                  // this level and coarser ones never leave
+        int residentBase;               // finest level uploaded
+        int wantedLevel;                // finest level a use showed this frame
+        unsigned int lastUsed = 0;
+    };
+
+    unordered_map<unsigned int, Resource> resources;
+    vector<TextureUse> sceneUses;
+    vector<TextureUse> frameUses;
+    bool streaming = true;
+    size_t budget = 64 * 1048576;
+    size_t uploadBytesPerFrame = 4 * 1048576;
+    unsigned int keepFrames = 600;
+    size_t residentBytes = 0;
+    unsigned int frame = 0;
+    unsigned int levelsIn = 0, levelsOut = 0;
+    unsigned int lastReport = 0, reportedIn = 0, reportedOut = 0;
+
+    TextureResidency() {}
+    TextureResidency(const TextureResidency&) = delete;
+    TextureResidency& operator=(const TextureResidency&) = delete;
+
+    static void frustumPlanes(const glm::mat4& m, glm::vec4 planes[6])
+    {
+        for (int i = 0; i < 3; i++) {
+            planes[i * 2] = glm::vec4(m[0][3] + m[0][i], m[1][3] + m[1][i], m[2][3] + m[2][i], m[3][3] + m[3][i]);
+            planes[i * 2 + 1] = glm::vec4(m[0][3] - m[0][i], m[1][3] - m[1][i], m[2][3] - m[2][i], m[3][3] - m[3][i]);
+        }
+        for (int i = 0; i < 6; i++)
+            planes[i] = planes[i] / glm::length(glm::vec3(planes[i]));
+    }
+
+    // a texel of the wanted level covers about one pixel of the use's
+    // nearest point, assuming the texture spans the bounding sphere
+    void want(const TextureUse& use, const glm::vec4 planes[6], const glm::vec3& cameraPosition, float pixelsPerUnit)
+    {
+        unordered_map<unsigned int, Resource>::iterator found = resources.find(use.texture);
+        if (found == resources.end())
+            return;
+        for (int p = 0; p < 6; p++) {
+            if (glm::dot(glm::vec3(planes[p]), glm::vec3(use.bounds)) + planes[p].w < -use.bounds.w)
+                return;
+        }
+
+        Resource& resource = found->second;
+        float distance = max(glm::length(glm::vec3(use.bounds) - cameraPosition) - use.bounds.w, 0.1f);
+        float texelsPerUnit = resource.size * use.texelScale / (2.0f * max(use.bounds.w, 1e-3f));
+        float texelsPerPixel = texelsPerUnit * distance / pixelsPerUnit;
+        int level = texelsPerPixel > 1.0f ? (int)log2(texelsPerPixel) : 0;
+
+        resource.wantedLevel = min(resource.wantedLevel, level);
+        resource.lastUsed = frame;
+    }
+
+    // levels of textures that have gone unused for keepFrames, one per frame
+    void release()
+    {
+        for (unordered_map<unsigned int, Resource>::iterator it = resources.begin(); it != resources.end(); ++it) {
+            Resource& resource = it->second;
+            if (resource.residentBase < resource.tailLevel && frame - resource.lastUsed > keepFrames) {
+                releaseLevel(resource);
+                return;
+            }
+        }
+    }
+
+    // one level closer to the wanted one per texture, most recently used
+    // and furthest from its wanted level first
+    void stream()
+    {
+        vector<Resource*> waiting;
+        for (unordered_map<unsigned int, Resource>::iterator it = resources.begin(); it != resources.end(); ++it) {
+            if (it->second.residentBase > it->second.wantedLevel)
+                waiting.push_back(&it->second);
+        }
+        sort(waiting.begin(), waiting.end(), [](const Resource* a, const Resource* b) {
+            if (a->lastUsed != b->lastUsed)
+                return a->lastUsed > b->lastUsed;
+            return a->residentBase - a->wantedLevel > b->residentBase - b->wantedLevel;
+        });
+
+        size_t uploaded = 0;
+        for (size_t i = 0; i < waiting.size(); i++) {
+            Resource& resource = *waiting[i];
+            int level = resource.residentBase - 1;
+            size_t bytes = resource.levels[level].data.size();
+            if (uploaded > 0 && uploaded + bytes > uploadBytesPerFrame)
+                break;
+            if (!makeRoom(bytes, resource))
+                continue;
+
+            glBindTexture(resource.target, resource.texture);
+            uploadLevel(resource, level);
+            glTexParameteri(resource.target, GL_TEXTURE_BASE_LEVEL, resource.residentBase);
+            glBindTexture(resource.target, 0);
+            uploaded += bytes;
+            levelsIn++;
+        }
+    }
+
+    // releases least recently used levels until bytes fit the budget;
+    // levels the current frame shows are never taken
+    bool makeRoom(size_t bytes, const Resource& incoming)
+    {
+        while (residentBytes + bytes > budget) {
+            Resource* victim = nullptr;
+            for (unordered_map<unsigned int, Resource>::iterator it = resources.begin(); it != resources.end(); ++it) {
+                Resource& resource = it->second;
+                if (&resource == &incoming || resource.residentBase >= resource.tailLevel)
+                    continue;
+                if (resource.lastUsed == frame && resource.residentBase >= resource.wantedLevel)
+                    continue;
+                if (!victim || resource.lastUsed < victim->lastUsed)
+                    victim = &resource;
+            }
+            if (!victim)
+                return false;
+            releaseLevel(*victim);
+        }
+        return true;
+    }
+
+    // the texture is bound
+    void uploadLevel(Resource& resource, int level)
+    {
+        const CookedLevel& data = resource.levels[level];
+        if (resource.target == GL_TEXTURE_2D_ARRAY) {
+            if (resource.compressed)
+                glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, level, resource.format, data.width, data.height, resource.layers, 0,
+                    (int)data.data.size(), data.data.data());
+            else
+                glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA8, data.width, data.height, resource.layers, 0,
+                    GL_RGBA, GL_UNSIGNED_BYTE, data.data.data());
+        }
+        else {
+            if (resource.compressed)
+                glCompressedTexImage2D(GL_TEXTURE_2D, level, resource.format, data.width, data.height, 0,
+                    (int)data.data.size(), data.data.data());
+            else
+                glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8, data.width, data.height, 0,
+                    GL_RGBA, GL_UNSIGNED_BYTE, data.data.data());
+        }
+        resource.residentBase = level;
+        residentBytes += data.data.size();
+    }
+
+    // the finest resident level goes; redefining it as empty frees it, and
+    // levels below the base level do not count toward completeness
+    void releaseLevel(Resource& resource)
+    {
+        int level = resource.residentBase;
+        glBindTexture(resource.target, resource.texture);
+        glTexParameteri(resource.target, GL_TEXTURE_BASE_LEVEL, level + 1);
+        if (resource.target == GL_TEXTURE_2D_ARRAY)
+            glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA8, 0, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        else
+            glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        glBindTexture(resource.target, 0);
+
+        resource.residentBase = level + 1;
+        residentBytes -= resource.levels[level].data.size();
+        levelsOut++;
+    }
+};
+
+#endif /* texture_residency_h */
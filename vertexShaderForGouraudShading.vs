@@ -5,8 +5,14 @@ layout (location = 1) in vec3 aNormal;
 out vec4 LightingColor;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+layout (std140) uniform Camera {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec3 viewPos;
+    float time;
+    vec2 viewportSize;
+};
 
 struct Material {
     vec3 ambient;
@@ -58,9 +64,13 @@ struct SpotLight {
 
 #define NR_POINT_LIGHTS 2
 
-uniform vec3 viewPos;
 uniform PointLight pointLights[NR_POINT_LIGHTS];
-uniform Material material;
+#define MAX_MATERIALS 256
+
+layout (std140) uniform Materials {
+    Material materials[MAX_MATERIALS];
+};
+uniform int materialIndex;
 uniform DiectionalLight diectionalLight;
 uniform bool dlighton = true;
 uniform bool spotlighton = true;
@@ -77,7 +87,8 @@ vec3 CalcSpotLight(Material material, SpotLight light, vec3 N, vec3 Pos, vec3 V)
 
 void main()
 {
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    Material material = materials[materialIndex];
+    gl_Position = viewProjection * model * vec4(aPos, 1.0);
     
     vec3 Pos = vec3(model * vec4(aPos, 1.0));
     vec3 Normal = mat3(transpose(inverse(model))) * aNormal;
@@ -0,0 +1,139 @@
+#version 430 core
+// Cubes and prisms of the static scene without vertex buffers: the vertex
+// is rebuilt from gl_VertexID and the draw is found through the instance
+// list, so one instanced call covers every draw of a shape and texture set.
+
+struct DrawData {
+    mat4 model;
+    vec4 uvTransform;   // xy = scale, zw = offset
+    vec4 color;
+    uint materialIndex;
+    uint diffuseLayer;  // layer of the batch's texture array
+    float shininess;
+    float fade;         // impostor handover share, from staticSceneCull.cs
+};
+
+layout (std430, binding = 0) readonly buffer DrawDataBuffer {
+    DrawData draws[];
+};
+
+layout (std430, binding = 1) readonly buffer InstanceBuffer {
+    uint instances[];   // visible draws, batch by batch
+};
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoords;
+flat out vec3 Color;
+flat out uint DiffuseLayer;
+flat out float Shininess;
+flat out float Fade;
+invariant gl_Position;     // mipFeedback.fs redraws over the same depth
+
+uniform mat4 world;
+layout (std140) uniform Camera {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec3 viewPos;
+    float time;
+    vec2 viewportSize;
+};
+
+uniform int shape;          // 0 = cube, 1 = prism
+uniform int sides;          // prism only
+uniform float angleStep;    // prism only, radians between ring vertices
+uniform int firstInstance;
+
+// the Cube mesh, four corners per face
+const vec3 cubePositions[24] = vec3[](
+    vec3(0, 0, 0), vec3(1, 0, 0), vec3(1, 1, 0), vec3(0, 1, 0),
+    vec3(1, 0, 0), vec3(1, 1, 0), vec3(1, 0, 1), vec3(1, 1, 1),
+    vec3(0, 0, 1), vec3(1, 0, 1), vec3(1, 1, 1), vec3(0, 1, 1),
+    vec3(0, 0, 1), vec3(0, 1, 1), vec3(0, 1, 0), vec3(0, 0, 0),
+    vec3(1, 1, 1), vec3(1, 1, 0), vec3(0, 1, 0), vec3(0, 1, 1),
+    vec3(0, 0, 0), vec3(1, 0, 0), vec3(1, 0, 1), vec3(0, 0, 1));
+
+const vec2 cubeTexCoords[24] = vec2[](
+    vec2(1, 0), vec2(0, 0), vec2(0, 1), vec2(1, 1),
+    vec2(1, 0), vec2(1, 1), vec2(0, 0), vec2(0, 1),
+    vec2(0, 0), vec2(1, 0), vec2(1, 1), vec2(0, 1),
+    vec2(1, 0), vec2(1, 1), vec2(0, 1), vec2(0, 0),
+    vec2(1, 0), vec2(1, 1), vec2(0, 1), vec2(0, 0),
+    vec2(0, 0), vec2(1, 0), vec2(1, 1), vec2(0, 1));
+
+const vec3 cubeNormals[6] = vec3[](
+    vec3(0, 0, -1), vec3(1, 0, 0), vec3(0, 0, 1), vec3(-1, 0, 0), vec3(0, 1, 0), vec3(0, -1, 0));
+
+// corner of each face vertex, two triangles per face
+const int cubeCorners[36] = int[](
+    0, 3, 2, 2, 1, 0,
+    0, 1, 3, 3, 2, 0,
+    0, 1, 2, 2, 3, 0,
+    0, 1, 2, 2, 3, 0,
+    0, 1, 2, 2, 3, 0,
+    0, 1, 2, 2, 3, 0);
+
+void cubeVertex(int id, out vec3 position, out vec3 normal, out vec2 texCoords)
+{
+    int face = id / 6;
+    int corner = face * 4 + cubeCorners[id];
+
+    position = cubePositions[corner];
+    normal = cubeNormals[face];
+    texCoords = cubeTexCoords[corner];
+}
+
+// bottom fan, top fan, then a band of two triangles per side
+void prismVertex(int id, out vec3 position, out vec3 normal, out vec2 texCoords)
+{
+    int fanVertices = sides * 3;
+    if (id < 2 * fanVertices) {
+        float z = float(id / fanVertices);
+        int corner = id % 3;
+        normal = vec3(0.0, 0.0, z * 2.0 - 1.0);
+        if (corner == 0) {
+            position = vec3(0.0, 0.0, z);
+            texCoords = vec2(0.5);
+            return;
+        }
+        float angle = float(((id % fanVertices) / 3 + corner - 1) % sides) * angleStep;
+        vec2 ring = vec2(cos(angle), sin(angle));
+        position = vec3(ring, z);
+        texCoords = (ring + 1.0) * 0.5;
+        return;
+    }
+
+    // the band alternates bottom and top ring vertices
+    int band = id - 2 * fanVertices;
+    int j = (band / 3 + band % 3) % (sides * 2);
+    int ring = j / 2;
+    float top = float(j % 2);
+    float angle = float(ring) * angleStep;
+    position = vec3(cos(angle), sin(angle), top);
+    normal = vec3(cos(angle), sin(angle), 0.0);
+    texCoords = vec2(float(ring % 2), top);
+}
+
+void main()
+{
+    DrawData draw = draws[instances[firstInstance + gl_InstanceID]];
+    mat4 model = world * draw.model;
+
+    vec3 position, normal;
+    vec2 texCoords;
+    if (shape == 0)
+        cubeVertex(gl_VertexID, position, normal, texCoords);
+    else
+        prismVertex(gl_VertexID, position, normal, texCoords);
+
+    FragPos = vec3(model * vec4(position, 1.0));
+    Normal = mat3(transpose(inverse(model))) * normal;
+    TexCoords = texCoords * draw.uvTransform.xy + draw.uvTransform.zw;
+    Color = draw.color.rgb;
+    DiffuseLayer = draw.diffuseLayer;
+    Shininess = draw.shininess;
+    Fade = draw.fade;
+
+    gl_Position = viewProjection * vec4(FragPos, 1.0);
+}
@@ -0,0 +1,54 @@
+#version 430 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+layout (location = 3) in uint aDrawID;  // per instance, selected by baseInstance
+
+struct DrawData {
+    mat4 model;
+    vec4 uvTransform;   // xy = scale, zw = offset
+    vec4 color;
+    uint materialIndex;
+    uint diffuseLayer;  // layer of the batch's texture array
+    float shininess;
+    float fade;         // impostor handover share, from staticSceneCull.cs
+};
+
+layout (std430, binding = 0) readonly buffer DrawDataBuffer {
+    DrawData draws[];
+};
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoords;
+flat out vec3 Color;
+flat out uint DiffuseLayer;
+flat out float Shininess;
+flat out float Fade;
+invariant gl_Position;     // mipFeedback.fs redraws over the same depth
+
+uniform mat4 world;
+layout (std140) uniform Camera {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec3 viewPos;
+    float time;
+    vec2 viewportSize;
+};
+
+void main()
+{
+    DrawData draw = draws[aDrawID];
+    mat4 model = world * draw.model;
+
+    FragPos = vec3(model * vec4(aPos, 1.0));
+    Normal = mat3(transpose(inverse(model))) * aNormal;
+    TexCoords = aTexCoords * draw.uvTransform.xy + draw.uvTransform.zw;
+    Color = draw.color.rgb;
+    DiffuseLayer = draw.diffuseLayer;
+    Shininess = draw.shininess;
+    Fade = draw.fade;
+
+    gl_Position = viewProjection * vec4(FragPos, 1.0);
+}
@@ -0,0 +1,164 @@
+#ifndef vertex_format_h
+#define vertex_format_h
+
+#include <glad/glad.h>
+#include <vector>
+#include <cmath>
+#include <cstring>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+using namespace std;
+
+// Meshes are built as 8 floats per vertex (position, normal, texture) and
+// encoded into one of these layouts when they are uploaded.
+//
+// Quantized against float, compared with a software rasterizer rather than
+// a GL render (320x320, 8-bit colour, lighting of
+// fragmentShaderForPhongShading.fs, same camera and lights), largest
+// channel difference per lit pixel:
+//   sphere   45996 pixels: 4224 off by 1/255, none more, mean 0.09/255
+//   balloon  24415 pixels: 1313 off by 1/255, 8 by 2/255, mean 0.05/255
+// with 4 and 1 silhouette pixels changing coverage.
+enum VertexFormat {
+    VERTEX_FORMAT_FLOAT = 0,    // 3 float position, 3 float normal, 2 float texture: 32 bytes
+    VERTEX_FORMAT_PACKED,       // 3 float position, 10_10_10_2 normal, 2 half texture: 20 bytes
+    VERTEX_FORMAT_QUANTIZED,    // 3 unorm16 position (+pad), 10_10_10_2 normal, 2 half texture: 16 bytes
+    VERTEX_FORMAT_COUNT
+};
+
+const int SOURCE_VERTEX_FLOATS = 8;
+
+inline int vertexFormatStride(VertexFormat format)
+{
+    switch (format) {
+    case VERTEX_FORMAT_PACKED:
+        return 20;
+    case VERTEX_FORMAT_QUANTIZED:
+        return 16;
+    default:
+        return SOURCE_VERTEX_FLOATS * sizeof(float);
+    }
+}
+
+inline const char* vertexFormatName(VertexFormat format)
+{
+    switch (format) {
+    case VERTEX_FORMAT_PACKED:
+        return "packed";
+    case VERTEX_FORMAT_QUANTIZED:
+        return "quantized";
+    default:
+        return "float";
+    }
+}
+
+// GL_INT_2_10_10_10_REV, signed normalized, w left at 0
+inline unsigned int packNormal(glm::vec3 n)
+{
+    int x = (int)floorf(glm::clamp(n.x, -1.0f, 1.0f) * 511.0f + 0.5f);
+    int y = (int)floorf(glm::clamp(n.y, -1.0f, 1.0f) * 511.0f + 0.5f);
+    int z = (int)floorf(glm::clamp(n.z, -1.0f, 1.0f) * 511.0f + 0.5f);
+    return (unsigned int)(x & 0x3ff) | ((unsigned int)(y & 0x3ff) << 10) | ((unsigned int)(z & 0x3ff) << 20);
+}
+
+// two GL_HALF_FLOAT values, u in the low half
+inline unsigned int packTexCoord(float u, float v)
+{
+    return glm::packHalf2x16(glm::vec2(u, v));
+}
+
+// Encodes 8-float source vertices. For the quantized format positions are
+// stored relative to the mesh bounds and dequantization maps them back; it
+// is folded into the model matrix, so normals are pre-scaled by the bounds
+// to survive the inverse-transpose in the shaders.
+inline vector<unsigned char> encodeVertices(const float* vertices, int vertexCount, VertexFormat format, glm::mat4& dequantization)
+{
+    int stride = vertexFormatStride(format);
+    vector<unsigned char> encoded((size_t)vertexCount * stride);
+    dequantization = glm::mat4(1.0f);
+
+    if (format == VERTEX_FORMAT_FLOAT) {
+        memcpy(encoded.data(), vertices, encoded.size());
+        return encoded;
+    }
+
+    glm::vec3 minCorner(0.0f), extent(1.0f);
+    if (format == VERTEX_FORMAT_QUANTIZED && vertexCount > 0) {
+        glm::vec3 maxCorner(-1e30f);
+        minCorner = glm::vec3(1e30f);
+        for (int i = 0; i < vertexCount; i++) {
+            glm::vec3 p(vertices[i * SOURCE_VERTEX_FLOATS], vertices[i * SOURCE_VERTEX_FLOATS + 1], vertices[i * SOURCE_VERTEX_FLOATS + 2]);
+            minCorner = glm::min(minCorner, p);
+            maxCorner = glm::max(maxCorner, p);
+        }
+        extent = maxCorner - minCorner;
+        for (int k = 0; k < 3; k++) {
+            if (extent[k] <= 0.0f)
+                extent[k] = 1.0f;
+        }
+        dequantization = glm::scale(glm::translate(glm::mat4(1.0f), minCorner), extent);
+    }
+
+    for (int i = 0; i < vertexCount; i++) {
+        const float* v = vertices + i * SOURCE_VERTEX_FLOATS;
+        unsigned char* out = encoded.data() + (size_t)i * stride;
+
+        glm::vec3 normal(v[3], v[4], v[5]);
+        unsigned int uv = packTexCoord(v[6], v[7]);
+
+        if (format == VERTEX_FORMAT_PACKED) {
+            unsigned int n = packNormal(normal);
+            memcpy(out, v, 3 * sizeof(float));
+            memcpy(out + 12, &n, 4);
+            memcpy(out + 16, &uv, 4);
+        }
+        else {
+            unsigned short q[4] = { 0, 0, 0, 0 };
+            for (int k = 0; k < 3; k++) {
+                float t = glm::clamp((v[k] - minCorner[k]) / extent[k], 0.0f, 1.0f);
+                q[k] = (unsigned short)floorf(t * 65535.0f + 0.5f);
+            }
+
+            normal *= extent;
+            float length = glm::length(normal);
+            if (length > 0.0f)
+                normal /= length;
+
+            unsigned int n = packNormal(normal);
+            memcpy(out, q, 8);
+            memcpy(out + 8, &n, 4);
+            memcpy(out + 12, &uv, 4);
+        }
+    }
+
+    return encoded;
+}
+
+// attributes 0-2 for the bound VAO, reading from the bound GL_ARRAY_BUFFER
+inline void configureVertexFormat(VertexFormat format)
+{
+    int stride = vertexFormatStride(format);
+
+    if (format == VERTEX_FORMAT_PACKED) {
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
+        glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, (void*)12);
+        glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, stride, (void*)16);
+    }
+    else if (format == VERTEX_FORMAT_QUANTIZED) {
+        glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, stride, (void*)0);
+        glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, (void*)8);
+        glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, stride, (void*)12);
+    }
+    else {
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)12);
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)24);
+    }
+
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    glEnableVertexAttribArray(2);
+}
+
+#endif /* vertex_format_h */